@@ -35,4 +35,13 @@
 /** Page is dirty. */
 #define VM_D (1 << 7)
 
+#if __riscv_xlen == 64
+/**
+ * Where the kernel data page (\ref sys_kdata) is mapped in every address
+ * space. Right after the 2MiB kernel image, so it shares the kernel's page
+ * tables and doesn't eat into user virtual memory.
+ */
+#define KDATA_ADDR (0xffffffff80200000UL)
+#endif
+
 #endif /* KMI_RISCV_UAPI_H */
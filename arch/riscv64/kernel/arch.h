@@ -41,6 +41,20 @@ void set_hartid(id_t cpuid, id_t hartid);
  */
 id_t hartid_to_cpuid(id_t hart);
 
+/**
+ * Look for an ACLINT supervisor software interrupt device in \p fdt and if
+ * one is found, send IPIs by writing its registers directly instead of going
+ * through the SBI.
+ *
+ * @param fdt Global FDT pointer.
+ */
+void setup_ipi(const void *fdt);
+
+/**
+ * Find out which performance counters the SBI can give us.
+ */
+void setup_pmu();
+
 /**
  * Format branch and mode information into something that can be written to
  * SATP.
@@ -7,12 +7,44 @@
  */
 
 #include <kmi/tcb.h>
+#include <kmi/mem.h>
+#include <kmi/debug.h>
 #include <kmi/atomic.h>
 
 #include <arch/cpu.h>
+#include <libfdt.h>
 
+#include "arch.h"
 #include "sbi.h"
 
+/** Supervisor software interrupt number in \c interrupts-extended. */
+#define IRQ_S_SOFT 1
+
+/** Connection between a hart and its ACLINT SSWI \c SETSSIP register. */
+struct sswi_hart {
+	/** Hart ID. */
+	id_t hartid;
+
+	/** Index of \c SETSSIP register of hart. */
+	size_t idx;
+};
+
+/**
+ * ACLINT supervisor software interrupt device state.
+ * If \c base is \c NULL, no device was found and IPIs go through the SBI.
+ */
+static struct {
+	/** Start of \c SETSSIP registers in direct mapping, one 32bit word per
+	 * hart. */
+	volatile uint32_t *base;
+
+	/** Number of harts connected to device. */
+	size_t nharts;
+
+	/** Connected harts. */
+	struct sswi_hart harts[MAX_CPUS];
+} sswi = { 0 };
+
 void cpu_assign(struct tcb *t)
 {
 	/* bounce cpu id forward */
@@ -42,7 +74,84 @@ struct tcb *cur_tcb()
 	return t;
 }
 
+/**
+ * Find \c SETSSIP register of hart.
+ *
+ * @param hartid Hart ID.
+ * @return Pointer to register, \c NULL if \p hartid isn't connected to the
+ * SSWI device.
+ */
+static volatile uint32_t *__sswi_reg(id_t hartid)
+{
+	if (!sswi.base)
+		return NULL;
+
+	for (size_t i = 0; i < sswi.nharts; ++i)
+		if (sswi.harts[i].hartid == hartid)
+			return &sswi.base[sswi.harts[i].idx];
+
+	return NULL;
+}
+
 void cpu_send_ipi(id_t cpu_id)
 {
-	sbi_send_ipi(1, cpu_id);
+	id_t hartid = cpuid_to_hartid(cpu_id);
+
+	/* writing 1 raises SSIP on the target hart directly, which is handled
+	 * exactly like an IPI from the SBI, just without the two trips through
+	 * M-mode */
+	volatile uint32_t *reg = __sswi_reg(hartid);
+	if (reg) {
+		/* make sure whatever we queued for the target is visible before
+		 * it wakes up */
+		atomic_thread_fence(memory_order_release);
+		*reg = 1;
+		return;
+	}
+
+	sbi_send_ipi(1, hartid);
+}
+
+void setup_ipi(const void *fdt)
+{
+	int node = fdt_node_offset_by_compatible(fdt, -1, "riscv,aclint-sswi");
+	if (node < 0)
+		return;
+
+	struct cell_info ci = get_cellinfo(fdt, fdt_parent_offset(fdt, node));
+	const void *reg = fdt_getprop(fdt, node, "reg", NULL);
+	int len = 0;
+	const uint32_t *ie = fdt_getprop(fdt, node, "interrupts-extended", &len);
+	if (!reg || !ie)
+		return;
+
+	int cpus = fdt_path_offset(fdt, "/cpus");
+	struct cell_info hi = get_cellinfo(fdt, cpus);
+
+	/* one entry per hart, each with #interrupt-cells = 1 like in
+	 * irq.c */
+	size_t n = len / (2 * sizeof(uint32_t));
+	for (size_t i = 0; i < n && sswi.nharts < MAX_CPUS; ++i) {
+		uint32_t phandle = fdt_load_int32_ptr(&ie[2 * i]);
+		uint32_t irq = fdt_load_int32_ptr(&ie[2 * i + 1]);
+		if (irq != IRQ_S_SOFT)
+			continue;
+
+		int intc = fdt_node_offset_by_phandle(fdt, phandle);
+		int cpu = fdt_parent_offset(fdt, intc);
+		const void *hart = fdt_getprop(fdt, cpu, "reg", NULL);
+		if (!hart)
+			continue;
+
+		sswi.harts[sswi.nharts++] = (struct sswi_hart){
+			.hartid = fdt_load_reg_addr(hi, hart, 0),
+			.idx = i
+		};
+	}
+
+	if (!sswi.nharts)
+		return;
+
+	sswi.base = (volatile uint32_t *)__va(fdt_load_reg_addr(ci, reg, 0));
+	info("aclint sswi: %zu harts, skipping sbi for ipis\n", sswi.nharts);
 }
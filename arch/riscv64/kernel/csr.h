@@ -67,6 +67,21 @@
 /** Address of \c sip CSR. */
 #define CSR_SIP 0x144
 
+/** Address of \c stimecmp CSR, requires Sstc. */
+#define CSR_STIMECMP 0x14D
+
+/** Address of \c stimecmph CSR, requires Sstc. Only on rv32. */
+#define CSR_STIMECMPH 0x15D
+
+/** Address of \c siselect CSR, requires Smaia/Ssaia. */
+#define CSR_SISELECT 0x150
+
+/** Address of \c sireg CSR, requires Smaia/Ssaia. */
+#define CSR_SIREG 0x151
+
+/** Address of \c stopei CSR, requires an IMSIC. */
+#define CSR_STOPEI 0x15C
+
 /** Address of \c satp CSR. */
 #define CSR_SATP 0x180
 
@@ -170,4 +185,15 @@
 	__asm__ volatile ("csrc " __ASM_STR( \
 				  csr) ", %0" : : "r" (val) : "memory")
 
+/**
+ * Swap CSR value.
+ *
+ * @param csr Name of CSR.
+ * @param res Where to store old value.
+ * @param val Value to write.
+ */
+#define csr_swap(csr, res, val)              \
+	__asm__ volatile ("csrrw %0, " __ASM_STR( \
+				  csr) ", %1" : "=r" (res) : "r" (val) : "memory")
+
 #endif /* KMI_CSR_H */
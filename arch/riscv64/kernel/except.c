@@ -9,8 +9,10 @@
 #include <kmi/types.h>
 #include <kmi/panic.h>
 #include <kmi/debug.h>
+#include <kmi/trace.h>
 #include <kmi/vmem.h>
 #include <kmi/bkl.h>
+#include <kmi/tcb.h>
 
 /**
  * Handle exception. Intended to be called from entry.S.
@@ -26,6 +28,8 @@ void riscv_handle_exception(void *pc, void *addr, unsigned long id)
 	case 13:
 	case 15: {
 		bkl_lock();
+		cur_tcb()->acct.s.faults++;
+		trace(TRACE_FAULT, (vm_t)addr, id);
 		handle_pagefault((vm_t)addr);
 		bkl_unlock();
 		break;
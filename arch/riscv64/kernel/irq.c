@@ -7,39 +7,645 @@
  */
 
 #include <kmi/attrs.h>
+#include <kmi/profile.h>
 #include <kmi/debug.h>
+#include <kmi/bits.h>
 #include <kmi/timer.h>
 #include <kmi/ipi.h>
 #include <kmi/irq.h>
+#include <arch/cpu.h>
+#include <libfdt.h>
+#include "arch.h"
 #include "csr.h"
 
 /** Defined in arch/riscv64/kernel/entry.S. */
 extern void handle_trap();
 
+/**
+ * @name PLIC register layout.
+ * Offsets from the start of the PLIC MMIO region.
+ */
+/** @{ */
+/** Priority of source, one 32bit word per source. */
+#define PLIC_PRIORITY(id) ((id) * 4)
+
+/** Enable bits of context, one bit per source. */
+#define PLIC_ENABLE(ctx, id) (0x2000 + (ctx) * 0x80 + ((id) / 32) * 4)
+
+/** Priority threshold of context. */
+#define PLIC_THRESHOLD(ctx) (0x200000 + (ctx) * 0x1000)
+
+/** Claim/complete register of context. */
+#define PLIC_CLAIM(ctx) (0x200004 + (ctx) * 0x1000)
+/** @} */
+
+/**
+ * @name APLIC register layout.
+ * Offsets from the start of the APLIC domain MMIO region.
+ */
+/** @{ */
+/** Domain configuration. */
+#define APLIC_DOMAINCFG 0x0000
+
+/** Interrupts enabled in domain. */
+#define APLIC_DOMAINCFG_IE (1 << 8)
+
+/** Domain delivers interrupts as MSIs. */
+#define APLIC_DOMAINCFG_DM (1 << 2)
+
+/** Source configuration, one 32bit word per source. */
+#define APLIC_SOURCECFG(id) ((id) * 4)
+
+/** Source is active on rising edge. */
+#define APLIC_SOURCECFG_EDGE1 4
+
+/** Source is active on falling edge. */
+#define APLIC_SOURCECFG_EDGE0 5
+
+/** Source is active while high. */
+#define APLIC_SOURCECFG_LEVEL1 6
+
+/** Source is active while low. */
+#define APLIC_SOURCECFG_LEVEL0 7
+
+/** Maximum number of sources, including the invalid source 0. */
+#define APLIC_MAX_SOURCES 1024
+
+/** Set pending bit of source. */
+#define APLIC_SETIPNUM 0x1CDC
+
+/** Enable source. */
+#define APLIC_SETIENUM 0x1EDC
+
+/** Disable source. */
+#define APLIC_CLRIENUM 0x1FDC
+
+/** MSI target of source, one 32bit word per source. */
+#define APLIC_TARGET(id) (0x3000 + (id) * 4)
+
+/**
+ * MSI target value.
+ *
+ * @param hart Index of hart's interrupt file.
+ * @param eiid External interrupt identity to send.
+ */
+#define APLIC_TARGET_MSI(hart, eiid) (((uint32_t)(hart) << 18) | (eiid))
+/** @} */
+
+/**
+ * @name IMSIC indirect registers.
+ * Accessed through \ref CSR_SISELECT and \ref CSR_SIREG.
+ */
+/** @{ */
+/** Interrupt delivery enable. */
+#define IMSIC_EIDELIVERY 0x70
+
+/** Interrupt priority threshold. */
+#define IMSIC_EITHRESHOLD 0x72
+
+/** First interrupt enable register. On rv64 only even ones exist, each
+ * covering 64 identities. */
+#define IMSIC_EIE0 0xC0
+/** @} */
+
+/** Supervisor external interrupt number in \c interrupts-extended. */
+#define IRQ_S_EXT 9
+
+/**
+ * @name Trigger types in FDT interrupt specifiers.
+ * Same values as in Linux's dt-bindings/interrupt-controller/irq.h.
+ */
+/** @{ */
+/** Rising edge. */
+#define DT_IRQ_EDGE_RISING 1
+
+/** Falling edge. */
+#define DT_IRQ_EDGE_FALLING 2
+
+/** Active high level. */
+#define DT_IRQ_LEVEL_HIGH 4
+
+/** Active low level. */
+#define DT_IRQ_LEVEL_LOW 8
+
+/** Mask covering all trigger types. */
+#define DT_IRQ_TYPE_MASK 0xf
+/** @} */
+
+/** Which interrupt controller we're using. */
+enum irq_ctrl {
+	/** Nothing found, no external interrupts. */
+	IRQ_CTRL_NONE,
+
+	/** Platform-level interrupt controller. */
+	IRQ_CTRL_PLIC,
+
+	/** Advanced interrupt architecture, APLIC in MSI mode forwarding
+	 * wired interrupts to per-hart IMSIC interrupt files. */
+	IRQ_CTRL_AIA,
+};
+
+/** Connection between a hart and the interrupt controller. */
+struct irq_hart {
+	/** Hart ID. */
+	id_t hartid;
+
+	/** PLIC supervisor context number or IMSIC interrupt file index,
+	 * depending on controller. */
+	size_t idx;
+};
+
+/** Interrupt controller state. */
+static struct {
+	/** Controller in use. */
+	enum irq_ctrl ctrl;
+
+	/** Start of PLIC or APLIC MMIO region in direct mapping. */
+	volatile uint32_t *base;
+
+	/** Number of wired interrupt sources, valid IDs are \c 1 .. \c ndev. */
+	size_t ndev;
+
+	/** Number of IMSIC interrupt identities, valid IDs are \c 1 .. \c
+	 * nids. Identities up to \c ndev are used for wired interrupts, the
+	 * rest are free for MSI capable devices. */
+	size_t nids;
+
+	/** Number of harts connected to controller. */
+	size_t nharts;
+
+	/** Bitmap of edge triggered APLIC sources. */
+	uint8_t edge[APLIC_MAX_SOURCES / 8];
+
+	/** Connected harts. */
+	struct irq_hart harts[MAX_CPUS];
+} ic = { 0 };
+
+/**
+ * Read interrupt controller register.
+ *
+ * @param off Offset of register.
+ * @return Value of register.
+ */
+static uint32_t __ic_read(size_t off)
+{
+	return ic.base[off / 4];
+}
+
+/**
+ * Write interrupt controller register.
+ *
+ * @param off Offset of register.
+ * @param v Value to write.
+ */
+static void __ic_write(size_t off, uint32_t v)
+{
+	ic.base[off / 4] = v;
+}
+
+/**
+ * Find connection of CPU to interrupt controller.
+ *
+ * @param cpu CPU ID.
+ * @return Pointer to connection, \c NULL if \p cpu isn't connected.
+ */
+static struct irq_hart *__ic_hart(id_t cpu)
+{
+	if (cpu < 0 || cpu >= MAX_CPUS)
+		return NULL;
+
+	id_t hartid = cpuid_to_hartid(cpu);
+	for (size_t i = 0; i < ic.nharts; ++i)
+		if (ic.harts[i].hartid == hartid)
+			return &ic.harts[i];
+
+	return NULL;
+}
+
+/**
+ * Collect harts connected to interrupt controller node.
+ * Harts are connected through the supervisor external interrupt of their
+ * interrupt controller in \c interrupts-extended, and for both the PLIC and
+ * IMSIC the index of the entry is the context/interrupt file number.
+ *
+ * @param fdt Global FDT pointer.
+ * @param node Interrupt controller node.
+ * @return Number of supervisor mode harts found.
+ */
+static size_t __collect_harts(const void *fdt, int node)
+{
+	int len = 0;
+	const uint32_t *ie = fdt_getprop(fdt, node, "interrupts-extended", &len);
+	if (!ie)
+		return 0;
+
+	int cpus = fdt_path_offset(fdt, "/cpus");
+	struct cell_info ci = get_cellinfo(fdt, cpus);
+
+	/* assume each interrupt controller has #interrupt-cells = 1, which as
+	 * far as I know is the only thing riscv,cpu-intc allows */
+	size_t n = len / (2 * sizeof(uint32_t));
+	ic.nharts = 0;
+	for (size_t i = 0; i < n && ic.nharts < MAX_CPUS; ++i) {
+		uint32_t phandle = fdt_load_int32_ptr(&ie[2 * i]);
+		uint32_t irq = fdt_load_int32_ptr(&ie[2 * i + 1]);
+		if (irq != IRQ_S_EXT)
+			continue;
+
+		int intc = fdt_node_offset_by_phandle(fdt, phandle);
+		int cpu = fdt_parent_offset(fdt, intc);
+		const void *hart = fdt_getprop(fdt, cpu, "reg", NULL);
+		if (!hart)
+			continue;
+
+		ic.harts[ic.nharts++] = (struct irq_hart){
+			.hartid = fdt_load_reg_addr(ci, hart, 0),
+			.idx = i
+		};
+	}
+
+	return ic.nharts;
+}
+
+/**
+ * Map MMIO region of node.
+ *
+ * @param fdt Global FDT pointer.
+ * @param node Node with \c reg property.
+ * @return \c true if succesful, \c false otherwise.
+ */
+static bool __map_ic(const void *fdt, int node)
+{
+	struct cell_info ci = get_cellinfo(fdt, fdt_parent_offset(fdt, node));
+	const void *reg = fdt_getprop(fdt, node, "reg", NULL);
+	if (!reg)
+		return false;
+
+	ic.base = (volatile uint32_t *)__va(fdt_load_reg_addr(ci, reg, 0));
+	return true;
+}
+
+/**
+ * Enable or disable source in PLIC context.
+ *
+ * @param ctx Context to modify.
+ * @param id Source.
+ * @param enable Whether to enable or disable \p id.
+ */
+static void __plic_enable(size_t ctx, irq_t id, bool enable)
+{
+	uint32_t bits = __ic_read(PLIC_ENABLE(ctx, id));
+	uint32_t bit = 1U << (id % 32);
+	__ic_write(PLIC_ENABLE(ctx, id), enable ? bits | bit : bits & ~bit);
+}
+
+/**
+ * Find PLIC in FDT and set it up.
+ * All sources start out disabled, with priority thresholds at zero so any
+ * enabled source with a nonzero priority gets through.
+ *
+ * @param fdt Global FDT pointer.
+ * @return \c true if a PLIC was found, \c false otherwise.
+ */
+static bool __setup_plic(const void *fdt)
+{
+	int node = fdt_node_offset_by_compatible(fdt, -1, "riscv,plic0");
+	if (node < 0)
+		node = fdt_node_offset_by_compatible(fdt, -1,
+		                                     "sifive,plic-1.0.0");
+
+	if (node < 0)
+		return false;
+
+	const void *ndev = fdt_getprop(fdt, node, "riscv,ndev", NULL);
+	if (!ndev || !__collect_harts(fdt, node) || !__map_ic(fdt, node))
+		return false;
+
+	ic.ndev = fdt_load_int32_ptr(ndev);
+	for (size_t i = 0; i < ic.nharts; ++i) {
+		size_t ctx = ic.harts[i].idx;
+		__ic_write(PLIC_THRESHOLD(ctx), 0);
+		for (irq_t id = 1; id <= ic.ndev; ++id)
+			__plic_enable(ctx, id, false);
+	}
+
+	ic.ctrl = IRQ_CTRL_PLIC;
+	info("plic: %zu sources, %zu supervisor contexts\n",
+	     ic.ndev, ic.nharts);
+	return true;
+}
+
+/**
+ * Find APLIC domain that delivers MSIs to supervisor level IMSIC.
+ * There's usually a machine level domain as well, which we're not allowed to
+ * touch, so match on \c msi-parent.
+ *
+ * @param fdt Global FDT pointer.
+ * @param imsic Supervisor level IMSIC node.
+ * @return APLIC node, negative if not found.
+ */
+static int __find_aplic(const void *fdt, int imsic)
+{
+	uint32_t phandle = fdt_get_phandle(fdt, imsic);
+	int node = -1;
+	while ((node = fdt_node_offset_by_compatible(fdt, node,
+	                                             "riscv,aplic")) >= 0) {
+		const void *p = fdt_getprop(fdt, node, "msi-parent", NULL);
+		if (p && fdt_load_int32_ptr(p) == phandle)
+			return node;
+	}
+
+	return -1;
+}
+
+/**
+ * Convert FDT trigger type to APLIC source mode.
+ *
+ * @param type Trigger type from interrupt specifier.
+ * @return Corresponding \c sourcecfg value.
+ */
+static uint32_t __aplic_sourcecfg(uint32_t type)
+{
+	switch (type & DT_IRQ_TYPE_MASK) {
+	case DT_IRQ_EDGE_RISING: return APLIC_SOURCECFG_EDGE1;
+	case DT_IRQ_EDGE_FALLING: return APLIC_SOURCECFG_EDGE0;
+	case DT_IRQ_LEVEL_LOW: return APLIC_SOURCECFG_LEVEL0;
+	/* unspecified or something we don't understand, level high is what
+	 * most devices use */
+	default: return APLIC_SOURCECFG_LEVEL1;
+	}
+}
+
+/**
+ * Configure trigger type of APLIC source.
+ *
+ * @param id Source ID.
+ * @param type Trigger type from interrupt specifier.
+ */
+static void __aplic_set_trigger(uint32_t id, uint32_t type)
+{
+	if (id == 0 || id > ic.ndev)
+		return;
+
+	uint32_t cfg = __aplic_sourcecfg(type);
+	__ic_write(APLIC_SOURCECFG(id), cfg);
+	if (cfg == APLIC_SOURCECFG_EDGE1 || cfg == APLIC_SOURCECFG_EDGE0)
+		bitmap_set(ic.edge, id);
+	else
+		bitmap_clear(ic.edge, id);
+}
+
+/**
+ * Get number of cells in interrupt specifiers of interrupt controller.
+ *
+ * @param fdt Global FDT pointer.
+ * @param node Interrupt controller node.
+ * @return Number of cells, \c 0 if not found.
+ */
+static size_t __irq_cells(const void *fdt, int node)
+{
+	const void *c = fdt_getprop(fdt, node, "#interrupt-cells", NULL);
+	return c ? fdt_load_int32_ptr(c) : 0;
+}
+
+/**
+ * Find interrupt parent of device node.
+ * \c interrupt-parent is inherited, so walk up the tree until one is found.
+ *
+ * @param fdt Global FDT pointer.
+ * @param node Device node.
+ * @return Phandle of interrupt parent, \c 0 if not found.
+ */
+static uint32_t __irq_parent(const void *fdt, int node)
+{
+	while (node >= 0) {
+		const void *p = fdt_getprop(fdt, node, "interrupt-parent", NULL);
+		if (p)
+			return fdt_load_int32_ptr(p);
+
+		node = fdt_parent_offset(fdt, node);
+	}
+
+	return 0;
+}
+
+/**
+ * Set trigger types of APLIC sources from the devices connected to it.
+ * Devices use either \c interrupts with an inherited \c interrupt-parent, or
+ * \c interrupts-extended where each specifier carries its own controller.
+ * Sources nobody mentions are left as they are.
+ *
+ * @param fdt Global FDT pointer.
+ * @param aplic APLIC node.
+ */
+static void __aplic_triggers(const void *fdt, int aplic)
+{
+	uint32_t phandle = fdt_get_phandle(fdt, aplic);
+	size_t cells = __irq_cells(fdt, aplic);
+	/* no cell for the trigger type, nothing to read */
+	if (cells < 2)
+		return;
+
+	int node = -1;
+	while ((node = fdt_next_node(fdt, node, NULL)) >= 0) {
+		int len = 0;
+		const uint32_t *p = fdt_getprop(fdt, node, "interrupts", &len);
+		if (p && __irq_parent(fdt, node) == phandle) {
+			size_t n = len / sizeof(uint32_t);
+			for (size_t i = 0; i + cells <= n; i += cells) {
+				uint32_t id = fdt_load_int32_ptr(&p[i]);
+				uint32_t type = fdt_load_int32_ptr(&p[i + 1]);
+				__aplic_set_trigger(id, type);
+			}
+		}
+
+		p = fdt_getprop(fdt, node, "interrupts-extended", &len);
+		if (!p)
+			continue;
+
+		size_t n = len / sizeof(uint32_t);
+		for (size_t i = 0; i < n;) {
+			uint32_t ph = fdt_load_int32_ptr(&p[i]);
+			int intc = fdt_node_offset_by_phandle(fdt, ph);
+			size_t c = intc < 0 ? 0 : __irq_cells(fdt, intc);
+			/* can't tell where the next specifier starts */
+			if (c == 0 || i + 1 + c > n)
+				break;
+
+			if (ph == phandle) {
+				uint32_t id = fdt_load_int32_ptr(&p[i + 1]);
+				uint32_t type = fdt_load_int32_ptr(&p[i + 2]);
+				__aplic_set_trigger(id, type);
+			}
+
+			i += 1 + c;
+		}
+	}
+}
+
+/**
+ * Find IMSIC and APLIC in FDT and set them up.
+ * Wired source \c n is sent as identity \c n, so IDs look the same as they
+ * would with a PLIC. Every hart enables all identities in its own interrupt
+ * file in \ref __setup_imsic_hart(), as interrupt files can only be accessed
+ * by their own hart. Whether an interrupt is delivered is then decided by the
+ * APLIC's enable bits alone.
+ *
+ * @param fdt Global FDT pointer.
+ * @return \c true if AIA was found, \c false otherwise.
+ */
+static bool __setup_aia(const void *fdt)
+{
+	int imsic = -1;
+	while ((imsic = fdt_node_offset_by_compatible(fdt, imsic,
+	                                              "riscv,imsics")) >= 0) {
+		if (__collect_harts(fdt, imsic))
+			break;
+	}
+
+	if (imsic < 0)
+		return false;
+
+	const void *nids = fdt_getprop(fdt, imsic, "riscv,num-ids", NULL);
+	int aplic = __find_aplic(fdt, imsic);
+	if (!nids || aplic < 0)
+		return false;
+
+	const void *ndev = fdt_getprop(fdt, aplic, "riscv,num-sources", NULL);
+	if (!ndev || !__map_ic(fdt, aplic))
+		return false;
+
+	ic.nids = fdt_load_int32_ptr(nids);
+	ic.ndev = fdt_load_int32_ptr(ndev);
+	if (ic.ndev > ic.nids)
+		ic.ndev = ic.nids;
+
+	if (ic.ndev >= APLIC_MAX_SOURCES)
+		ic.ndev = APLIC_MAX_SOURCES - 1;
+
+	__ic_write(APLIC_DOMAINCFG, 0);
+	for (irq_t id = 1; id <= ic.ndev; ++id) {
+		__ic_write(APLIC_CLRIENUM, id);
+		__ic_write(APLIC_SOURCECFG(id), APLIC_SOURCECFG_LEVEL1);
+	}
+
+	__aplic_triggers(fdt, aplic);
+
+	__ic_write(APLIC_DOMAINCFG, APLIC_DOMAINCFG_IE | APLIC_DOMAINCFG_DM);
+
+	ic.ctrl = IRQ_CTRL_AIA;
+	info("aia: %zu sources, %zu identities, %zu interrupt files\n",
+	     ic.ndev, ic.nids, ic.nharts);
+	return true;
+}
+
+/**
+ * Write IMSIC indirect register of current hart.
+ *
+ * @param reg Register number.
+ * @param v Value to write.
+ */
+static void __imsic_write(unsigned long reg, unsigned long v)
+{
+	csr_write(CSR_SISELECT, reg);
+	csr_write(CSR_SIREG, v);
+}
+
+/** Set up interrupt file of current hart. */
+static void __setup_imsic_hart()
+{
+	/* identity 0 is never valid, but its enable bit is read-only zero so
+	 * we can just blanket enable everything */
+	for (size_t i = 0; i <= ic.nids / 64; ++i)
+		__imsic_write(IMSIC_EIE0 + 2 * i, -1UL);
+
+	__imsic_write(IMSIC_EITHRESHOLD, 0);
+	__imsic_write(IMSIC_EIDELIVERY, 1);
+}
+
 void setup_irq(void *fdt)
 {
-	UNUSED(fdt);
 	csr_write(CSR_STVEC, &handle_trap);
 
+	/* secondary cores pass NULL, the controller has already been found by
+	 * then and they only have to set up their own state */
+	if (fdt && !__setup_aia(fdt) && !__setup_plic(fdt))
+		info("no interrupt controller found\n");
+
+	if (ic.ctrl == IRQ_CTRL_AIA)
+		__setup_imsic_hart();
+
 	long s = 0;
 	csr_read(CSR_SIE, s);
 	info("CSR_SIE: %lx\n", s);
 }
 
-stat_t activate_irq(irq_t id)
+size_t irq_sources()
+{
+	switch (ic.ctrl) {
+	case IRQ_CTRL_PLIC: return ic.ndev + 1;
+	case IRQ_CTRL_AIA: return ic.nids + 1;
+	default: return 0;
+	}
+}
+
+stat_t activate_irq(irq_t id, id_t cpu)
 {
-	/** @todo implement plic */
+	if (ic.ctrl == IRQ_CTRL_NONE)
+		return ERR_NOINIT;
+
+	if (id == 0 || id >= irq_sources())
+		return ERR_INVAL;
+
+	struct irq_hart *h = __ic_hart(cpu);
+	if (!h)
+		return ERR_INVAL;
+
+	if (ic.ctrl == IRQ_CTRL_AIA) {
+		/* identities above the wired sources belong to MSI capable
+		 * devices, which pick their target themselves */
+		if (id > ic.ndev)
+			return OK;
+
+		__ic_write(APLIC_TARGET(id), APLIC_TARGET_MSI(h->idx, id));
+		__ic_write(APLIC_SETIENUM, id);
+		return OK;
+	}
+
+	/* only ever enable source in one context, otherwise every hart would
+	 * race to claim it */
+	for (size_t i = 0; i < ic.nharts; ++i)
+		__plic_enable(ic.harts[i].idx, id, false);
+
+	__ic_write(PLIC_PRIORITY(id), 1);
+	__plic_enable(h->idx, id, true);
 	return OK;
 }
 
 stat_t deactivate_irq(irq_t id)
 {
-	/** @todo implement plic */
+	if (ic.ctrl == IRQ_CTRL_NONE)
+		return ERR_NOINIT;
+
+	if (id == 0 || id >= irq_sources())
+		return ERR_INVAL;
+
+	if (ic.ctrl == IRQ_CTRL_AIA) {
+		if (id <= ic.ndev)
+			__ic_write(APLIC_CLRIENUM, id);
+
+		return OK;
+	}
+
+	for (size_t i = 0; i < ic.nharts; ++i)
+		__plic_enable(ic.harts[i].idx, id, false);
+
+	__ic_write(PLIC_PRIORITY(id), 0);
 	return OK;
 }
 
 /** Bit pattern representing supervisor external, timer and software irqs. */
-#define SR_IRQS (1 << 9) | (1 << 5) | (1 << 3)
+#define SR_IRQS ((1 << 9) | (1 << 5) | (1 << 1))
 
 /* very simple for now */
 void enable_irqs()
@@ -52,10 +658,49 @@ void disable_irqs()
 	csr_clear(CSR_SIE, SR_IRQS);
 }
 
+bool irqs_pending()
+{
+	long sip = 0, sie = 0;
+	csr_read(CSR_SIP, sip);
+	csr_read(CSR_SIE, sie);
+	return sip & sie & SR_IRQS;
+}
+
 irq_t get_irq()
 {
-	/** @todo implement */
-	return 0;
+	if (ic.ctrl == IRQ_CTRL_AIA) {
+		/* reading and writing stopei in one go claims the top
+		 * interrupt, no MMIO involved */
+		unsigned long top = 0;
+		csr_swap(CSR_STOPEI, top, 0);
+		return top >> 16;
+	}
+
+	struct irq_hart *h = __ic_hart(cpu_id());
+	if (ic.ctrl != IRQ_CTRL_PLIC || !h)
+		return 0;
+
+	return __ic_read(PLIC_CLAIM(h->idx));
+}
+
+void complete_irq(irq_t id)
+{
+	if (ic.ctrl == IRQ_CTRL_AIA) {
+		/* the APLIC doesn't resend level triggered interrupts on its
+		 * own, so poke the pending bit. It only sticks if the source is
+		 * still asserted. Edge triggered sources would take the poke as
+		 * a new edge, so leave them alone. */
+		if (id <= ic.ndev && !bitmap_is_set(ic.edge, id))
+			__ic_write(APLIC_SETIPNUM, id);
+
+		return;
+	}
+
+	struct irq_hart *h = __ic_hart(cpu_id());
+	if (ic.ctrl != IRQ_CTRL_PLIC || !h)
+		return;
+
+	__ic_write(PLIC_CLAIM(h->idx), id);
 }
 
 /**
@@ -82,7 +727,12 @@ void riscv_handle_interrupt(unsigned long id)
 	switch (id) {
 	/* I think */
 	case 1: handle_ipi(); break;
-	case 5: handle_timer(); break;
+	case 5:
+		/* the kernel isn't interruptible, so whatever was interrupted
+		 * was in userspace */
+		profile_sample(cur_tcb());
+		handle_timer();
+		break;
 	case 9: handle_irq(); break;
 	default: riscv_unknown_interrupt(id); break;
 	}
@@ -9,11 +9,18 @@
 #include <kmi/syscalls.h>
 #include <kmi/utils.h>
 #include <arch/arch.h>
+#include "arch.h"
 #include "csr.h"
 
 stat_t setup_arch(void *fdt)
 {
-	UNUSED(fdt);
+	/* secondary cores get NULL, the boot core has already found
+	 * everything there is to find */
+	if (fdt) {
+		setup_ipi(fdt);
+		setup_pmu();
+	}
+
 	/* allow supervisor code to touch user pages */
 	csr_set(CSR_SSTATUS, SSTATUS_SUM);
 	/* mark that we want to eventually jump to userspace */
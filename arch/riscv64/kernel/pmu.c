@@ -0,0 +1,294 @@
+/* SPDX-License-Identifier: copyleft-next-0.3.1 */
+/* Copyright 2024, Kim Kuparinen < kimi.h.kuparinen@gmail.com > */
+
+/**
+ * @file pmu.c
+ * riscv64 implementation of hardware performance counters, through the SBI
+ * PMU extension. The SBI configures and starts counters for us, and hardware
+ * counters are read directly through their CSRs while firmware counters have
+ * to be read through the SBI.
+ */
+
+#include <kmi/debug.h>
+#include <arch/pmu.h>
+#include "arch.h"
+#include "csr.h"
+#include "sbi.h"
+
+/** Maximum number of counters we keep track of, the SBI takes counter masks as
+ * unsigned longs anyway. */
+#define PMU_MAX_COUNTERS (sizeof(unsigned long) * 8)
+
+/** Counter info bit marking a firmware counter. */
+#define PMU_INFO_FW (1UL << (sizeof(unsigned long) * 8 - 1))
+
+/**
+ * CSR number from counter info.
+ *
+ * @param info Counter info.
+ * @return CSR number of counter.
+ */
+#define PMU_INFO_CSR(info) ((info) & 0xfff)
+
+/**
+ * Counter width from counter info.
+ *
+ * @param info Counter info.
+ * @return Width of counter in bits.
+ */
+#define PMU_INFO_WIDTH(info) ((((info) >> 12) & 0x3f) + 1)
+
+/** SBI event type of generic hardware events. */
+#define SBI_PMU_HW_GENERAL 0
+
+/** SBI event type of cache events. */
+#define SBI_PMU_HW_CACHE 1
+
+/**
+ * SBI event index.
+ *
+ * @param type Event type.
+ * @param code Event code.
+ * @return Corresponding event index.
+ */
+#define SBI_PMU_EVENT(type, code) (((type) << 16) | (code))
+
+/**
+ * SBI cache event index.
+ *
+ * @param cache Which cache, \c 0 is L1D, \c 1 L1I, \c 3 DTLB and \c 4 ITLB.
+ * @param op Operation, \c 0 is read.
+ * @param result Result, \c 0 is access and \c 1 miss.
+ * @return Corresponding event index.
+ */
+#define SBI_PMU_CACHE_EVENT(cache, op, result) \
+	SBI_PMU_EVENT(SBI_PMU_HW_CACHE, ((cache) << 3) | ((op) << 1) | (result))
+
+/** SBI event index of each \ref sys_pmu_event. */
+static const unsigned long pmu_events[PMU_EVENTS] = {
+	[PMU_CYCLES] = SBI_PMU_EVENT(SBI_PMU_HW_GENERAL, 1),
+	[PMU_INSTRET] = SBI_PMU_EVENT(SBI_PMU_HW_GENERAL, 2),
+	[PMU_CACHE_REFS] = SBI_PMU_EVENT(SBI_PMU_HW_GENERAL, 3),
+	[PMU_CACHE_MISSES] = SBI_PMU_EVENT(SBI_PMU_HW_GENERAL, 4),
+	[PMU_BRANCHES] = SBI_PMU_EVENT(SBI_PMU_HW_GENERAL, 5),
+	[PMU_BRANCH_MISSES] = SBI_PMU_EVENT(SBI_PMU_HW_GENERAL, 6),
+	[PMU_L1D_READ_MISSES] = SBI_PMU_CACHE_EVENT(0, 0, 1),
+	[PMU_L1I_READ_MISSES] = SBI_PMU_CACHE_EVENT(1, 0, 1),
+	[PMU_DTLB_READ_MISSES] = SBI_PMU_CACHE_EVENT(3, 0, 1),
+	[PMU_ITLB_READ_MISSES] = SBI_PMU_CACHE_EVENT(4, 0, 1),
+};
+
+/** Counters found by \ref setup_pmu(). */
+static struct {
+	/** Number of counters. */
+	size_t num;
+
+	/** Info of each counter, as returned by the SBI. */
+	unsigned long info[PMU_MAX_COUNTERS];
+} pmu = { 0 };
+
+void setup_pmu()
+{
+	struct sbiret r = sbi_pmu_num_counters();
+	if (r.error) {
+		info("pmu: not available\n");
+		return;
+	}
+
+	size_t num = r.value;
+	if (num > PMU_MAX_COUNTERS)
+		num = PMU_MAX_COUNTERS;
+
+	/* assume every hart has the same counters */
+	for (size_t i = 0; i < num; ++i) {
+		r = sbi_pmu_counter_get_info(i);
+		if (r.error)
+			break;
+
+		pmu.info[i] = r.value;
+		pmu.num++;
+	}
+
+	info("pmu: %zu counters\n", pmu.num);
+}
+
+size_t pmu_counters()
+{
+	return pmu.num;
+}
+
+stat_t pmu_counter_info(size_t idx, unsigned long *csr, size_t *width)
+{
+	if (idx >= pmu.num)
+		return ERR_INVAL;
+
+	unsigned long info = pmu.info[idx];
+	if (info & PMU_INFO_FW) {
+		*csr = 0;
+		*width = 64;
+		return OK;
+	}
+
+	*csr = PMU_INFO_CSR(info);
+	*width = PMU_INFO_WIDTH(info);
+	return OK;
+}
+
+stat_t pmu_start(enum sys_pmu_event event, size_t *idx)
+{
+	if (!pmu.num)
+		return ERR_NOINIT;
+
+	if (event >= PMU_EVENTS)
+		return ERR_INVAL;
+
+	unsigned long mask = pmu.num == PMU_MAX_COUNTERS
+	                     ? -1UL : (1UL << pmu.num) - 1;
+
+	struct sbiret r = sbi_pmu_counter_config_matching(0, mask,
+		SBI_PMU_CFG_FLAG_CLEAR_VALUE | SBI_PMU_CFG_FLAG_AUTO_START,
+		pmu_events[event], 0);
+
+	if (r.error)
+		return ERR_NF;
+
+	*idx = r.value;
+	return OK;
+}
+
+void pmu_stop(size_t idx)
+{
+	sbi_pmu_counter_stop(idx, 1, SBI_PMU_STOP_FLAG_RESET);
+}
+
+/**
+ * Read counter CSR. CSR numbers are encoded into the instruction, so
+ * unfortunately there's no way around a big switch.
+ *
+ * @param csr CSR number.
+ * @return Value of CSR, \c 0 if \p csr isn't a counter.
+ */
+static unsigned long __read_counter_csr(unsigned long csr)
+{
+	unsigned long v = 0;
+	switch (csr) {
+	case 0xc00: csr_read(0xc00, v); break;
+	case 0xc01: csr_read(0xc01, v); break;
+	case 0xc02: csr_read(0xc02, v); break;
+	case 0xc03: csr_read(0xc03, v); break;
+	case 0xc04: csr_read(0xc04, v); break;
+	case 0xc05: csr_read(0xc05, v); break;
+	case 0xc06: csr_read(0xc06, v); break;
+	case 0xc07: csr_read(0xc07, v); break;
+	case 0xc08: csr_read(0xc08, v); break;
+	case 0xc09: csr_read(0xc09, v); break;
+	case 0xc0a: csr_read(0xc0a, v); break;
+	case 0xc0b: csr_read(0xc0b, v); break;
+	case 0xc0c: csr_read(0xc0c, v); break;
+	case 0xc0d: csr_read(0xc0d, v); break;
+	case 0xc0e: csr_read(0xc0e, v); break;
+	case 0xc0f: csr_read(0xc0f, v); break;
+	case 0xc10: csr_read(0xc10, v); break;
+	case 0xc11: csr_read(0xc11, v); break;
+	case 0xc12: csr_read(0xc12, v); break;
+	case 0xc13: csr_read(0xc13, v); break;
+	case 0xc14: csr_read(0xc14, v); break;
+	case 0xc15: csr_read(0xc15, v); break;
+	case 0xc16: csr_read(0xc16, v); break;
+	case 0xc17: csr_read(0xc17, v); break;
+	case 0xc18: csr_read(0xc18, v); break;
+	case 0xc19: csr_read(0xc19, v); break;
+	case 0xc1a: csr_read(0xc1a, v); break;
+	case 0xc1b: csr_read(0xc1b, v); break;
+	case 0xc1c: csr_read(0xc1c, v); break;
+	case 0xc1d: csr_read(0xc1d, v); break;
+	case 0xc1e: csr_read(0xc1e, v); break;
+	case 0xc1f: csr_read(0xc1f, v); break;
+#if __riscv_xlen == 32
+	case 0xc80: csr_read(0xc80, v); break;
+	case 0xc81: csr_read(0xc81, v); break;
+	case 0xc82: csr_read(0xc82, v); break;
+	case 0xc83: csr_read(0xc83, v); break;
+	case 0xc84: csr_read(0xc84, v); break;
+	case 0xc85: csr_read(0xc85, v); break;
+	case 0xc86: csr_read(0xc86, v); break;
+	case 0xc87: csr_read(0xc87, v); break;
+	case 0xc88: csr_read(0xc88, v); break;
+	case 0xc89: csr_read(0xc89, v); break;
+	case 0xc8a: csr_read(0xc8a, v); break;
+	case 0xc8b: csr_read(0xc8b, v); break;
+	case 0xc8c: csr_read(0xc8c, v); break;
+	case 0xc8d: csr_read(0xc8d, v); break;
+	case 0xc8e: csr_read(0xc8e, v); break;
+	case 0xc8f: csr_read(0xc8f, v); break;
+	case 0xc90: csr_read(0xc90, v); break;
+	case 0xc91: csr_read(0xc91, v); break;
+	case 0xc92: csr_read(0xc92, v); break;
+	case 0xc93: csr_read(0xc93, v); break;
+	case 0xc94: csr_read(0xc94, v); break;
+	case 0xc95: csr_read(0xc95, v); break;
+	case 0xc96: csr_read(0xc96, v); break;
+	case 0xc97: csr_read(0xc97, v); break;
+	case 0xc98: csr_read(0xc98, v); break;
+	case 0xc99: csr_read(0xc99, v); break;
+	case 0xc9a: csr_read(0xc9a, v); break;
+	case 0xc9b: csr_read(0xc9b, v); break;
+	case 0xc9c: csr_read(0xc9c, v); break;
+	case 0xc9d: csr_read(0xc9d, v); break;
+	case 0xc9e: csr_read(0xc9e, v); break;
+	case 0xc9f: csr_read(0xc9f, v); break;
+#endif
+	}
+
+	return v;
+}
+
+#if __riscv_xlen == 64
+/**
+ * Read 64bit hardware counter.
+ *
+ * @param csr CSR number of counter.
+ * @return Value of counter.
+ */
+static uint64_t __read_counter(unsigned long csr)
+{
+	return __read_counter_csr(csr);
+}
+#else
+/**
+ * Read 64bit hardware counter.
+ *
+ * @param csr CSR number of lower half of counter.
+ * @return Value of counter.
+ */
+static uint64_t __read_counter(unsigned long csr)
+{
+	uint64_t hi, lo, check;
+
+	/* avoid overflow between reading high and low */
+	do {
+		hi = __read_counter_csr(csr + 0x80);
+		lo = __read_counter_csr(csr);
+		check = __read_counter_csr(csr + 0x80);
+	} while (hi != check);
+
+	return (hi << 32) | lo;
+}
+#endif
+
+uint64_t pmu_read(size_t idx)
+{
+	if (idx >= pmu.num)
+		return 0;
+
+	unsigned long info = pmu.info[idx];
+	if (info & PMU_INFO_FW)
+		return sbi_pmu_counter_fw_read(idx).value;
+
+	return __read_counter(PMU_INFO_CSR(info));
+}
+
+void pmu_user(unsigned long mask)
+{
+	csr_write(CSR_SCOUNTEREN, mask);
+}
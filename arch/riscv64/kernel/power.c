@@ -7,6 +7,7 @@
  */
 
 #include <kmi/power.h>
+#include <kmi/debug.h>
 #include "sbi.h"
 
 /**
@@ -33,6 +34,8 @@ stat_t poweroff(enum poweroff_type type)
 {
 	/** \todo this only shuts down the cpu itself, but may leave the SOC
 	 * active. Should read from fdt poweroff and syscon-poweroff etc */
+	dbg_sync();
+
 	switch (type) {
 	case SYS_SHUTDOWN:
 		sbi_system_reset(SBI_SHUTDOWN, SBI_NO_REASON);
@@ -55,3 +58,9 @@ stat_t sleep()
 	sbi_hart_stop();
 	return ERR_MISC;
 }
+
+void idle()
+{
+	/* wfi returns when (sip & sie) != 0, regardless of sstatus.SIE */
+	__asm__ volatile ("wfi" ::: "memory");
+}
@@ -8,6 +8,8 @@
 
 #include <kmi/tcb.h>
 #include <kmi/elf.h>
+#include <kmi/vmem.h>
+#include <kmi/mem.h>
 #include <kmi/bkl.h>
 #include <kmi/debug.h>
 #include <kmi/string.h>
@@ -135,6 +137,46 @@ vm_t get_stack(struct tcb *t)
 	return r->sp;
 }
 
+size_t get_backtrace(struct tcb *t, unsigned long long *frames, size_t max)
+{
+	pm_t regs = __physical_regs(t);
+	struct riscv_regs *r = (struct riscv_regs *)(regs) - 1;
+	struct vmem *b = get_cproc(t)->uvmem.vmem;
+
+	/* with frame pointers, s0 points just past the return address and the
+	 * previous frame pointer */
+	vm_t fp = r->s0;
+	size_t n = 0;
+	while (n < max && fp && is_aligned(fp, 2 * sizeof(long))) {
+		size_t left = 0;
+		vm_t a = user_addr(b, fp - 2 * sizeof(long), VM_R, &left);
+		if (!a || left < 2 * sizeof(long))
+			break;
+
+		/* stacks live in RAM, anything else could be a device mapping
+		 * where reads have side effects */
+		pm_t p = (pm_t)__pa(a);
+		if (p < get_ram_base()
+		    || p + 2 * sizeof(long) > get_ram_base() + get_ram_size())
+			break;
+
+		unsigned long *f = (unsigned long *)a;
+		if (!f[1])
+			break;
+
+		frames[n++] = f[1];
+
+		/* callers are higher up on the stack, anything else means
+		 * we're reading garbage */
+		if (f[0] <= fp)
+			break;
+
+		fp = f[0];
+	}
+
+	return n;
+}
+
 void copy_regs(struct tcb *d, struct tcb *s)
 {
 	pm_t rgs = __physical_regs(s);
@@ -148,9 +190,16 @@ void copy_regs(struct tcb *d, struct tcb *s)
 void adjust_ipi(struct tcb *t)
 {
 	UNUSED(t);
+	/* software interrupts stay pending until cleared */
+	csr_clear(CSR_SIP, 1 << 1);
 }
 
 void adjust_syscall(struct tcb *t)
 {
 	t->exec += 4;
 }
+
+void restart_syscall(struct tcb *t)
+{
+	t->exec -= 4;
+}
@@ -183,4 +183,114 @@ static inline struct sbiret sbi_hart_status(unsigned long hartid)
  */
 #define SBI_HART_STARTED 0
 
+/** Performance monitoring unit extension ID. */
+#define EID_PMU 0x504D55
+
+/** Function ID of sbi_pmu_num_counters(). */
+#define FID_PMU_NUM_COUNTERS 0
+
+/** Function ID of sbi_pmu_counter_get_info(). */
+#define FID_PMU_COUNTER_GET_INFO 1
+
+/** Function ID of sbi_pmu_counter_config_matching(). */
+#define FID_PMU_COUNTER_CONFIG_MATCHING 2
+
+/** Function ID of sbi_pmu_counter_start(). */
+#define FID_PMU_COUNTER_START 3
+
+/** Function ID of sbi_pmu_counter_stop(). */
+#define FID_PMU_COUNTER_STOP 4
+
+/** Function ID of sbi_pmu_counter_fw_read(). */
+#define FID_PMU_COUNTER_FW_READ 5
+
+/** Clear counter when configuring it. */
+#define SBI_PMU_CFG_FLAG_CLEAR_VALUE (1 << 1)
+
+/** Start counter right after configuring it. */
+#define SBI_PMU_CFG_FLAG_AUTO_START (1 << 2)
+
+/** Release counter when stopping it. */
+#define SBI_PMU_STOP_FLAG_RESET (1 << 0)
+
+/**
+ * Get number of counters, both hardware and firmware.
+ *
+ * @return SBI call return. \see sbiret.
+ */
+static inline struct sbiret sbi_pmu_num_counters()
+{
+	return sbi_ecall(EID_PMU, FID_PMU_NUM_COUNTERS, 0, 0, 0, 0, 0, 0);
+}
+
+/**
+ * Get information about counter.
+ *
+ * @param counter_idx Counter index.
+ * @return SBI call return, value holds CSR number in bits 0-11, width minus
+ * one in bits 12-17 and whether the counter is a firmware counter in the top
+ * bit. \see sbiret.
+ */
+static inline struct sbiret sbi_pmu_counter_get_info(unsigned long counter_idx)
+{
+	return sbi_ecall(EID_PMU, FID_PMU_COUNTER_GET_INFO, counter_idx,
+	                 0, 0, 0, 0, 0);
+}
+
+/**
+ * Find and configure counter that can count event.
+ *
+ * @param counter_idx_base First counter to consider.
+ * @param counter_idx_mask Which counters after \p counter_idx_base to
+ * consider.
+ * @param config_flags Configuration flags.
+ * @param event_idx Event to count.
+ * @param event_data Event specific extra data.
+ * @return SBI call return, value holds index of configured counter. \see
+ * sbiret.
+ */
+static inline struct sbiret sbi_pmu_counter_config_matching(
+	unsigned long counter_idx_base, unsigned long counter_idx_mask,
+	unsigned long config_flags, unsigned long event_idx,
+	uint64_t event_data)
+{
+#if defined(riscv32)
+	return sbi_ecall(EID_PMU, FID_PMU_COUNTER_CONFIG_MATCHING,
+	                 counter_idx_base, counter_idx_mask, config_flags,
+	                 event_idx, event_data, event_data >> 32);
+#else
+	return sbi_ecall(EID_PMU, FID_PMU_COUNTER_CONFIG_MATCHING,
+	                 counter_idx_base, counter_idx_mask, config_flags,
+	                 event_idx, event_data, 0);
+#endif
+}
+
+/**
+ * Stop counters.
+ *
+ * @param counter_idx_base First counter to stop.
+ * @param counter_idx_mask Which counters after \p counter_idx_base to stop.
+ * @param stop_flags Stop flags.
+ * @return SBI call return. \see sbiret.
+ */
+static inline struct sbiret sbi_pmu_counter_stop(unsigned long counter_idx_base,
+                                                 unsigned long counter_idx_mask,
+                                                 unsigned long stop_flags)
+{
+	return sbi_ecall(EID_PMU, FID_PMU_COUNTER_STOP, counter_idx_base,
+	                 counter_idx_mask, stop_flags, 0, 0, 0);
+}
+
+/**
+ * Read firmware counter.
+ *
+ * @param counter_idx Counter index.
+ * @return SBI call return, value holds counter value. \see sbiret.
+ */
+static inline struct sbiret sbi_pmu_counter_fw_read(unsigned long counter_idx)
+{
+	return sbi_ecall(EID_PMU, FID_PMU_COUNTER_FW_READ, counter_idx,
+	                 0, 0, 0, 0, 0);
+}
+
 #endif /* KMI_RISCV_SBI_H */
@@ -114,6 +114,11 @@ void smp_bringup(struct vmem *b, void *fdt)
 	}
 }
 
+size_t smp_cpus()
+{
+	return cpus;
+}
+
 /**
  * Called from secondary_bringup.S to finish bringing up core we're running on.
  *
@@ -152,6 +157,7 @@ __noreturn void core_bringup(long hartid)
 
 	/* now that we're in our own virtual address space, set stack etc. */
 	set_thread(t);
+	dbg_defer();
 
 	info("core %ld releasing BKL\n", (long)cpuid);
 	run_init(t, NULL, NULL);
@@ -6,22 +6,110 @@
  * riscv64 implementation of arch-specific timers.
  */
 
+#include <kmi/string.h>
+#include <kmi/debug.h>
 #include <arch/timer.h>
 #include <libfdt.h>
 #include "csr.h"
 #include "sbi.h"
 
+/** Whether we can write \c stimecmp directly instead of going through SBI. */
+static bool has_sstc = false;
+
+/**
+ * Check if ISA string contains extension.
+ *
+ * Multi-letter extensions are separated by underscores, and we don't really
+ * care about where exactly in the string the extension is.
+ *
+ * @param isa ISA string, something like \c rv64imafdc_zicsr_sstc.
+ * @param ext Lowercase extension name to look for.
+ * @return \c true if \p ext was found, \c false otherwise.
+ */
+static bool __isa_has(const char *isa, const char *ext)
+{
+	size_t len = strlen(ext);
+	const char *s = strchr(isa, '_');
+	while (s) {
+		s++;
+		if (strncmp(s, ext, len) == 0 && (s[len] == '_' || s[len] == 0))
+			return true;
+
+		s = strchr(s, '_');
+	}
+
+	return false;
+}
+
+/**
+ * Check if FDT advertises the Sstc extension.
+ *
+ * Newer device trees list extensions in \c riscv,isa-extensions, older ones
+ * only have the \c riscv,isa string, so check both. We assume all harts are
+ * identical, so only the first cpu node is checked.
+ *
+ * @param fdt Global FDT pointer.
+ * @return \c true if Sstc is available, \c false otherwise.
+ */
+static bool __detect_sstc(const void *fdt)
+{
+	int cpu_offset = fdt_path_offset(fdt, "/cpus");
+	int node = fdt_first_subnode(fdt, cpu_offset);
+	if (node < 0)
+		return false;
+
+	int len = 0;
+	const char *exts = fdt_getprop(fdt, node, "riscv,isa-extensions", &len);
+	for (int i = 0; exts && i < len; i += strlen(exts + i) + 1)
+		if (strcmp(exts + i, "sstc") == 0)
+			return true;
+
+	const char *isa = fdt_getprop(fdt, node, "riscv,isa", NULL);
+	return isa && __isa_has(isa, "sstc");
+}
+
 ticks_t stat_timer(const void *fdt)
 {
+	has_sstc = __detect_sstc(fdt);
+	info("timer: %s\n", has_sstc ? "sstc" : "sbi");
+
 	int cpu_offset = fdt_path_offset(fdt, "/cpus");
 	uint8_t *tf_reg = (uint8_t *)fdt_getprop(fdt, cpu_offset,
 	                                         "timebase-frequency", NULL);
 	return (ticks_t)fdt_load_int32_ptr(tf_reg);
 }
 
+#if __riscv_xlen == 64
+/**
+ * Write \c stimecmp.
+ *
+ * @param ticks Time point for timer to trigger.
+ */
+static void __set_stimecmp(ticks_t ticks)
+{
+	csr_write(CSR_STIMECMP, ticks);
+}
+#else
+static void __set_stimecmp(ticks_t ticks)
+{
+	/* the 64bit compare value is written one half at a time, so park the
+	 * low half at its maximum first. That way the value is never earlier
+	 * than either the old or the new deadline while the high half is
+	 * updated, and no spurious interrupt fires before the low half is
+	 * written last. */
+	csr_write(CSR_STIMECMP, (uint32_t)-1);
+	csr_write(CSR_STIMECMPH, (uint32_t)(ticks >> 32));
+	csr_write(CSR_STIMECMP, (uint32_t)ticks);
+}
+#endif
+
 void set_timer(ticks_t ticks)
 {
-	sbi_set_timer(ticks);
+	/* skip trapping to M-mode when possible */
+	if (has_sstc)
+		__set_stimecmp(ticks);
+	else
+		sbi_set_timer(ticks);
 }
 
 /**
@@ -156,6 +156,22 @@ stat_t stat_vpage(struct vmem *branch, vm_t vaddr, pm_t *paddr,
 	return ERR_NF;
 }
 
+/** Number of page table pages currently allocated. */
+static size_t num_tables = 0;
+
+/** Bytes currently allocated for rpc stacks. */
+static size_t rpc_bytes = 0;
+
+size_t page_tables()
+{
+	return num_tables;
+}
+
+size_t rpc_stack_usage()
+{
+	return rpc_bytes;
+}
+
 /**
  * Create virtual memory leaf page table.
  *
@@ -167,6 +183,7 @@ static struct vmem *__create_leaf()
 	if (!new_leaf)
 		return NULL;
 
+	num_tables++;
 	memset((void *)new_leaf, 0, sizeof(struct vmem));
 	return (struct vmem *)to_pte((pm_t)__pa(new_leaf), VM_V);
 }
@@ -187,6 +204,7 @@ static void __destroy_branch(struct vmem *b)
 	}
 
 	free_page(MM_KPAGE, (pm_t)b);
+	num_tables--;
 }
 
 /**
@@ -388,6 +406,7 @@ struct vmem *create_vmem()
 	if (!b)
 		return NULL;
 
+	num_tables++;
 	memset(b, 0, MM_KPAGE_SIZE);
 	populate_kvmem(b);
 	return b;
@@ -411,6 +430,7 @@ void destroy_vmem(struct vmem *b)
 	}
 
 	free_page(MM_KPAGE, (pm_t)b);
+	num_tables--;
 }
 
 void destroy_rpcmem(struct vmem *b)
@@ -425,6 +445,7 @@ void destroy_rpcmem(struct vmem *b)
 	}
 
 	free_page(MM_KPAGE, (pm_t)b);
+	num_tables--;
 }
 
 /**
@@ -465,6 +486,27 @@ stat_t populate_kvmem(struct vmem *b)
 	return OK;
 }
 
+#if defined(KDATA_ADDR)
+stat_t map_kdata(pm_t page)
+{
+	/* the kernel data page lives in the second 2MiB slot of kvmem, and as
+	 * every vmem points to kvmem we only have to map it once. Kernel only
+	 * writes to it through the direct mapping. */
+	struct vmem *l0 = (struct vmem *)alloc_page(BASE_PAGE);
+	if (!l0)
+		return ERR_OOMEM;
+
+	num_tables++;
+	memset(l0, 0, BASE_PAGE_SIZE);
+	l0->leaf[0] = (struct vmem *)to_pte((pm_t)__pa(page),
+	                                    VM_V | VM_R | VM_U | VM_A | VM_G);
+
+	kvmem.leaf[1] = (struct vmem *)to_pte((pm_t)__pa(l0), VM_V);
+	flush_tlb_all();
+	return OK;
+}
+#endif
+
 #if defined(DEBUG)
 vm_t setup_kernel_io(struct vmem *b, vm_t paddr)
 {
@@ -535,8 +577,10 @@ stat_t setup_rpc_stack(struct tcb *t)
 		return ERR_OOMEM;
 
 	t->arch.rpc_page = page;
+	rpc_bytes += order_size(MM_O1);
 
 	if (map_vpage(t->rpc.vmem, page, RPC_STACK_BASE, flags, BASE_PAGE)) {
+		rpc_bytes -= order_size(MM_O1);
 		free_page(MM_O1, page);
 		return ERR_OOMEM;
 	}
@@ -566,6 +610,7 @@ stat_t setup_rpc_stack(struct tcb *t)
 void destroy_rpc_stack(struct tcb *t)
 {
 	free_page(MM_O1, t->arch.rpc_page);
+	rpc_bytes -= order_size(MM_O1);
 }
 
 void reset_rpc_stack(struct tcb *t)
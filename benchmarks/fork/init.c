@@ -1,4 +1,4 @@
-#include <common/benchmark.h>
+#include <common/bench.h>
 
 START(pid, tid, d0, d1, d2, d3)
 {
@@ -9,10 +9,8 @@ START(pid, tid, d0, d1, d2, d3)
 	UNUSED(d2);
 	UNUSED(d3);
 
-	uint64_t timebase = sys_timebase();
-	uint64_t start = sys_ticks();
-
-	for (size_t i = 0; i < 1000; ++i) {
+	struct bench b;
+	BENCH(&b, "fork", 1000) {
 		id_t our_tid = 0;
 		id_t new_id = sys_fork(&our_tid);
 		if (new_id == 0) {
@@ -22,6 +20,5 @@ START(pid, tid, d0, d1, d2, d3)
 		sys_swap(new_id);
 	}
 
-	uint64_t end = sys_ticks();
-	report(start, end, timebase);
+	bench_report(&b);
 }
@@ -1,4 +1,4 @@
-#include <common/benchmark.h>
+#include <common/bench.h>
 
 START(pid, tid, d0, d1, d2, d3)
 {
@@ -9,15 +9,12 @@ START(pid, tid, d0, d1, d2, d3)
 	UNUSED(d3);
 
 	if (pid == 0) {
-		uint64_t timebase = sys_timebase();
-		uint64_t start = sys_ticks();
-
-		for (size_t i = 0; i < 1000; ++i) {
+		struct bench b;
+		BENCH(&b, "ipc-req", 1000) {
 			sys_ipc_req0(1);
 		}
 
-		uint64_t end = sys_ticks();
-		report(start, end, timebase);
+		bench_report(&b);
 	}
 	else if (pid == 1) {
 		sys_ipc_resp0();
@@ -0,0 +1,40 @@
+#include <common/bench.h>
+
+static volatile id_t remote = 0;
+static volatile size_t fired = 0;
+
+START(pid, tid, d0, d1, d2, d3)
+{
+	UNUSED(pid);
+	UNUSED(d1);
+	UNUSED(d2);
+	UNUSED(d3);
+
+	if (d0 == SYS_USER_NOTIFY) {
+		fired++;
+		sys_ipc_resp0();
+	}
+
+	/* the thread on the second core just waits around to be notified,
+	 * which has to go through an IPI since it's running */
+	if (tid != 1) {
+		remote = tid;
+		while (1)
+			;
+	}
+
+	while (!remote)
+		;
+
+	/* each iteration is one IPI to the other core plus the notification
+	 * handler running there */
+	struct bench b;
+	BENCH(&b, "ipi-latency", 1000) {
+		size_t expect = fired + 1;
+		sys_ipc_notify(remote, 0);
+		while (fired != expect)
+			;
+	}
+
+	bench_report(&b);
+}
@@ -0,0 +1 @@
+DO != ./scripts/gen-benchmark -n ipi-latency -p init -q "-smp 2"
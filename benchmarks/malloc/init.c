@@ -1,4 +1,4 @@
-#include <common/benchmark.h>
+#include <common/bench.h>
 
 START(pid, tid, d0, d1, d2, d3)
 {
@@ -9,14 +9,11 @@ START(pid, tid, d0, d1, d2, d3)
 	UNUSED(d2);
 	UNUSED(d3);
 
-	uint64_t timebase = sys_timebase();
-	uint64_t start = sys_ticks();
-
-	for (size_t i = 0; i < 1000; ++i) {
+	struct bench b;
+	BENCH(&b, "malloc", 1000) {
 		void *p = sys_req_mem(1, VM_R | VM_W);
 		sys_free_mem((uintptr_t)p);
 	}
 
-	uint64_t end = sys_ticks();
-	report(start, end, timebase);
+	bench_report(&b);
 }
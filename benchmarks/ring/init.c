@@ -0,0 +1,55 @@
+#include <common/bench.h>
+
+#define RING_SIZE 64
+
+/* ring enters per round for each batch size */
+#define ITERS 100
+
+struct ring {
+	struct sys_ring h;
+	struct sys_sqe sq[RING_SIZE];
+	struct sys_cqe cq[RING_SIZE];
+};
+
+static struct ring ring = {.h = {.size = RING_SIZE}};
+
+/* one name per batch size, 1 to RING_SIZE */
+static const char *names[] = {
+	"ring-1", "ring-2", "ring-4", "ring-8", "ring-16", "ring-32", "ring-64",
+};
+
+#define SIZES (sizeof(names) / sizeof(names[0]))
+
+START(pid, tid, d0, d1, d2, d3)
+{
+	UNUSED(pid);
+	UNUSED(tid);
+	UNUSED(d0);
+	UNUSED(d1);
+	UNUSED(d2);
+	UNUSED(d3);
+
+	/* each iteration is one enter with a full batch, so batch size 1 is
+	 * roughly the cost of one trap per syscall and dividing by the batch
+	 * size shows how much of that larger batches amortize */
+	struct bench b;
+	for (size_t n = 0; n < SIZES; ++n) {
+		size_t batch = 1UL << n;
+		BENCH(&b, names[n], ITERS) {
+			for (size_t j = 0; j < batch; ++j) {
+				size_t idx = ring.h.sq_tail++ & (RING_SIZE - 1);
+				struct sys_sqe *e = &ring.sq[idx];
+				*e = (struct sys_sqe){.op = SYS_TICKS, .user = j};
+			}
+
+			sys_ring_enter(&ring.h, batch, NULL);
+			ring.h.cq_head = ring.h.cq_tail;
+		}
+
+		/* the last one also prints the total for make benchmark */
+		if (n + 1 < SIZES)
+			bench_print(&b);
+	}
+
+	bench_report(&b);
+}
@@ -0,0 +1 @@
+DO != ./scripts/gen-benchmark -n ring -p init
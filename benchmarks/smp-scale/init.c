@@ -0,0 +1,174 @@
+#include <common/benchmark.h>
+#include <common/kdata.h>
+
+/* each init thread is one worker, and core_bringup() gives us one init thread
+ * per hart. Every operation is run with 1, 2, 4, ... harts busy, and since
+ * everything in the kernel runs under one big lock, whatever doesn't scale
+ * shows up as efficiency dropping below 100%.
+ *
+ * Note that with -icount qemu runs all harts round robin on one host thread,
+ * so aggregate throughput mostly reflects how much work the kernel does per
+ * operation, including spinning on the lock, not actual parallelism. */
+
+#define ITERS 100
+
+/* seconds to wait for all harts to show up before giving up */
+#define BRINGUP_TIMEOUT 10
+
+static volatile size_t arrived = 0;
+static volatile size_t generation = 0;
+static volatile size_t active = 0;
+static volatile size_t op = 0;
+static volatile size_t done = 0;
+
+enum {
+	OP_IPC,
+	OP_MEM,
+	OP_TIMER,
+	OP_FORK,
+	OP_CREATE,
+	OPS
+};
+
+static const char *names[OPS] = {
+	"ipc",
+	"mem",
+	"timer",
+	"fork",
+	"create",
+};
+
+void callback()
+{
+	sys_exit(1);
+}
+
+static void run_op(size_t o)
+{
+	for (size_t i = 0; i < ITERS; ++i) {
+		switch (o) {
+		case OP_IPC:
+			sys_ipc_req0(1);
+			break;
+
+		case OP_MEM: {
+			void *p = sys_req_mem(1, VM_R | VM_W);
+			sys_free_mem((uintptr_t)p);
+			break;
+		}
+
+		case OP_TIMER: {
+			/* far enough out that it never fires */
+			id_t cid = sys_req_rel_timer(kdata_timebase() * 60, 0);
+			sys_free_timer(cid);
+			break;
+		}
+
+		case OP_FORK: {
+			id_t our_tid = 0;
+			id_t new_id = sys_fork(&our_tid);
+			if (new_id == 0)
+				sys_exit(1);
+
+			sys_swap(new_id);
+			break;
+		}
+
+		case OP_CREATE: {
+			id_t new_id = sys_create((uintptr_t)callback, 0, 0, 0, 0);
+			sys_swap(new_id);
+			break;
+		}
+		}
+	}
+}
+
+static void worker(size_t idx)
+{
+	size_t seen = 0;
+	while (1) {
+		while (generation == seen)
+			;
+
+		seen = generation;
+		if (idx < active) {
+			run_op(op);
+			__atomic_fetch_add(&done, 1, __ATOMIC_RELEASE);
+		}
+	}
+}
+
+START(pid, tid, d0, d1, d2, d3)
+{
+	UNUSED(d1);
+	UNUSED(d2);
+	UNUSED(d3);
+
+	/* ipc request to ourselves, or some notification we don't care
+	 * about */
+	if (pid != 0 || d0 != SYS_USER_SPAWNED) {
+		sys_ipc_resp0();
+		return;
+	}
+
+	if (tid != 1)
+		worker(__atomic_add_fetch(&arrived, 1, __ATOMIC_ACQ_REL));
+
+	size_t harts = kdata()->cpus;
+	if (harts == 0)
+		harts = 1;
+
+	uint64_t timebase = sys_timebase();
+	uint64_t deadline = sys_ticks() + BRINGUP_TIMEOUT * timebase;
+	while (arrived != harts - 1) {
+		if (sys_ticks() < deadline)
+			continue;
+
+		/* no result line, so the run shows up as failed instead of
+		 * hanging until the runner kills it */
+		printf("smp-scale: only %zu of %zu harts came up\n",
+		       (size_t)arrived + 1, harts);
+		exit();
+	}
+
+	uint64_t total = 0;
+	for (size_t o = 0; o < OPS; ++o) {
+		uint64_t base = 0;
+		for (size_t n = 1; n <= harts; n *= 2) {
+			op = o;
+			active = n;
+			done = 0;
+
+			uint64_t start = sys_ticks();
+			__atomic_fetch_add(&generation, 1, __ATOMIC_RELEASE);
+
+			/* we're worker 0 */
+			run_op(o);
+			while (done != n - 1)
+				;
+
+			uint64_t end = sys_ticks();
+			uint64_t ticks = end - start;
+			total += ticks;
+
+			uint64_t ops = n * ITERS;
+			uint64_t tput = ticks ? ops * timebase / ticks : 0;
+			if (n == 1)
+				base = tput;
+
+			/* in percent of perfect linear scaling */
+			uint64_t eff = base ? tput * 100 / (n * base) : 0;
+			printf("{\"bench\":\"smp-%s-%zu\",\"harts\":%zu,"
+			       "\"ops\":%llu,\"ticks\":%llu,\"timebase\":%llu,"
+			       "\"ops_per_sec\":%llu,\"efficiency\":%llu}\n",
+			       names[o], n, n,
+			       (unsigned long long)ops,
+			       (unsigned long long)ticks,
+			       (unsigned long long)timebase,
+			       (unsigned long long)tput,
+			       (unsigned long long)eff);
+		}
+	}
+
+	report(0, total, timebase);
+}
@@ -0,0 +1 @@
+DO != ./scripts/gen-benchmark -n smp-scale -p init -q "-smp 8" -t 300s
@@ -1,4 +1,4 @@
-#include <common/benchmark.h>
+#include <common/bench.h>
 #include <common/cpio.h>
 
 void callback()
@@ -32,15 +32,12 @@ START(pid, tid, d0, d1, d2, d3)
 	uintptr_t spawn = (uintptr_t)(cp) + align_up(sizeof(struct cpio_header) + name_len, 4);
 	printf("found spawn at %lx\n", spawn);
 
-	uint64_t timebase = sys_timebase();
-	uint64_t start = sys_ticks();
-
-	for (size_t i = 0; i < 1000; ++i) {
+	struct bench b;
+	BENCH(&b, "spawn", 1000) {
 		id_t new_id = sys_spawn(spawn, 0);
 		sys_detach(new_id);
 		sys_swap(new_id);
 	}
 
-	uint64_t end = sys_ticks();
-	report(start, end, timebase);
+	bench_report(&b);
 }
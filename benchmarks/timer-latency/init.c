@@ -0,0 +1,29 @@
+#include <common/bench.h>
+
+static volatile size_t fired = 0;
+
+START(pid, tid, d0, d1, d2, d3)
+{
+	UNUSED(pid);
+	UNUSED(tid);
+	UNUSED(d1);
+	UNUSED(d2);
+	UNUSED(d3);
+
+	if (d0 == SYS_USER_NOTIFY) {
+		fired++;
+		sys_ipc_resp0();
+	}
+
+	/* arm a timer that's due practically immediately and wait for it to
+	 * fire, so each iteration is one arm plus one timer interrupt */
+	struct bench b;
+	BENCH(&b, "timer-latency", 1000) {
+		size_t expect = fired + 1;
+		sys_req_rel_timer(1, 0);
+		while (fired != expect)
+			;
+	}
+
+	bench_report(&b);
+}
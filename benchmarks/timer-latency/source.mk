@@ -0,0 +1 @@
+DO != ./scripts/gen-benchmark -n timer-latency -p init
@@ -0,0 +1,43 @@
+#include <common/bench.h>
+
+#define ITERS 1000
+
+/* every iteration of every round, warmup included, creates one timer */
+#define NUM_TIMERS ((BENCH_WARMUP + BENCH_ROUNDS) * ITERS)
+
+static id_t cids[NUM_TIMERS];
+
+START(pid, tid, d0, d1, d2, d3)
+{
+	UNUSED(pid);
+	UNUSED(tid);
+	UNUSED(d0);
+	UNUSED(d1);
+	UNUSED(d2);
+	UNUSED(d3);
+
+	uint64_t timebase = sys_timebase();
+
+	/* spread timers out over a minute so they end up on different wheel
+	 * levels, none of them should fire during the benchmark */
+	size_t n = 0;
+	struct bench b;
+	BENCH(&b, "timers-req", ITERS) {
+		uint64_t ticks = timebase * 60 + n * (timebase / 100);
+		cids[n++] = sys_req_rel_timer(ticks, 0);
+	}
+
+	bench_print(&b);
+
+	/* cancel in a different order than they were created in */
+	n = 0;
+	BENCH(&b, "timers-free", ITERS) {
+		size_t i = n < NUM_TIMERS / 2
+			? 2 * n : 2 * (n - NUM_TIMERS / 2) + 1;
+
+		sys_free_timer(cids[i]);
+		n++;
+	}
+
+	bench_report(&b);
+}
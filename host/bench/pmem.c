@@ -0,0 +1,102 @@
+#include <common/bench.h>
+#include <common/shim.h>
+#include <kmi/pmem.h>
+#include <kmi/sizes.h>
+
+#include <stdlib.h>
+
+/* physical page allocator, with an empty allocator, with every other base
+ * page in use and with a synthetic allocation trace */
+
+#define RAM SZ_256M
+#define LIVE 4096
+
+static pm_t pages[LIVE];
+static enum mm_order orders[LIVE];
+
+static void alloc_free()
+{
+	struct bench b;
+	BENCH(&b, "pmem-alloc-free", 10000) {
+		pm_t p = alloc_page(BASE_PAGE);
+		free_page(BASE_PAGE, p);
+	}
+
+	bench_report(&b);
+
+	BENCH(&b, "pmem-alloc-free-o1", 10000) {
+		pm_t p = alloc_page(MM_O1);
+		free_page(MM_O1, p);
+	}
+
+	bench_report(&b);
+}
+
+static void fragmented()
+{
+	/* fill a couple of large pages worth of base pages and free every
+	 * other one, so that no bitmap is completely free or full */
+	size_t n = order_size(MM_O1) / BASE_PAGE_SIZE * 4;
+	pm_t *all = calloc(n, sizeof(pm_t));
+	for (size_t i = 0; i < n; ++i)
+		all[i] = alloc_page(BASE_PAGE);
+
+	for (size_t i = 0; i < n; i += 2)
+		free_page(BASE_PAGE, all[i]);
+
+	struct bench b;
+	BENCH(&b, "pmem-fragmented", 10000) {
+		pm_t p = alloc_page(BASE_PAGE);
+		free_page(BASE_PAGE, p);
+	}
+
+	bench_report(&b);
+
+	for (size_t i = 1; i < n; i += 2)
+		free_page(BASE_PAGE, all[i]);
+
+	free(all);
+}
+
+static void trace()
+{
+	/* each step either frees a random live page or allocates a new one,
+	 * mostly base pages with the occasional large one, which is roughly
+	 * what a mix of page tables, stacks and user memory looks like */
+	uint64_t s = 0x5eed;
+	struct bench b;
+	BENCH(&b, "pmem-trace", 100000) {
+		size_t i = host_rand(&s) % LIVE;
+		if (pages[i]) {
+			free_page(orders[i], pages[i]);
+			pages[i] = 0;
+			continue;
+		}
+
+		orders[i] = host_rand(&s) % 64 ? BASE_PAGE : MM_O1;
+		pages[i] = alloc_page(orders[i]);
+	}
+
+	bench_report(&b);
+
+	for (size_t i = 0; i < LIVE; ++i) {
+		if (pages[i])
+			free_page(orders[i], pages[i]);
+	}
+}
+
+int main()
+{
+	host_init(RAM);
+	alloc_free();
+	fragmented();
+	trace();
+
+	if (query_used() != host_baseline()) {
+		fprintf(stderr, "leaked %zu bytes\n",
+		        query_used() - host_baseline());
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,98 @@
+#include <common/bench.h>
+#include <common/shim.h>
+#include <common/tree.h>
+#include <kmi/regions.h>
+#include <kmi/sizes.h>
+
+#include <stdlib.h>
+
+/* memory regions, i.e. what sys_req_mem() and sys_free_mem() spend most of
+ * their time in, without the page tables */
+
+#define LIVE 4096
+
+static vm_t regions[LIVE];
+
+static void init(struct mem_region_root *r)
+{
+	/* same as a fresh process */
+	if (init_region(r, UVMEM_START, UVMEM_END - UVMEM_START, SZ_64K)) {
+		fprintf(stderr, "failed initializing region\n");
+		exit(1);
+	}
+}
+
+static void alloc_free()
+{
+	struct mem_region_root r = { 0 };
+	init(&r);
+
+	struct bench b;
+	BENCH(&b, "regions-alloc-free", 10000) {
+		vm_t v = alloc_region(&r, BASE_PAGE_SIZE, NULL, VM_R | VM_W);
+		free_region(&r, v);
+	}
+
+	bench_report(&b);
+	destroy_region(&r);
+}
+
+static void churn()
+{
+	struct mem_region_root r = { 0 };
+	init(&r);
+
+	/* random sizes from a page up to a megabyte, freed in random order,
+	 * which leaves lots of holes of different sizes around */
+	uint64_t s = 0x5eed;
+	struct bench b;
+	BENCH(&b, "regions-churn", 100000) {
+		size_t i = host_rand(&s) % LIVE;
+		if (regions[i]) {
+			free_region(&r, regions[i]);
+			regions[i] = 0;
+			continue;
+		}
+
+		size_t size = BASE_PAGE_SIZE * (1 + host_rand(&s) % 256);
+		regions[i] = alloc_region(&r, size, NULL, VM_R | VM_W);
+	}
+
+	bench_report(&b);
+
+	printf("{\"bench\":\"regions-churn-depth\","
+	       "\"free_depth\":%zu,\"used_depth\":%zu}\n",
+	       tree_depth(sp_root(&r.free_regions)),
+	       tree_depth(sp_root(&r.used_regions)));
+
+	BENCH(&b, "regions-find", 100000) {
+		size_t i = host_rand(&s) % LIVE;
+		if (regions[i] && !find_used_region(&r, regions[i]))
+			abort();
+	}
+
+	bench_report(&b);
+
+	for (size_t i = 0; i < LIVE; ++i) {
+		if (regions[i])
+			free_region(&r, regions[i]);
+
+		regions[i] = 0;
+	}
+
+	destroy_region(&r);
+}
+
+int main()
+{
+	host_init(SZ_64M);
+	alloc_free();
+	churn();
+
+	if (mem_nodes()->used != 0) {
+		fprintf(stderr, "leaked %zu region nodes\n", mem_nodes()->used);
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,76 @@
+#include <common/bench.h>
+#include <common/shim.h>
+#include <common/tree.h>
+
+#include <stdlib.h>
+
+/* how deep sp_trees get with different insertion orders, and how long
+ * inserting and removing takes at that size. Regions are looked up by start
+ * address, which is sorted order whenever a process allocates memory
+ * front to back, so that's the interesting case. */
+
+#define NODES 100000
+
+static struct item items[NODES];
+
+static void fill(const char *order, uint64_t seed)
+{
+	for (size_t i = 0; i < NODES; ++i) {
+		uint64_t key = i;
+		if (seed)
+			key = host_rand(&seed);
+
+		items[i].key = key;
+	}
+
+	struct sp_root r = { 0 };
+	struct bench b;
+	char name[64];
+	snprintf(name, sizeof(name), "sp-tree-insert-%s", order);
+
+	/* each round builds the whole tree again */
+	size_t n = 0;
+	BENCH(&b, name, NODES) {
+		if (n == NODES) {
+			r = (struct sp_root){ 0 };
+			n = 0;
+		}
+
+		tree_insert(&r, &items[n++]);
+	}
+
+	bench_report(&b);
+
+	size_t depth = tree_depth(sp_root(&r));
+	size_t paths = tree_path_sum(sp_root(&r), 1);
+	printf("{\"bench\":\"sp-tree-depth-%s\",\"nodes\":%d,"
+	       "\"depth\":%zu,\"avg_depth_x100\":%zu}\n",
+	       order, NODES, depth, paths * 100 / NODES);
+
+	snprintf(name, sizeof(name), "sp-tree-find-%s", order);
+	uint64_t s = 1;
+	BENCH(&b, name, NODES) {
+		struct item *i = &items[host_rand(&s) % NODES];
+		if (tree_find(&r, i->key) == NULL)
+			abort();
+	}
+
+	bench_report(&b);
+
+	/* remove and insert random nodes, tree stays the same size */
+	snprintf(name, sizeof(name), "sp-tree-replace-%s", order);
+	BENCH(&b, name, NODES) {
+		struct item *i = &items[host_rand(&s) % NODES];
+		tree_remove(&r, i);
+		tree_insert(&r, i);
+	}
+
+	bench_report(&b);
+}
+
+int main()
+{
+	fill("sorted", 0);
+	fill("random", 0x5eed);
+	return 0;
+}
@@ -0,0 +1,173 @@
+#ifndef KMI_HOST_BENCH_H
+#define KMI_HOST_BENCH_H
+
+#include <kmi/types.h>
+
+#include <stdio.h>
+#include <time.h>
+
+/*
+ * Host version of tests/common/bench.h, same BENCH() loop and same JSON
+ * output so ../benchmarks/scripts/compare-reports works on host reports as
+ * well. Time is in nanoseconds, so the timebase is always 10^9.
+ *
+ *	struct bench b;
+ *	BENCH(&b, "pmem-alloc", 10000) {
+ *		pm_t p = alloc_page(BASE_PAGE);
+ *		free_page(BASE_PAGE, p);
+ *	}
+ *	bench_report(&b);
+ */
+
+#ifndef BENCH_ROUNDS
+#define BENCH_ROUNDS 5
+#endif
+
+#ifndef BENCH_WARMUP
+#define BENCH_WARMUP 1
+#endif
+
+#define BENCH_SUB_BITS 3
+#define BENCH_SUB (1 << BENCH_SUB_BITS)
+#define BENCH_BUCKETS ((64 - BENCH_SUB_BITS + 1) * BENCH_SUB)
+
+struct bench {
+	const char *name;
+	size_t iters;
+	size_t iter;
+	size_t round;
+
+	uint64_t overhead;
+	uint64_t prev;
+
+	uint64_t count;
+	uint64_t sum;
+	uint64_t min;
+	uint64_t max;
+	uint32_t hist[BENCH_BUCKETS];
+};
+
+static inline uint64_t bench_ns()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static inline size_t bench_bucket(uint64_t v)
+{
+	if (v < BENCH_SUB)
+		return v;
+
+	size_t e = 63 - __builtin_clzll(v);
+	size_t sub = (v >> (e - BENCH_SUB_BITS)) & (BENCH_SUB - 1);
+	return (e - BENCH_SUB_BITS + 1) * BENCH_SUB + sub;
+}
+
+static inline uint64_t bench_bucket_max(size_t i)
+{
+	if (i < BENCH_SUB)
+		return i;
+
+	size_t e = i / BENCH_SUB + BENCH_SUB_BITS - 1;
+	uint64_t sub = i % BENCH_SUB;
+	uint64_t lo = (BENCH_SUB + sub) << (e - BENCH_SUB_BITS);
+	return lo + (1ULL << (e - BENCH_SUB_BITS)) - 1;
+}
+
+static inline void bench_record(struct bench *b, uint64_t v)
+{
+	v = v > b->overhead ? v - b->overhead : 0;
+	if (v < b->min)
+		b->min = v;
+
+	if (v > b->max)
+		b->max = v;
+
+	b->sum += v;
+	b->count++;
+	b->hist[bench_bucket(v)]++;
+}
+
+static inline void bench_start(struct bench *b, const char *name, size_t iters)
+{
+	*b = (struct bench){
+		.name = name,
+		.iters = iters,
+		.min = (uint64_t)-1,
+	};
+
+	b->overhead = (uint64_t)-1;
+	for (size_t i = 0; i < 16; ++i) {
+		uint64_t start = bench_ns();
+		uint64_t end = bench_ns();
+		if (end - start < b->overhead)
+			b->overhead = end - start;
+	}
+
+	b->prev = bench_ns();
+}
+
+static inline bool bench_next(struct bench *b)
+{
+	uint64_t now = bench_ns();
+	if (b->iter != 0 && b->round >= BENCH_WARMUP)
+		bench_record(b, now - b->prev);
+
+	if (b->iter++ == b->iters) {
+		b->iter = 1;
+		b->round++;
+	}
+
+	if (b->round == BENCH_WARMUP + BENCH_ROUNDS)
+		return false;
+
+	b->prev = bench_ns();
+	return true;
+}
+
+#define BENCH(b, name, iters)\
+	for (bench_start(b, name, iters); bench_next(b);)
+
+static inline uint64_t bench_percentile(struct bench *b, unsigned p)
+{
+	uint64_t want = (b->count * p + 99) / 100;
+	uint64_t seen = 0;
+	for (size_t i = 0; i < BENCH_BUCKETS; ++i) {
+		seen += b->hist[i];
+		if (seen >= want && seen) {
+			uint64_t v = bench_bucket_max(i);
+			return v > b->max ? b->max : v;
+		}
+	}
+
+	return b->max;
+}
+
+static inline void bench_report(struct bench *b)
+{
+	if (!b->count) {
+		printf("{\"bench\":\"%s\",\"error\":\"no samples\"}\n", b->name);
+		return;
+	}
+
+	uint64_t mean = b->sum / b->count;
+	uint64_t ops = b->sum ? b->count * 1000000000 / b->sum : 0;
+
+	printf("{\"bench\":\"%s\",\"rounds\":%d,\"iters\":%llu,"
+	       "\"timebase\":1000000000,\"overhead\":%llu,"
+	       "\"min\":%llu,\"p50\":%llu,\"p90\":%llu,\"p99\":%llu,"
+	       "\"max\":%llu,\"mean\":%llu,\"ops_per_sec\":%llu}\n",
+	       b->name, BENCH_ROUNDS,
+	       (unsigned long long)b->iters,
+	       (unsigned long long)b->overhead,
+	       (unsigned long long)b->min,
+	       (unsigned long long)bench_percentile(b, 50),
+	       (unsigned long long)bench_percentile(b, 90),
+	       (unsigned long long)bench_percentile(b, 99),
+	       (unsigned long long)b->max,
+	       (unsigned long long)mean,
+	       (unsigned long long)ops);
+}
+
+#endif /* KMI_HOST_BENCH_H */
@@ -0,0 +1,111 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <dirent.h>
+
+/* stand-in for libFuzzer when building with something other than clang.
+ * Understands the same -runs, -seed and -max_total_time flags, runs every
+ * file or directory given on the command line once and then feeds the
+ * harness random inputs. Doesn't do any coverage guidance, so it's mostly a
+ * smoke test and a way to reproduce crashes libFuzzer found. */
+
+#define MAX_INPUT 4096
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+static void run_file(const char *path)
+{
+	static uint8_t buf[MAX_INPUT];
+	FILE *f = fopen(path, "rb");
+	if (!f) {
+		perror(path);
+		exit(1);
+	}
+
+	size_t n = fread(buf, 1, sizeof(buf), f);
+	fclose(f);
+	LLVMFuzzerTestOneInput(buf, n);
+}
+
+/* returns false if path isn't a directory */
+static bool run_dir(const char *path)
+{
+	DIR *d = opendir(path);
+	if (!d)
+		return false;
+
+	struct dirent *e;
+	while ((e = readdir(d))) {
+		if (e->d_name[0] == '.')
+			continue;
+
+		char file[4096];
+		snprintf(file, sizeof(file), "%s/%s", path, e->d_name);
+		run_file(file);
+	}
+
+	closedir(d);
+	return true;
+}
+
+static uint64_t rand64(uint64_t *s)
+{
+	uint64_t x = *s;
+	x ^= x << 13;
+	x ^= x >> 7;
+	x ^= x << 17;
+	return *s = x;
+}
+
+int main(int argc, char *argv[])
+{
+	long runs = -1;
+	long max_time = 0;
+	size_t inputs = 0;
+	uint64_t seed = time(NULL);
+
+	for (int i = 1; i < argc; ++i) {
+		const char *a = argv[i];
+		if (strncmp(a, "-runs=", 6) == 0)
+			runs = strtol(a + 6, NULL, 0);
+		else if (strncmp(a, "-seed=", 6) == 0)
+			seed = strtoull(a + 6, NULL, 0);
+		else if (strncmp(a, "-max_total_time=", 16) == 0)
+			max_time = strtol(a + 16, NULL, 0);
+		else if (a[0] == '-')
+			continue;
+		else if (!run_dir(a))
+			run_file(a);
+
+		if (a[0] != '-')
+			inputs++;
+	}
+
+	if (seed == 0)
+		seed = 1;
+
+	/* given inputs and no limits, just reproduce, otherwise run until
+	 * something breaks like libFuzzer */
+	if (inputs && runs < 0 && max_time == 0)
+		return 0;
+
+	printf("driver: seed %llu\n", (unsigned long long)seed);
+
+	static uint8_t buf[MAX_INPUT];
+	time_t end = time(NULL) + max_time;
+	for (long r = 0; runs < 0 || r < runs; ++r) {
+		if (max_time && time(NULL) >= end)
+			break;
+
+		size_t n = rand64(&seed) % MAX_INPUT;
+		for (size_t i = 0; i < n; ++i)
+			buf[i] = rand64(&seed);
+
+		LLVMFuzzerTestOneInput(buf, n);
+	}
+
+	return 0;
+}
@@ -0,0 +1,55 @@
+#ifndef KMI_HOST_FUZZ_H
+#define KMI_HOST_FUZZ_H
+
+#include <kmi/types.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+ * Fuzzers implement LLVMFuzzerTestOneInput() and treat the input as a list of
+ * operations to run against some kernel data structure, checking invariants
+ * as they go. Built with clang, they're linked against libFuzzer, otherwise
+ * against common/driver.c.
+ */
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+/* pull bytes out of the fuzzer input, zero once it runs out */
+struct input {
+	const uint8_t *data;
+	size_t left;
+};
+
+static inline bool input_left(struct input *in)
+{
+	return in->left != 0;
+}
+
+static inline uint8_t input_u8(struct input *in)
+{
+	if (!in->left)
+		return 0;
+
+	in->left--;
+	return *in->data++;
+}
+
+static inline uint32_t input_u32(struct input *in)
+{
+	uint32_t v = 0;
+	for (size_t i = 0; i < 4; ++i)
+		v = v << 8 | input_u8(in);
+
+	return v;
+}
+
+#define fuzz_check(x, ...)                              \
+	do {                                            \
+		if (!(x)) {                             \
+			fprintf(stderr, __VA_ARGS__);   \
+			abort();                        \
+		}                                       \
+	} while (0)
+
+#endif /* KMI_HOST_FUZZ_H */
@@ -0,0 +1,206 @@
+#include <kmi/regions.h>
+#include <kmi/initrd.h>
+#include <kmi/debug.h>
+#include <kmi/power.h>
+#include <kmi/timer.h>
+#include <kmi/pmem.h>
+#include <kmi/dmem.h>
+#include <kmi/tcb.h>
+#include <kmi/mem.h>
+#include <libfdt.h>
+
+#include <arch/vmem.h>
+#include <arch/tcb.h>
+
+#include "shim.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+
+static pm_t ram_base = 0;
+static size_t baseline = 0;
+
+void host_init(size_t ram_size)
+{
+	if (ram_base)
+		return;
+
+	/* fdt is unused on riscv64 */
+	init_mem(NULL);
+
+	/* align like RAM would be on real hardware, so larger pages end up
+	 * aligned as well */
+	size_t align = order_size(MM_O1);
+	void *ram = aligned_alloc(align, align_up(ram_size, align));
+	if (!ram) {
+		perror("aligned_alloc");
+		exit(1);
+	}
+
+	ram_base = (pm_t)ram;
+	set_ram_base(ram_base);
+	set_ram_size(ram_size);
+
+	/* the kernel places the pmem map in RAM and marks it used, here it
+	 * can just live outside of it */
+	size_t pmap_size = probe_pmap(0, ram_size, 0);
+	void *pmap = malloc(pmap_size);
+	if (!pmap) {
+		perror("malloc");
+		exit(1);
+	}
+
+	populate_pmap(ram_base, ram_size, (pm_t)pmap);
+	init_mem_nodes();
+	baseline = query_used();
+}
+
+pm_t host_ram_base()
+{
+	return ram_base;
+}
+
+size_t host_baseline()
+{
+	return baseline;
+}
+
+/* the kernel printf understands a subset of what the host one does, so just
+ * pass messages through */
+void dbg(const char *fmt, ...)
+{
+	va_list args;
+	va_start(args, fmt);
+	vfprintf(stderr, fmt, args);
+	va_end(args);
+}
+
+/* failed asserts end up here */
+stat_t poweroff(enum poweroff_type type)
+{
+	UNUSED(type);
+	abort();
+}
+
+/* not built for the host, only dump_mem() is interested */
+static struct node_root no_nodes = { 0 };
+
+struct node_root *timer_nodes()
+{
+	return &no_nodes;
+}
+
+size_t alive_tcbs()
+{
+	return 0;
+}
+
+size_t max_tcbs()
+{
+	return 0;
+}
+
+size_t page_tables()
+{
+	return 0;
+}
+
+size_t rpc_stack_usage()
+{
+	return 0;
+}
+
+/* only reachable from init_pmem() and the map_*_region() family, neither of
+ * which make sense without real hardware */
+static void __noreturn no_hardware(const char *name)
+{
+	fprintf(stderr, "%s isn't available on the host\n", name);
+	abort();
+}
+
+struct cell_info get_cellinfo(const void *fdt, const int offset)
+{
+	UNUSED(fdt);
+	UNUSED(offset);
+	no_hardware(__func__);
+}
+
+pm_t get_initrdbase(const void *fdt)
+{
+	UNUSED(fdt);
+	no_hardware(__func__);
+}
+
+size_t get_initrdsize(const void *fdt)
+{
+	UNUSED(fdt);
+	no_hardware(__func__);
+}
+
+stat_t init_devmem(pm_t ram_base, pm_t ram_top)
+{
+	UNUSED(ram_base);
+	UNUSED(ram_top);
+	no_hardware(__func__);
+}
+
+int fdt_path_offset(const void *fdt, const char *path)
+{
+	UNUSED(fdt);
+	UNUSED(path);
+	no_hardware(__func__);
+}
+
+const void *fdt_getprop(const void *fdt, int nodeoffset, const char *name,
+                        int *lenp)
+{
+	UNUSED(fdt);
+	UNUSED(nodeoffset);
+	UNUSED(name);
+	UNUSED(lenp);
+	no_hardware(__func__);
+}
+
+int fdt_first_subnode(const void *fdt, int offset)
+{
+	UNUSED(fdt);
+	UNUSED(offset);
+	no_hardware(__func__);
+}
+
+int fdt_next_subnode(const void *fdt, int offset)
+{
+	UNUSED(fdt);
+	UNUSED(offset);
+	no_hardware(__func__);
+}
+
+stat_t map_vpage(struct vmem *branch, pm_t paddr, vm_t vaddr, vmflags_t flags,
+                 enum mm_order order)
+{
+	UNUSED(branch);
+	UNUSED(paddr);
+	UNUSED(vaddr);
+	UNUSED(flags);
+	UNUSED(order);
+	no_hardware(__func__);
+}
+
+stat_t unmap_vpage(struct vmem *branch, vm_t vaddr)
+{
+	UNUSED(branch);
+	UNUSED(vaddr);
+	no_hardware(__func__);
+}
+
+stat_t stat_vpage(struct vmem *branch, vm_t vaddr, pm_t *paddr,
+                  enum mm_order *order, vmflags_t *flags)
+{
+	UNUSED(branch);
+	UNUSED(vaddr);
+	UNUSED(paddr);
+	UNUSED(order);
+	UNUSED(flags);
+	no_hardware(__func__);
+}
@@ -0,0 +1,36 @@
+#ifndef KMI_HOST_SHIM_H
+#define KMI_HOST_SHIM_H
+
+#include <kmi/types.h>
+
+/*
+ * Glue for running kernel data structures on the host. Physical memory is one
+ * big aligned allocation handed to the real pmem.c, so alloc_page() and
+ * everything built on top of it behave exactly like in the kernel, and
+ * anything only needed when booting on real hardware aborts if it's ever
+ * called.
+ */
+
+/* set up page orders, ram_size bytes of physical memory and memory region
+ * nodes. Only the first call does anything, fuzzers call this on every input
+ * and are expected to free everything they allocate. */
+void host_init(size_t ram_size);
+
+/* start of physical memory */
+pm_t host_ram_base();
+
+/* what query_used() returned right after host_init(), i.e. how much the
+ * kernel itself allocated while setting up */
+size_t host_baseline();
+
+/* xorshift64, deterministic so runs can be compared against each other */
+static inline uint64_t host_rand(uint64_t *s)
+{
+	uint64_t x = *s;
+	x ^= x << 13;
+	x ^= x >> 7;
+	x ^= x << 17;
+	return *s = x;
+}
+
+#endif /* KMI_HOST_SHIM_H */
@@ -0,0 +1,82 @@
+#ifndef KMI_HOST_TREE_H
+#define KMI_HOST_TREE_H
+
+#include <kmi/sp_tree.h>
+#include <kmi/utils.h>
+
+/* sp_trees only do the balancing, users walk down the tree themselves, so
+ * here's the same thing regions.c does for used regions, with plain integer
+ * keys */
+
+struct item {
+	struct sp_node sp_n;
+	uint64_t key;
+};
+
+#define item_container(n) container_of(n, struct item, sp_n)
+
+static inline void tree_insert(struct sp_root *r, struct item *i)
+{
+	struct sp_node *n = sp_root(r), *p = NULL;
+	enum sp_dir d = SP_LEFT;
+
+	i->sp_n = (struct sp_node){ 0 };
+
+	while (n) {
+		p = n;
+		if (i->key < item_container(n)->key) {
+			n = sp_left(n);
+			d = SP_LEFT;
+		}
+		else {
+			n = sp_right(n);
+			d = SP_RIGHT;
+		}
+	}
+
+	sp_insert(&sp_root(r), p, &i->sp_n, d);
+}
+
+static inline struct item *tree_find(struct sp_root *r, uint64_t key)
+{
+	struct sp_node *n = sp_root(r);
+	while (n) {
+		struct item *i = item_container(n);
+		if (key == i->key)
+			return i;
+
+		n = key < i->key ? sp_left(n) : sp_right(n);
+	}
+
+	return NULL;
+}
+
+static inline void tree_remove(struct sp_root *r, struct item *i)
+{
+	sp_remove(&sp_root(r), &i->sp_n);
+}
+
+/* height of tree, a single node is 1 */
+static inline size_t tree_depth(struct sp_node *n)
+{
+	if (!n)
+		return 0;
+
+	size_t l = tree_depth(sp_left(n));
+	size_t r = tree_depth(sp_right(n));
+	return 1 + (l > r ? l : r);
+}
+
+/* sum of the depths of all nodes, divide by number of nodes to get the
+ * average number of steps a lookup takes */
+static inline size_t tree_path_sum(struct sp_node *n, size_t depth)
+{
+	if (!n)
+		return 0;
+
+	return depth
+	       + tree_path_sum(sp_left(n), depth + 1)
+	       + tree_path_sum(sp_right(n), depth + 1);
+}
+
+#endif /* KMI_HOST_TREE_H */
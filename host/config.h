@@ -0,0 +1,13 @@
+#ifndef KMI_HOST_CONFIG_H
+#define KMI_HOST_CONFIG_H
+
+/* included after the regular config.h and arch/riscv64/config.h when building
+ * kernel sources for the host. Kernel headers are parsed as if we were
+ * riscv64, which works out since the host is assumed to be some LP64 system
+ * as well, but physical memory is whatever common/shim.c gets from
+ * aligned_alloc(), so the direct map has to be an identity map. */
+
+#undef VM_DMAP
+#define VM_DMAP 0
+
+#endif /* KMI_HOST_CONFIG_H */
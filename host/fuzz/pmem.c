@@ -0,0 +1,102 @@
+#include <common/shim.h>
+#include <common/fuzz.h>
+#include <kmi/pmem.h>
+#include <kmi/sizes.h>
+
+/* every byte either allocates a page into a slot or frees whatever is in it.
+ * Small RAM so that running out of memory happens too. Each page has its
+ * address written into its first and last word, which catches the allocator
+ * handing out overlapping pages. */
+
+#define SLOTS 64
+
+static pm_t pages[SLOTS];
+static enum mm_order orders[SLOTS];
+
+static void stamp(pm_t p, enum mm_order order)
+{
+	size_t words = order_size(order) / sizeof(pm_t);
+	((pm_t *)p)[0] = p;
+	((pm_t *)p)[words - 1] = p;
+}
+
+static bool stamped(pm_t p, enum mm_order order)
+{
+	size_t words = order_size(order) / sizeof(pm_t);
+	return ((pm_t *)p)[0] == p && ((pm_t *)p)[words - 1] == p;
+}
+
+static size_t used_bytes()
+{
+	size_t bytes = 0;
+	for (enum mm_order o = MM_O0; o <= max_order(); ++o)
+		bytes += query_used_pages(o) * order_size(o);
+
+	return bytes;
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+	host_init(SZ_8M);
+
+	static size_t largest = 0;
+	if (!largest)
+		largest = query_largest_free();
+
+	struct input in = { data, size };
+	while (input_left(&in)) {
+		uint8_t op = input_u8(&in);
+		size_t i = op % SLOTS;
+
+		if (pages[i]) {
+			fuzz_check(stamped(pages[i], orders[i]),
+			           "page %lx overwritten\n", pages[i]);
+
+			free_page(orders[i], pages[i]);
+			pages[i] = 0;
+			continue;
+		}
+
+		/* mostly base pages, the rest large pages and the occasional
+		 * order that doesn't fit in RAM at all */
+		enum mm_order order = BASE_PAGE;
+		if (op & 0x80)
+			order = (op & 0x40) ? max_order() : MM_O1;
+
+		pm_t p = alloc_page(order);
+		if (!p)
+			continue;
+
+		fuzz_check(is_aligned(p, order_size(order)),
+		           "page %lx of order %d misaligned\n", p, order);
+		fuzz_check(p >= host_ram_base()
+		           && p + order_size(order)
+		           <= host_ram_base() + SZ_8M,
+		           "page %lx outside RAM\n", p);
+
+		stamp(p, order);
+		pages[i] = p;
+		orders[i] = order;
+		fuzz_check(used_bytes() == query_used(),
+		           "page counts don't match bytes used\n");
+	}
+
+	for (size_t i = 0; i < SLOTS; ++i) {
+		if (!pages[i])
+			continue;
+
+		fuzz_check(stamped(pages[i], orders[i]),
+		           "page %lx overwritten\n", pages[i]);
+
+		free_page(orders[i], pages[i]);
+		pages[i] = 0;
+	}
+
+	/* everything should have merged back together */
+	fuzz_check(query_used() == host_baseline(),
+	           "leaked %zu bytes\n", query_used() - host_baseline());
+	fuzz_check(query_largest_free() == largest,
+	           "largest free page %zu, was %zu\n",
+	           query_largest_free(), largest);
+	return 0;
+}
@@ -0,0 +1,146 @@
+#include <common/shim.h>
+#include <common/fuzz.h>
+#include <kmi/syscalls.h>
+#include <kmi/regions.h>
+#include <kmi/sizes.h>
+
+/* allocate regions anywhere or at fixed addresses, and free them or random
+ * addresses, in a small arena so that it fills up and fixed allocations
+ * collide. Whatever the kernel hands out is checked against what we know is
+ * in use. */
+
+#define SLOTS 64
+#define ARENA_PAGES 1024
+#define RESERVED_PAGES 16
+
+struct slot {
+	vm_t start;
+	size_t size;
+};
+
+static struct slot slots[SLOTS];
+
+static bool overlaps(vm_t start, size_t size)
+{
+	for (size_t i = 0; i < SLOTS; ++i) {
+		struct slot *s = &slots[i];
+		if (!s->start)
+			continue;
+
+		if (start < s->start + s->size && s->start < start + size)
+			return true;
+	}
+
+	return false;
+}
+
+static void check_new(struct mem_region_root *r, vm_t start, size_t size)
+{
+	fuzz_check(is_aligned(start, BASE_PAGE_SIZE),
+	           "region %lx misaligned\n", start);
+	fuzz_check(start >= BASE_PAGE_SIZE
+	           && start + size <= BASE_PAGE_SIZE * (ARENA_PAGES + 1),
+	           "region %lx outside arena\n", start);
+	fuzz_check(!overlaps(start, size), "region %lx overlaps\n", start);
+
+	struct mem_region *m = find_used_region(r, start);
+	fuzz_check(m && __addr(m->start) == start
+	           && __addr(m->end) == start + size,
+	           "can't find region %lx\n", start);
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+	host_init(SZ_8M);
+
+	size_t nodes = mem_nodes()->used;
+	struct mem_region_root r = { 0 };
+	/* start one page in so that zero means an empty slot */
+	stat_t ret = init_region(&r, BASE_PAGE_SIZE,
+	                         BASE_PAGE_SIZE * ARENA_PAGES,
+	                         BASE_PAGE_SIZE * RESERVED_PAGES);
+	fuzz_check(ret == OK, "failed initializing region\n");
+
+	struct input in = { data, size };
+	while (input_left(&in)) {
+		uint8_t op = input_u8(&in);
+		struct slot *s = &slots[op % SLOTS];
+
+		if (s->start && (op & 0x80)) {
+			fuzz_check(free_region(&r, s->start) == OK,
+			           "failed freeing %lx\n", s->start);
+			fuzz_check(!find_used_region(&r, s->start),
+			           "region %lx still around\n", s->start);
+			s->start = 0;
+			continue;
+		}
+
+		if (s->start) {
+			/* something that isn't the start of a region, which
+			 * should fail without breaking anything */
+			vm_t v = BASE_PAGE_SIZE * (input_u8(&in) % ARENA_PAGES)
+			         + (input_u8(&in) & 1);
+			if (v == s->start || find_used_region(&r, v))
+				continue;
+
+			fuzz_check(free_region(&r, v) != OK,
+			           "freed %lx which wasn't allocated\n", v);
+			continue;
+		}
+
+		size_t bytes = BASE_PAGE_SIZE * (1 + input_u8(&in) % 64);
+		size_t actual = 0;
+		vm_t v = 0;
+		if (op & 0x40) {
+			vm_t want = BASE_PAGE_SIZE * (1 + input_u8(&in)
+			                              % ARENA_PAGES);
+			v = alloc_fixed_region(&r, want, bytes, &actual,
+			                       VM_R | VM_W);
+			fuzz_check(!v || v == want,
+			           "wanted region at %lx, got %lx\n", want, v);
+			fuzz_check(v || overlaps(want, bytes)
+			           || want + bytes
+			           > BASE_PAGE_SIZE * (ARENA_PAGES + 1),
+			           "couldn't get free region at %lx\n", want);
+		}
+		else {
+			v = alloc_region(&r, bytes, &actual, VM_R | VM_W);
+			fuzz_check(!v || v >= BASE_PAGE_SIZE * (RESERVED_PAGES + 1),
+			           "region %lx in reserved area\n", v);
+		}
+
+		if (!v)
+			continue;
+
+		fuzz_check(actual == bytes, "region %lx is %zu bytes, not %zu\n",
+		           v, actual, bytes);
+		check_new(&r, v, bytes);
+		s->start = v;
+		s->size = bytes;
+	}
+
+	for (size_t i = 0; i < SLOTS; ++i) {
+		if (!slots[i].start)
+			continue;
+
+		fuzz_check(free_region(&r, slots[i].start) == OK,
+		           "failed freeing %lx\n", slots[i].start);
+		slots[i].start = 0;
+	}
+
+	/* free regions should have coalesced back into the whole arena */
+	struct sp_node *root = sp_root(&r.free_regions);
+	fuzz_check(root && !sp_left(root) && !sp_right(root),
+	           "free regions didn't coalesce\n");
+
+	struct mem_region *m = mem_container(root);
+	fuzz_check(__addr(m->start) == BASE_PAGE_SIZE
+	           && __addr(m->end) == BASE_PAGE_SIZE * (ARENA_PAGES + 1),
+	           "arena is [%lx - %lx] after freeing everything\n",
+	           __addr(m->start), __addr(m->end));
+
+	destroy_region(&r);
+	fuzz_check(mem_nodes()->used == nodes, "leaked %zu region nodes\n",
+	           mem_nodes()->used - nodes);
+	return 0;
+}
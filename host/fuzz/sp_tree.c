@@ -0,0 +1,85 @@
+#include <common/fuzz.h>
+#include <common/tree.h>
+
+/* every four bytes either insert a node with that key or remove whichever
+ * node is in the slot it maps to, and then check that the tree is still a
+ * valid binary search tree */
+
+#define SLOTS 256
+
+static struct item items[SLOTS];
+static bool live[SLOTS];
+
+/* returns number of nodes, checks ordering and parent pointers */
+static size_t check_tree(struct sp_node *n, struct sp_node *parent,
+                         uint64_t lo, uint64_t hi)
+{
+	if (!n)
+		return 0;
+
+	uint64_t key = item_container(n)->key;
+	fuzz_check(sp_paren(n) == parent, "wrong parent for %llu\n",
+	           (unsigned long long)key);
+	fuzz_check(key >= lo && key <= hi, "%llu out of order\n",
+	           (unsigned long long)key);
+
+	/* equal keys go right in tree_insert(), but can end up on either side
+	 * after rotations */
+	size_t l = check_tree(sp_left(n), n, lo, key);
+	size_t r = check_tree(sp_right(n), n, key, hi);
+	return 1 + l + r;
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+	struct sp_root r = { 0 };
+	size_t count = 0;
+
+	struct input in = { data, size };
+	while (input_left(&in)) {
+		uint32_t v = input_u32(&in);
+		size_t i = v % SLOTS;
+
+		if (live[i]) {
+			tree_remove(&r, &items[i]);
+			live[i] = false;
+			count--;
+		}
+		else {
+			/* small keys so there are duplicates */
+			items[i].key = (v >> 8) % 1024;
+			tree_insert(&r, &items[i]);
+			live[i] = true;
+			count++;
+		}
+
+		struct sp_node *root = sp_root(&r);
+		fuzz_check(check_tree(root, NULL, 0, (uint64_t)-1) == count,
+		           "tree has wrong number of nodes\n");
+
+		if (!root)
+			continue;
+
+		uint64_t min = (uint64_t)-1, max = 0;
+		for (size_t j = 0; j < SLOTS; ++j) {
+			if (!live[j])
+				continue;
+
+			if (items[j].key < min)
+				min = items[j].key;
+
+			if (items[j].key > max)
+				max = items[j].key;
+		}
+
+		fuzz_check(item_container(sp_first(root))->key == min,
+		           "sp_first() isn't the smallest\n");
+		fuzz_check(item_container(sp_last(root))->key == max,
+		           "sp_last() isn't the largest\n");
+	}
+
+	for (size_t i = 0; i < SLOTS; ++i)
+		live[i] = false;
+
+	return 0;
+}
@@ -0,0 +1,143 @@
+#include <common/fuzz.h>
+
+#include <string.h>
+
+/* compare the kernel string functions against the host libc. They're built
+ * under their usual names and would be shadowed by libc (or the sanitizer
+ * runtime), so the Makefile renames them to kmi_*. Only functions the kernel
+ * actually calls are checked. Buffers are aligned, and lengths are often
+ * multiples of 64, so the fast paths get hit as well. */
+
+void *kmi_memcpy(void *restrict dst, const void *restrict src, size_t num);
+void *kmi_memset(void *ptr, int value, size_t num);
+void *kmi_memmove(void *dst, const void *src, size_t num);
+size_t kmi_strlen(const char *str);
+int kmi_strcmp(const char *str1, const char *str2);
+int kmi_strncmp(const char *str1, const char *str2, size_t num);
+char *kmi_strchr(const char *str, int chr);
+uintptr_t kmi_strtouintptr(const char *s);
+
+#define MAX 1024
+
+static _Alignas(64) char a[MAX + 1];
+static _Alignas(64) char b[MAX + 1];
+static _Alignas(64) char c[MAX + 1];
+
+static int sign(int x)
+{
+	return (x > 0) - (x < 0);
+}
+
+/* null terminated string from input, never longer than MAX */
+static size_t take_string(struct input *in, char *dst)
+{
+	size_t n = input_u8(in) % 64;
+	if (input_u8(in) & 1)
+		n *= 16;
+
+	size_t i = 0;
+	for (; i < n && i < MAX; ++i) {
+		dst[i] = input_u8(in);
+		if (!dst[i])
+			break;
+	}
+
+	dst[i] = 0;
+	return i;
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+	struct input in = { data, size };
+	while (input_left(&in)) {
+		uint8_t op = input_u8(&in);
+		size_t off = input_u8(&in) % 64;
+		size_t len = input_u8(&in);
+		if (op & 0x80)
+			len = (len % 16) * 64;
+
+		if (off + len > MAX)
+			len = MAX - off;
+
+		switch (op % 8) {
+		case 0:
+			/* memcpy, both aligned and unaligned */
+			for (size_t i = 0; i < MAX; ++i)
+				b[i] = input_u8(&in);
+
+			memset(a, 0x5a, MAX);
+			memset(c, 0x5a, MAX);
+			kmi_memcpy(a + off, b, len);
+			memcpy(c + off, b, len);
+			fuzz_check(memcmp(a, c, MAX) == 0,
+			           "memcpy(+%zu, %zu) differs\n", off, len);
+			break;
+
+		case 1: {
+			int v = input_u8(&in);
+			memset(a, 0x5a, MAX);
+			memset(c, 0x5a, MAX);
+			kmi_memset(a + off, v, len);
+			memset(c + off, v, len);
+			fuzz_check(memcmp(a, c, MAX) == 0,
+			           "memset(+%zu, %d, %zu) differs\n", off, v, len);
+			break;
+		}
+
+		case 2: {
+			/* overlapping in either direction */
+			size_t to = input_u8(&in) % 64;
+			if (to + len > MAX)
+				len = MAX - to;
+
+			for (size_t i = 0; i < MAX; ++i)
+				a[i] = c[i] = input_u8(&in);
+
+			kmi_memmove(a + to, a + off, len);
+			memmove(c + to, c + off, len);
+			fuzz_check(memcmp(a, c, MAX) == 0,
+			           "memmove(+%zu, +%zu, %zu) differs\n",
+			           to, off, len);
+			break;
+		}
+
+		case 3:
+			take_string(&in, a);
+			fuzz_check(kmi_strlen(a) == strlen(a),
+			           "strlen(\"%s\") differs\n", a);
+			break;
+
+		case 4:
+			take_string(&in, a);
+			take_string(&in, b);
+			fuzz_check(sign(kmi_strcmp(a, b)) == sign(strcmp(a, b)),
+			           "strcmp(\"%s\", \"%s\") differs\n", a, b);
+			break;
+
+		case 5:
+			take_string(&in, a);
+			take_string(&in, b);
+			fuzz_check(sign(kmi_strncmp(a, b, len))
+			           == sign(strncmp(a, b, len)),
+			           "strncmp(\"%s\", \"%s\", %zu) differs\n",
+			           a, b, len);
+			break;
+
+		case 6: {
+			take_string(&in, a);
+			int ch = input_u8(&in);
+			fuzz_check(kmi_strchr(a, ch) == strchr(a, ch),
+			           "strchr(\"%s\", %d) differs\n", a, ch);
+			break;
+		}
+
+		case 7:
+			/* just has to not read past the end */
+			take_string(&in, a);
+			kmi_strtouintptr(a);
+			break;
+		}
+	}
+
+	return 0;
+}
@@ -25,20 +25,35 @@ typedef uint_fast32_t irq_t;
 
 /**
  * Initialize arch-specific IRQ stuff.
+ * Called once on each core, the boot core passes in the FDT and finds the
+ * interrupt controller, other cores pass \c NULL and only set up their own
+ * state.
  *
- * @param fdt Global FDT pointer.
+ * @param fdt Global FDT pointer, or \c NULL on secondary cores.
  */
 void setup_irq(void *fdt);
 
 /**
- * Activate IRQ for \p id.
+ * Get number of IRQ IDs the interrupt controller supports.
+ * Valid IDs are below this, though not all of them are necessarily connected to
+ * anything.
+ *
+ * @return Number of IRQ IDs, \c 0 if there's no interrupt controller.
+ */
+size_t irq_sources();
+
+/**
+ * Activate IRQ for \p id and route it to core \p cpu.
+ * If \p id is already active, it is moved over to \p cpu.
  * Assumes there's one interrupt controller for the whole system, which might be
  * an oversimplification.
  *
- * @param id IRQ id to deactivate.
- * @return OK on success, non-zero otherwise.
+ * @param id IRQ id to activate.
+ * @param cpu CPU ID of core that should receive \p id.
+ * @return OK on success, \ref ERR_INVAL if \p id or \p cpu are out of range,
+ * \ref ERR_NOINIT if there's no interrupt controller.
  */
-stat_t activate_irq(irq_t id);
+stat_t activate_irq(irq_t id, id_t cpu);
 
 /**
  * Deactivates IRQ for \p id.
@@ -54,6 +69,13 @@ void enable_irqs();
 /** Disable IRQs. */
 void disable_irqs();
 
+/**
+ * Check if there are enabled IRQs waiting to be handled.
+ *
+ * @return \ref true if some IRQ is pending, \ref false otherwise.
+ */
+bool irqs_pending();
+
 /** Get IRQ to handle.
  *
  * @return ID of IRQ to handle.
@@ -62,4 +84,12 @@ void disable_irqs();
  */
 irq_t get_irq();
 
+/**
+ * Tell interrupt controller we're done with IRQ from \ref get_irq(), so it
+ * can be delivered again.
+ *
+ * @param id ID of IRQ to complete.
+ */
+void complete_irq(irq_t id);
+
 #endif /* KMI_ARCH_IRQ_H */
@@ -0,0 +1,67 @@
+/* SPDX-License-Identifier: copyleft-next-0.3.1 */
+/* Copyright 2024, Kim Kuparinen < kimi.h.kuparinen@gmail.com > */
+
+#ifndef KMI_ARCH_PMU_H
+#define KMI_ARCH_PMU_H
+
+/**
+ * @file pmu.h
+ * Arch-specific hardware performance counter handling, generally implemented
+ * in arch/whatever/pmu.c. Counters are per core, and all functions operate on
+ * the counters of the core they're called on.
+ */
+
+#include <kmi/syscalls.h>
+#include <kmi/types.h>
+
+/**
+ * Number of counters available.
+ *
+ * @return Number of counters, \c 0 if there's no way to access them.
+ */
+size_t pmu_counters();
+
+/**
+ * Get information about counter.
+ *
+ * @param idx Counter index, below \ref pmu_counters().
+ * @param csr Where to store CSR number of counter, \c 0 if the counter can't
+ * be read directly.
+ * @param width Where to store width of counter in bits.
+ * @return \ref OK on success, \ref ERR_INVAL if \p idx is invalid.
+ */
+stat_t pmu_counter_info(size_t idx, unsigned long *csr, size_t *width);
+
+/**
+ * Find free counter that can count event and start it from zero.
+ *
+ * @param event Event to count.
+ * @param idx Where to store index of counter.
+ * @return \ref OK on success, \ref ERR_NF if no free counter can count \p
+ * event, \ref ERR_NOINIT if there are no counters.
+ */
+stat_t pmu_start(enum sys_pmu_event event, size_t *idx);
+
+/**
+ * Stop counter and make it available for \ref pmu_start() again.
+ *
+ * @param idx Counter index.
+ */
+void pmu_stop(size_t idx);
+
+/**
+ * Read counter.
+ *
+ * @param idx Counter index.
+ * @return Current value of counter.
+ */
+uint64_t pmu_read(size_t idx);
+
+/**
+ * Set which counters userspace can read directly.
+ *
+ * @param mask Bit \c n allows reading counter with CSR number \c 0xc00 + \c n.
+ */
+void pmu_user(unsigned long mask);
+
+#endif /* KMI_ARCH_PMU_H */
@@ -94,6 +94,19 @@ void set_stack_fast(struct tcb *t, vm_t s);
  */
 vm_t get_stack(struct tcb *t);
 
+/**
+ * Walk frame pointer chain of thread in userspace.
+ * Only gives meaningful results if the code that was running keeps a frame
+ * pointer around, but bogus frame pointers are caught and just end the walk,
+ * as do frames outside RAM. Must be called with the big kernel lock held.
+ *
+ * @param t Thread whose saved registers to start from.
+ * @param frames Where to write return addresses, innermost first.
+ * @param max Maximum number of return addresses to write.
+ * @return Number of return addresses written.
+ */
+size_t get_backtrace(struct tcb *t, unsigned long long *frames, size_t max);
+
 /**
  * Copy registers from tcb save area to address \p p.
  * Intended to be used for copying thread state to rpc stack.
@@ -134,6 +147,15 @@ void adjust_ipi(struct tcb *t);
  */
 void adjust_syscall(struct tcb *t);
 
+/**
+ * Undo \ref adjust_syscall(), so that the syscall is executed again when we
+ * return to userspace. Caller is responsible for restoring the syscall
+ * arguments.
+ *
+ * @param t Thread to do modifications to.
+ */
+void restart_syscall(struct tcb *t);
+
 /**
  * Run \c init program.
  *
@@ -19,4 +19,11 @@
  */
 void smp_bringup(struct vmem *b, void *fdt);
 
+/**
+ * Number of cores found by \ref smp_bringup().
+ *
+ * @return Number of cores in system.
+ */
+size_t smp_cpus();
+
 #endif /* KMI_ARCH_SMP_H */
@@ -42,6 +42,9 @@ stat_t setup_rpc_stack(struct tcb *t);
  */
 void destroy_rpc_stack(struct tcb *t);
 
+/** @return Bytes of memory currently backing rpc stacks. */
+size_t rpc_stack_usage();
+
 /**
  * Copy over contents in rpc stack from \p t to \p c.
  *
@@ -22,6 +22,8 @@
 
 /**
  * Get hardware timer frequency.
+ * Also probes for whatever timer features the hardware might have, so must be
+ * called before \ref set_timer().
  *
  * @param fdt Global FDT pointer.
  * @return Hardware timer frequency, ticks/sec.
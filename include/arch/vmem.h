@@ -119,6 +119,19 @@ void flush_tlb_all();
  */
 stat_t populate_kvmem(struct vmem *b);
 
+#if defined(KDATA_ADDR)
+/**
+ * Map kernel data page read-only for userspace at \ref KDATA_ADDR in every
+ * virtual memory, present and future.
+ * Only available if the arch defines \ref KDATA_ADDR.
+ *
+ * @param page Kernel data page, one \ref BASE_PAGE.
+ * @return \ref OK when succesful, \ref ERR_OOMEM if we couldn't allocate page
+ * tables.
+ */
+stat_t map_kdata(pm_t page);
+#endif
+
 /**
  * Initialize arch virtual memory and return boot virtual memory.
  *
@@ -192,6 +205,9 @@ void destroy_rpcmem(struct vmem *b);
  */
 void clone_uvmem(struct vmem *r, struct vmem *b);
 
+/** @return Number of pages currently used for page tables. */
+size_t page_tables();
+
 /**
  * Jump into kernelspace from a physical address space.
  * Really only called by main() during boot so the parameters are kind of weird.
@@ -0,0 +1,45 @@
+/* SPDX-License-Identifier: copyleft-next-0.3.1 */
+/* Copyright 2024, Kim Kuparinen < kimi.h.kuparinen@gmail.com > */
+
+#ifndef KMI_ACCT_H
+#define KMI_ACCT_H
+
+/**
+ * @file acct.h
+ *
+ * Per-thread CPU time accounting. Each core remembers when it last crossed
+ * between user and kernel space, and whenever it crosses again the time in
+ * between is charged to the current thread.
+ *
+ * Kernel time is charged to whichever thread the kernel returns to, which
+ * after a thread switch is not necessarily the one that entered the kernel.
+ * Seems fair enough, since the switch is usually done on its behalf.
+ */
+
+#include <kmi/tcb.h>
+
+/**
+ * Charge time since last kernel exit to \p t as user or RPC time.
+ * Called on kernel entry, before taking the big kernel lock.
+ *
+ * @param t Thread that was running in userspace.
+ */
+void acct_enter(struct tcb *t);
+
+/**
+ * Charge time since last kernel entry to \p t as kernel time.
+ * Called right before returning to userspace.
+ *
+ * @param t Thread about to run in userspace.
+ */
+void acct_leave(struct tcb *t);
+
+/**
+ * Charge RPC time \p t has spent in its current process to that process.
+ * Must be called before \p t moves into another process.
+ *
+ * @param t Thread about to change its \ref tcb.pid.
+ */
+void acct_migrate(struct tcb *t);
+
+#endif /* KMI_ACCT_H */
@@ -15,6 +15,7 @@
 #include <kmi/attrs.h>
 #include <kmi/pmem.h>
 #include <arch/vmem.h>
+#include <arch/irq.h>
 
 /** @name Internal. */
 /** @{ */
@@ -360,6 +361,66 @@ void setup_io_dbg(struct vmem *vmem);
  */
 vm_t map_io_dbg(struct vmem *vmem);
 
+/**
+ * Get interrupt of serial device.
+ *
+ * @return Interrupt ID, \c 0 if serial device doesn't have one.
+ */
+irq_t dbg_irq();
+
+/**
+ * Switch to buffered output.
+ * Called once \ref dbg_irq() has been activated. After this, output is written
+ * into a buffer that is drained from the serial device's transmit interrupt,
+ * so printing doesn't have to wait for the serial lines.
+ */
+void enable_dbg_irq();
+
+/**
+ * Handle serial device interrupt.
+ * Writes out more of the buffer.
+ */
+void handle_dbg_irq();
+
+/**
+ * Write out everything buffered, including messages deferred on any core, and
+ * go back to synchronous output.
+ * Called before powering off.
+ */
+void dbg_sync();
+
+/**
+ * Like \ref dbg_sync(), but doesn't wait for other cores to finish printing.
+ * Never touches the print lock, all output afterwards goes straight to the
+ * serial device. Called when panicking.
+ */
+void dbg_panic();
+
+#if defined(DEFERRED_LOG)
+/**
+ * Start deferring messages on current core.
+ * With deferred logging, \ref dbg() only stores the format string and raw
+ * arguments in a per-core buffer and the actual formatting and printing
+ * happens later in \ref dbg_flush(). Since messages are formatted later, any
+ * strings printed with "%s" must still be around by then, which string
+ * literals always are.
+ *
+ * Each core should call this once it has a thread assigned to it, and messages
+ * are deferred once all cores have done so.
+ */
+void dbg_defer();
+
+/**
+ * Print out messages deferred on current core.
+ * Called on the way back to userspace and from timer interrupts, outside the
+ * big kernel lock, as well as when the core has nothing better to do.
+ */
+void dbg_flush();
+#else
+#define dbg_defer(...)
+#define dbg_flush(...)
+#endif /* DEFERRED_LOG */
+
 /** @name Internal. */
 /** @{ */
 
@@ -419,6 +480,15 @@ vm_t map_io_dbg(struct vmem *vmem);
 #define setup_io_dbg(...)
 #define map_io_dbg(...)
 
+#define dbg_defer(...)
+#define dbg_flush(...)
+
+#define dbg_irq(...) 0
+#define enable_dbg_irq(...)
+#define handle_dbg_irq(...)
+#define dbg_sync(...)
+#define dbg_panic(...)
+
 #define bug(...)
 #define warn(...)
 #define info(...)
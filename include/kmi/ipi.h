@@ -14,13 +14,26 @@
 #include <kmi/uapi.h>
 #include <kmi/tcb.h>
 
+/** Initialize per-CPU IPI queues. */
+void init_ipis();
+
 /**
  * Send IPI to \p t. Assumes \c running(t).
+ * Sends to the same CPU are coalesced until it handles them.
  *
  * @param t \ref tcb to send IPI to.
  */
 void send_ipi(struct tcb *t);
 
+/**
+ * Clear software interrupt that was only sent to get \p t out of \ref idle(),
+ * for example when waking it up from \ref SYS_WAIT. IPIs sent through \ref
+ * send_ipi() are left pending.
+ *
+ * @param t Current thread.
+ */
+void clear_ipi(struct tcb *t);
+
 /**
  * Remove thread from IPI queue if it is on it.
  * @param t Thread to unqueue.
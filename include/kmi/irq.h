@@ -40,4 +40,15 @@ stat_t register_irq(struct tcb *t, irq_t id);
  */
 stat_t unregister_irq(struct tcb *t, irq_t id);
 
+/**
+ * Route IRQ registered to thread \p t to core \p cpu.
+ *
+ * @param t Thread that has registered \p id.
+ * @param id IRQ id to route.
+ * @param cpu CPU ID of core that should receive \p id.
+ * @return \ref OK on success, \ref ERR_PERM if \p id isn't registered to \p t,
+ * \ref ERR_INVAL if \p id or \p cpu are out of range.
+ */
+stat_t set_irq_affinity(struct tcb *t, irq_t id, id_t cpu);
+
 #endif /* KMI_IRQ_H */
@@ -0,0 +1,54 @@
+/* SPDX-License-Identifier: copyleft-next-0.3.1 */
+/* Copyright 2024, Kim Kuparinen < kimi.h.kuparinen@gmail.com > */
+
+#ifndef KMI_KDATA_H
+#define KMI_KDATA_H
+
+/**
+ * @file kdata.h
+ *
+ * Kernel data page, a read-only page mapped into every process so they can
+ * check up on commonly needed kernel values without going through a syscall.
+ * See \ref sys_kdata for the layout.
+ */
+
+#include <kmi/syscalls.h>
+#include <kmi/types.h>
+
+/**
+ * Allocate kernel data page, fill it in and map it into all address spaces.
+ * Should be called after thread control blocks are initialized. Does nothing
+ * if the arch doesn't define \ref KDATA_ADDR.
+ *
+ * @return \ref OK when succesful, \ref ERR_OOMEM otherwise.
+ */
+stat_t init_kdata();
+
+/**
+ * Set number of cores reported in kernel data page.
+ *
+ * @param cpus Number of cores.
+ */
+void kdata_set_cpus(size_t cpus);
+
+/**
+ * Refresh the values in kernel data page that change at runtime, i.e. ticks,
+ * RAM usage and stack sizes. Does nothing if only ticks would change.
+ */
+void update_kdata();
+
+/**
+ * Refresh the values in kernel data page that change at runtime, including
+ * ticks. Meant to be called once per timer interrupt.
+ */
+void tick_kdata();
+
+/**
+ * Get counters of current core.
+ *
+ * @return Counters of current core, or a dummy if the kernel data page isn't
+ * set up yet.
+ */
+struct sys_kdata_cpu *kdata_cpu();
+
+#endif /* KMI_KDATA_H */
@@ -92,7 +92,7 @@ static inline void __list_link(struct list_head *prev, struct list_head *next)
  */
 static inline void __list_del_entry(struct list_head *entry)
 {
-	__list_link(entry->next, entry->prev);
+	__list_link(entry->prev, entry->next);
 }
 
 /**
@@ -58,6 +58,12 @@ struct node_root {
 
 	/** List of node regions with free slots. */
 	struct node_region *av_head;
+
+	/** Number of nodes in use. */
+	size_t used;
+
+	/** Number of node regions, each one base page. */
+	size_t regions;
 };
 
 /**
@@ -42,6 +42,34 @@ pm_t alloc_page(enum mm_order order);
 /** @return How many bytes of memory are currently in use. */
 size_t query_used();
 
+/**
+ * Get number of pages of order currently in use. Larger pages that have been
+ * split up to hand out smaller ones don't count.
+ *
+ * @param order Order of pages to count.
+ * @return Number of pages, \c 0 if \p order is invalid.
+ */
+size_t query_used_pages(enum mm_order order);
+
+/**
+ * Get number of free pages of order that can be handed out without splitting
+ * a larger page. Walks the freelist, so not particularly fast.
+ *
+ * @param order Order of pages to count.
+ * @return Number of pages, \c 0 if \p order is invalid.
+ */
+size_t query_free_pages(enum mm_order order);
+
+/** @return Size of largest page that can currently be allocated, \c 0 if
+ * memory is full. */
+size_t query_largest_free();
+
+/**
+ * Print physical memory usage, fragmentation and what the kernel is using
+ * memory for to the serial lines. Noop if \c DEBUG isn't defined.
+ */
+void dump_mem();
+
 /**
  * Populate physical RAM usage map.
  * In theory we could easily implement NUMA nodes by just using different orders
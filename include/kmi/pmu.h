@@ -0,0 +1,70 @@
+/* SPDX-License-Identifier: copyleft-next-0.3.1 */
+/* Copyright 2024, Kim Kuparinen < kimi.h.kuparinen@gmail.com > */
+
+#ifndef KMI_PMU_H
+#define KMI_PMU_H
+
+/**
+ * @file pmu.h
+ *
+ * Per-thread hardware performance counters, see \ref SYS_PMU. A privileged
+ * process programs up to \ref PMU_SLOTS events, which every core starts
+ * counting the next time it switches threads. Counters keep running on each
+ * core, and \ref pmu_switch() charges whatever they counted since the last
+ * switch to the thread that was running, so each thread only sees the events
+ * it caused itself.
+ */
+
+#include <kmi/syscalls.h>
+#include <kmi/types.h>
+#include <kmi/tcb.h>
+
+/**
+ * Charge events counted on current core to thread that's switched out.
+ * Called from \ref use_tcb(). Also brings the counters of the current core up
+ * to date with what's been programmed.
+ *
+ * @param prev Thread that was running.
+ */
+void pmu_switch(struct tcb *prev);
+
+/**
+ * Start counting event in slot on all cores.
+ * Takes effect on the current core immediately, other cores follow the next
+ * time they switch threads.
+ *
+ * @param slot Slot to program.
+ * @param event Event to count.
+ * @param idx Where to store index of counter on the current core.
+ * @return \ref OK on success, \ref ERR_INVAL if \p slot or \p event is
+ * invalid, otherwise whatever \ref pmu_start() returned for the current core.
+ */
+stat_t pmu_config(size_t slot, enum sys_pmu_event event, size_t *idx);
+
+/**
+ * Stop counting in slot on all cores.
+ *
+ * @param slot Slot to stop.
+ * @return \ref OK on success, \ref ERR_INVAL if \p slot is invalid.
+ */
+stat_t pmu_release(size_t slot);
+
+/**
+ * Get how many events current thread has caused in slot.
+ *
+ * @param t Current thread.
+ * @param slot Slot to read.
+ * @param count Where to store count.
+ * @return \ref OK on success, \ref ERR_INVAL if \p slot is invalid, \ref
+ * ERR_NF if nothing is being counted in \p slot.
+ */
+stat_t pmu_count(struct tcb *t, size_t slot, unsigned long long *count);
+
+/**
+ * Set which counters userspace can read directly on all cores.
+ *
+ * @param mask Mask of counters, see \ref pmu_user().
+ */
+void pmu_set_user(unsigned long mask);
+
+#endif /* KMI_PMU_H */
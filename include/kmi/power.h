@@ -31,4 +31,12 @@ stat_t poweroff(enum poweroff_type type);
  */
 stat_t sleep();
 
+/**
+ * Idle the current core until some interrupt is pending.
+ * Unlike \ref sleep(), the core keeps running afterwards. Note that the
+ * interrupt isn't actually taken, use \ref irqs_pending() to check what woke
+ * us up.
+ */
+void idle();
+
 #endif
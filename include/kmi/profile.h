@@ -0,0 +1,241 @@
+/* SPDX-License-Identifier: copyleft-next-0.3.1 */
+/* Copyright 2024, Kim Kuparinen < kimi.h.kuparinen@gmail.com > */
+
+#ifndef KMI_PROFILE_H
+#define KMI_PROFILE_H
+
+/**
+ * @file profile.h
+ *
+ * Sampling profiler. Each core programs its timer to go off every \c period
+ * ticks, and whatever was running at that point is written into a per-core
+ * ring buffer as a \ref sys_profile_rec, which userspace drains through \ref
+ * SYS_PROFILE.
+ *
+ * The kernel doesn't take interrupts, so a sample that comes due while a core
+ * is in the kernel would be taken only once we return to userspace and be
+ * charged to the wrong place. Instead, \ref profile_leave() checks for due
+ * samples on the way out of the kernel, and charges them to whatever the
+ * kernel was doing, i.e. the syscall and where in userspace it was made from.
+ * Only samples that come due in userspace are taken from the timer interrupt.
+ *
+ * Only compiled in with \c KERNEL_PROFILE defined, see \c PROFILE in
+ * scripts/makefile.
+ */
+
+#include <kmi/syscalls.h>
+#include <kmi/timer.h>
+#include <kmi/types.h>
+#include <kmi/utils.h>
+#include <kmi/vmem.h>
+#include <kmi/tcb.h>
+
+#if defined(KERNEL_PROFILE)
+
+/** Whether profiler is running, use the inline wrappers instead of checking
+ * this directly. */
+extern bool profile_enabled;
+
+/**
+ * Remember where kernel was entered from. Use \ref profile_enter() instead.
+ *
+ * @param t Thread that entered the kernel.
+ */
+void profile_entry(struct tcb *t);
+
+/**
+ * Take sample if one came due while in the kernel. Use \ref profile_leave()
+ * instead.
+ *
+ * @param t Thread about to run in userspace.
+ */
+void profile_exit(struct tcb *t);
+
+/**
+ * Remember syscall being handled. Use \ref profile_syscall() instead.
+ *
+ * @param t Current thread.
+ * @param num Syscall number.
+ */
+void profile_mark(struct tcb *t, sys_arg_t num);
+
+/**
+ * Remember where kernel was entered from, if profiler is running.
+ * Called on every kernel entry.
+ *
+ * @param t Thread that entered the kernel.
+ */
+static inline void profile_enter(struct tcb *t)
+{
+	if (unlikely(profile_enabled))
+		profile_entry(t);
+}
+
+/**
+ * Take sample if one came due while in the kernel, if profiler is running.
+ * Called on every return to userspace.
+ *
+ * @param t Thread about to run in userspace.
+ */
+static inline void profile_leave(struct tcb *t)
+{
+	if (unlikely(profile_enabled))
+		profile_exit(t);
+}
+
+/**
+ * Remember syscall being handled, if profiler is running.
+ *
+ * @param t Current thread.
+ * @param num Syscall number.
+ */
+static inline void profile_syscall(struct tcb *t, sys_arg_t num)
+{
+	if (unlikely(profile_enabled))
+		profile_mark(t, num);
+}
+
+/**
+ * Take sample of userspace if one is due. Called from the timer interrupt,
+ * before \ref handle_timer().
+ *
+ * @param t Interrupted thread.
+ */
+void profile_sample(struct tcb *t);
+
+/**
+ * Get when current core wants to take its next sample.
+ *
+ * @return Tick of next sample, \c (ticks_t)-1 if none.
+ */
+ticks_t profile_due();
+
+/**
+ * Start taking samples. Buffers are allocated the first time around. Cores
+ * pick up the new period the next time they leave the kernel. Must be called
+ * with the big kernel lock held.
+ *
+ * @param period Ticks between samples.
+ * @return \ref OK on success, \ref ERR_INVAL if \p period is zero, \ref
+ * ERR_OOMEM if buffers couldn't be allocated.
+ */
+stat_t profile_start(ticks_t period);
+
+/** Stop taking samples. */
+void profile_stop();
+
+/**
+ * Move samples taken on core into \p buf. Must be called with the big kernel
+ * lock held.
+ *
+ * @param cpu Core whose samples to drain.
+ * @param l Virtual memory \p buf is in.
+ * @param buf Where to write \ref sys_profile_rec entries.
+ * @param max Maximum number of entries to write.
+ * @param drained Number of entries written.
+ * @param dropped Number of samples dropped due to a full buffer since last
+ * drain.
+ * @return \ref OK on success, \ref ERR_INVAL if \p cpu is invalid, \ref
+ * ERR_ADDR if \p buf isn't writable.
+ */
+stat_t profile_drain(id_t cpu, struct vmem *l, vm_t buf, size_t max,
+                     size_t *drained, size_t *dropped);
+
+#else
+
+/**
+ * Noop when profiling is disabled.
+ *
+ * @param t Unused.
+ */
+static inline void profile_enter(struct tcb *t)
+{
+	(void)t;
+}
+
+/**
+ * Noop when profiling is disabled.
+ *
+ * @param t Unused.
+ */
+static inline void profile_leave(struct tcb *t)
+{
+	(void)t;
+}
+
+/**
+ * Noop when profiling is disabled.
+ *
+ * @param t Unused.
+ * @param num Unused.
+ */
+static inline void profile_syscall(struct tcb *t, sys_arg_t num)
+{
+	(void)t;
+	(void)num;
+}
+
+/**
+ * Noop when profiling is disabled.
+ *
+ * @param t Unused.
+ */
+static inline void profile_sample(struct tcb *t)
+{
+	(void)t;
+}
+
+/**
+ * Profiling is disabled.
+ *
+ * @return \c (ticks_t)-1.
+ */
+static inline ticks_t profile_due()
+{
+	return (ticks_t)-1;
+}
+
+/**
+ * Profiling is disabled.
+ *
+ * @param period Unused.
+ * @return \ref ERR_NOINIT.
+ */
+static inline stat_t profile_start(ticks_t period)
+{
+	(void)period;
+	return ERR_NOINIT;
+}
+
+/** Noop when profiling is disabled. */
+static inline void profile_stop()
+{
+}
+
+/**
+ * Profiling is disabled.
+ *
+ * @param cpu Unused.
+ * @param l Unused.
+ * @param buf Unused.
+ * @param max Unused.
+ * @param drained Unused.
+ * @param dropped Unused.
+ * @return \ref ERR_NOINIT.
+ */
+static inline stat_t profile_drain(id_t cpu, struct vmem *l, vm_t buf,
+                                   size_t max, size_t *drained,
+                                   size_t *dropped)
+{
+	(void)cpu;
+	(void)l;
+	(void)buf;
+	(void)max;
+	(void)drained;
+	(void)dropped;
+	return ERR_NOINIT;
+}
+
+#endif /* KERNEL_PROFILE */
+
+#endif /* KMI_PROFILE_H */
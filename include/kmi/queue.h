@@ -62,6 +62,15 @@ static inline bool in_queue(struct queue_head *head)
 	return in_list(&head->l);
 }
 
+/**
+ * @param head Head of queue.
+ * @return \ref true if queue has no entries, \ref false otherwise.
+ */
+static inline bool queue_empty(struct queue_head *head)
+{
+	return list_empty(&head->l);
+}
+
 /**
  * Remove entry from queue.
  *
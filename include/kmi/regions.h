@@ -28,6 +28,13 @@ void init_mem_nodes();
  */
 void destroy_mem_nodes();
 
+/**
+ * Get memory region node subsystem instance, for statistics.
+ *
+ * @return Memory region node root.
+ */
+struct node_root *mem_nodes();
+
 /**
  * Get \ref mem_region container of \c ptr.
  *
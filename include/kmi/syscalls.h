@@ -64,6 +64,9 @@ enum sys_code {
 
 	/** Free memory. */
 	SYS_FREE_MEM,
+
+	/** Copy memory to or from some process in our RPC chain. */
+	SYS_COPY_MEM,
 	/** @} */
 
 	/** @name Timers */
@@ -80,8 +83,14 @@ enum sys_code {
 	/** Request absolute timer (timepoint in ticks). */
 	SYS_REQ_ABS_TIMER,
 
+	/** Request periodic timer. */
+	SYS_REQ_PERIODIC_TIMER,
+
 	/** Remove timer. */
 	SYS_FREE_TIMER,
+
+	/** Get and reset number of overruns of periodic timer. */
+	SYS_TIMER_OVERRUN,
 	/** @} */
 
 	/** @name IPC. */
@@ -104,6 +113,21 @@ enum sys_code {
 
 	/** Notify thread, essentially interrupt or signal. */
 	SYS_IPC_NOTIFY,
+
+	/** Send several IPC requests back-to-back in one go. */
+	SYS_IPC_VEC,
+
+	/** Fetch queued notifications. */
+	SYS_IPC_DRAIN,
+	/** @} */
+
+	/** @name Synchronization. */
+	/** @{ */
+	/** Wait on address until woken up. */
+	SYS_WAIT,
+
+	/** Wake up threads waiting on address. */
+	SYS_WAKE,
 	/** @} */
 
 	/** @name Process management. */
@@ -123,6 +147,9 @@ enum sys_code {
 	/** Switch running process. */
 	SYS_SWAP,
 
+	/** Get CPU time and event counters of thread. */
+	SYS_THREAD_STATS,
+
 	/** @} */
 
 	/** @name Kernel management. */
@@ -133,6 +160,18 @@ enum sys_code {
 	/** Get system parameters. */
 	SYS_GET_CONF,
 
+	/** Get or reset per-syscall counters and latency histograms. */
+	SYS_SYSCALL_STATS,
+
+	/** Control kernel event tracing and drain trace buffers. */
+	SYS_TRACE,
+
+	/** Discover and program hardware performance counters. */
+	SYS_PMU,
+
+	/** Control sampling profiler and drain sample buffers. */
+	SYS_PROFILE,
+
 	/** Set capability of thread. */
 	SYS_SET_CAP,
 
@@ -154,6 +193,9 @@ enum sys_code {
 	/** Retract IRQ. */
 	SYS_FREE_IRQ,
 
+	/** Route IRQ to some specific core. */
+	SYS_IRQ_AFFINITY,
+
 	/** Request a notification handler. */
 	SYS_SET_HANDLER,
 
@@ -163,6 +205,9 @@ enum sys_code {
 	/** Detach a thread from its root process, becoming an orphant. */
 	SYS_DETACH,
 
+	/** Process submission ring. */
+	SYS_RING_ENTER,
+
 	/** @} */
 
 	SYS_NUM,
@@ -222,6 +267,55 @@ enum poweroff_type {
  */
 typedef long sys_arg_t;
 
+/** Request descriptor for \ref SYS_IPC_VEC. */
+struct sys_ipc_desc {
+	/** Process to send request to. */
+	sys_arg_t pid;
+
+	/** IPC argument 0. */
+	sys_arg_t d0;
+
+	/** IPC argument 1. */
+	sys_arg_t d1;
+
+	/** IPC argument 2. */
+	sys_arg_t d2;
+
+	/** IPC argument 3. */
+	sys_arg_t d3;
+};
+
+/** Direction of \ref SYS_COPY_MEM. */
+enum copy_dir {
+	/** Copy from the remote process into the caller. */
+	COPY_FROM,
+
+	/** Copy from the caller into the remote process. */
+	COPY_TO,
+};
+
+/**
+ * Scatter/gather element for \ref SYS_COPY_MEM.
+ * Each element describes one fragment, so one syscall can move a bunch of
+ * unrelated buffers around.
+ */
+struct sys_iovec {
+	/** Address in caller's address space. */
+	sys_arg_t local;
+
+	/** Address in remote process address space. */
+	sys_arg_t remote;
+
+	/** How many bytes to copy. */
+	sys_arg_t size;
+};
+
+/** Maximum number of fragments \ref SYS_COPY_MEM handles in one call. */
+#define COPY_MEM_MAX_FRAGMENTS 64
+
+/** Maximum number of bytes \ref SYS_COPY_MEM copies in one call. */
+#define COPY_MEM_MAX_BYTES (256 * 1024)
+
 /** IDs for configuration parameters. */
 enum conf_param {
 	/**
@@ -265,6 +359,82 @@ enum conf_param {
 	 * \c R
 	 */
 	CONF_MAX_THREADS,
+
+	/**
+	 * Number of pages of some order currently in use. Pages split up to
+	 * hand out smaller pages don't count.
+	 * Uses `d0` to signify which order to request.
+	 * \c R
+	 */
+	CONF_RAM_USED_PAGES,
+
+	/**
+	 * Number of free pages of some order, not counting larger pages that
+	 * could be split up.
+	 * Uses `d0` to signify which order to request.
+	 * \c R
+	 */
+	CONF_RAM_FREE_PAGES,
+
+	/**
+	 * Size of largest page that can currently be allocated. Compared to
+	 * \ref CONF_RAM_USAGE, gives an idea of how fragmented memory is.
+	 * \c R
+	 */
+	CONF_RAM_LARGEST_FREE,
+
+	/**
+	 * Number of nodes in use in some kernel node pool.
+	 * Uses `d0` to signify which pool, see \ref conf_nodes.
+	 * \c R
+	 */
+	CONF_NODES_USED,
+
+	/**
+	 * Number of nodes that fit in pages currently allocated to some kernel
+	 * node pool.
+	 * Uses `d0` to signify which pool, see \ref conf_nodes.
+	 * \c R
+	 */
+	CONF_NODES_CAPACITY,
+
+	/**
+	 * Number of base pages allocated to some kernel node pool.
+	 * Uses `d0` to signify which pool, see \ref conf_nodes.
+	 * \c R
+	 */
+	CONF_NODES_PAGES,
+
+	/**
+	 * Number of threads currently alive, compare against \ref
+	 * CONF_MAX_THREADS.
+	 * \c R
+	 */
+	CONF_THREADS,
+
+	/**
+	 * Number of pages used for page tables.
+	 * \c R
+	 */
+	CONF_PAGE_TABLES,
+
+	/**
+	 * Bytes of memory backing RPC stacks.
+	 * \c R
+	 */
+	CONF_RPC_STACK_USAGE,
+};
+
+/** Kernel node pools, for \ref CONF_NODES_USED and friends. */
+enum conf_nodes {
+	/** Memory regions. */
+	NODES_REGIONS,
+
+	/** Timers. */
+	NODES_TIMERS,
+
+	/** Number of pools. */
+	NODES_NUM,
 };
 
 /** Capabilities of process. */
@@ -301,6 +471,8 @@ enum sys_cap {
  * track of.
  */
 enum sys_status {
+	/** Timed out. */
+	ERR_TIMEOUT = -11,
 	/** Permission error. */
 	ERR_PERM = -10,
 	/** Internal error, should probably halt */
@@ -351,4 +523,397 @@ struct sys_ret {
 	sys_arg_t a3;
 };
 
+/** Queued notification, see \ref SYS_IPC_DRAIN. */
+struct sys_notify {
+	/** Effective process ID of sender. */
+	sys_arg_t pid;
+
+	/** Thread ID of sender. */
+	sys_arg_t tid;
+
+	/** Payload given to \ref SYS_IPC_NOTIFY. */
+	sys_arg_t payload;
+};
+
+/**
+ * Header of submission/completion ring for \ref SYS_RING_ENTER.
+ * The header is followed directly by \c size submission entries (\ref
+ * sys_sqe), which are followed directly by \c size completion entries (\ref
+ * sys_cqe). Indexes are free-running, i.e. they're only masked with \c size
+ * - 1 when accessing an entry.
+ */
+struct sys_ring {
+	/** Number of entries in each queue, must be a power of two. Owned by
+	 * userspace. */
+	sys_arg_t size;
+
+	/** Next submission entry the kernel will look at. Owned by kernel. */
+	sys_arg_t sq_head;
+
+	/** Next free submission entry. Owned by userspace. */
+	sys_arg_t sq_tail;
+
+	/** Next completion entry userspace will look at. Owned by userspace. */
+	sys_arg_t cq_head;
+
+	/** Next free completion entry. Owned by kernel. */
+	sys_arg_t cq_tail;
+};
+
+/** Submission queue entry. */
+struct sys_sqe {
+	/** Which syscall to run, see \ref sys_code. */
+	sys_arg_t op;
+
+	/** Syscall argument 0. */
+	sys_arg_t a0;
+
+	/** Syscall argument 1. */
+	sys_arg_t a1;
+
+	/** Syscall argument 2. */
+	sys_arg_t a2;
+
+	/** Syscall argument 3. */
+	sys_arg_t a3;
+
+	/** Syscall argument 4. */
+	sys_arg_t a4;
+
+	/** Userspace data, copied as-is to corresponding \ref sys_cqe. */
+	sys_arg_t user;
+};
+
+/** Completion queue entry. */
+struct sys_cqe {
+	/** Userspace data from corresponding \ref sys_sqe. */
+	sys_arg_t user;
+
+	/** What the syscall returned. */
+	struct sys_ret r;
+};
+
+/**
+ * Thread statistics, see \ref SYS_THREAD_STATS.
+ * Times are in ticks, see \ref SYS_TIMEBASE.
+ */
+struct sys_stats {
+	/** Time spent in userspace of own process. */
+	unsigned long long user;
+
+	/** Time spent in kernel on behalf of thread. */
+	unsigned long long kernel;
+
+	/** Time spent in userspace of some other process as an RPC guest,
+	 * i.e. while the effective process ID differed from the root process
+	 * ID. */
+	unsigned long long rpc;
+
+	/** Time threads from other processes spent in this process as RPC
+	 * guests. Only collected for process threads, so this is how busy a
+	 * server is. */
+	unsigned long long served;
+
+	/** Number of syscalls made. */
+	sys_arg_t syscalls;
+
+	/** Number of page faults taken. */
+	sys_arg_t faults;
+};
+
+/** Maximum number of cores that get their own counters in \ref sys_kdata. */
+#define KDATA_CPUS 16
+
+/** Maximum number of page orders listed in \ref sys_kdata. */
+#define KDATA_ORDERS 8
+
+/**
+ * Per-core event counters in \ref sys_kdata.
+ * Only ever written by the core they belong to, and not covered by \ref
+ * sys_kdata.seq, so reading them is always a bit racy. Good enough for
+ * statistics.
+ */
+struct sys_kdata_cpu {
+	/** Number of syscalls handled. */
+	sys_arg_t syscalls;
+
+	/** Number of external interrupts handled. */
+	sys_arg_t irqs;
+
+	/** Number of timer interrupts handled. */
+	sys_arg_t timers;
+
+	/** Number of inter-processor interrupts handled. */
+	sys_arg_t ipis;
+};
+
+/**
+ * Kernel data page, mapped read-only at \ref KDATA_ADDR in every process.
+ * Lets userspace look up things like the timebase or RAM usage without a
+ * trap. Not available on archs that don't define \ref KDATA_ADDR, i.e. rv32.
+ *
+ * Everything except \ref sys_kdata.cpu is protected by a sequence lock,
+ * \ref sys_kdata.seq is odd while the kernel is updating the page. Readers
+ * should read \ref sys_kdata.seq, read whatever they want, and retry if \ref
+ * sys_kdata.seq was odd or changed in the meantime.
+ */
+struct sys_kdata {
+	/** Sequence counter. */
+	sys_arg_t seq;
+
+	/** Ticks per second, same as \ref SYS_TIMEBASE. */
+	unsigned long long timebase;
+
+	/** Ticks at the last timer interrupt or syscall that changed the page.
+	 * Only a lower bound for the current time, use \ref SYS_TICKS or a
+	 * hardware counter if you need precision. */
+	unsigned long long ticks;
+
+	/** Number of cores in the system. */
+	sys_arg_t cpus;
+
+	/** Number of valid entries in \ref sys_kdata.page_size. */
+	sys_arg_t orders;
+
+	/** Size of each page order, same as \ref CONF_PAGE_SIZE. */
+	sys_arg_t page_size[KDATA_ORDERS];
+
+	/** Size of RAM, same as \ref CONF_RAM_SIZE. */
+	sys_arg_t ram_size;
+
+	/** RAM in use, same as \ref CONF_RAM_USAGE. */
+	sys_arg_t ram_usage;
+
+	/** Same as \ref CONF_MAX_THREADS. */
+	sys_arg_t max_threads;
+
+	/** Same as \ref CONF_THREAD_STACK. */
+	sys_arg_t thread_stack;
+
+	/** Same as \ref CONF_RPC_STACK. */
+	sys_arg_t rpc_stack;
+
+	/** Per-core counters. */
+	struct sys_kdata_cpu cpu[KDATA_CPUS];
+};
+
+/** Number of latency buckets in \ref sys_syscall_stats.hist. */
+#define SYSCALL_STATS_BUCKETS 16
+
+/** Operations of \ref SYS_SYSCALL_STATS. */
+enum sys_syscall_stats_op {
+	/** Copy counters of one syscall to userspace. */
+	SYSCALL_STATS_GET,
+
+	/** Zero counters of all syscalls. Requires \ref CAP_CONF. */
+	SYSCALL_STATS_RESET,
+};
+
+/**
+ * Counters of one syscall summed over all cores, filled in by \ref
+ * SYS_SYSCALL_STATS. Latencies are in ticks, see \ref SYS_TIMEBASE, and
+ * measured from kernel entry to the kernel returning to userspace, which
+ * includes waiting for the kernel lock.
+ */
+struct sys_syscall_stats {
+	/** Number of invocations. */
+	unsigned long long count;
+
+	/** Total ticks spent in syscall. */
+	unsigned long long ticks;
+
+	/** Longest single invocation. */
+	unsigned long long max;
+
+	/** Latency histogram. \c hist[0] counts invocations that took less
+	 * than a tick, \c hist[i] those that took \c 2^(i-1) to \c 2^i - 1
+	 * ticks. The last bucket counts everything longer. */
+	unsigned long long hist[SYSCALL_STATS_BUCKETS];
+};
+
+/** Operations of \ref SYS_TRACE. */
+enum sys_trace_op {
+	/** Start recording events. */
+	TRACE_START,
+
+	/** Stop recording events, already recorded ones can still be
+	 * drained. */
+	TRACE_STOP,
+
+	/** Move recorded events of one core to userspace. */
+	TRACE_DRAIN,
+};
+
+/** Kernel events recorded in \ref sys_trace_rec.event. */
+enum sys_trace_event {
+	/** Syscall entry, \c a0 is the syscall number, \c a1 its first
+	 * argument. */
+	TRACE_SYSCALL,
+
+	/** Return to userspace, ends whatever the kernel was doing. */
+	TRACE_RETURN,
+
+	/** Migration into process \c a0 from process \c a1. */
+	TRACE_RPC_ENTER,
+
+	/** Migration back into process \c a0 from process \c a1. */
+	TRACE_RPC_LEAVE,
+
+	/** Notification of thread \c a0 with flags \c a1. */
+	TRACE_NOTIFY,
+
+	/** Timer interrupt, \c a0 is the current time. */
+	TRACE_TIMER,
+
+	/** External interrupt \c a0. */
+	TRACE_IRQ,
+
+	/** Page fault at address \c a0, \c a1 is the arch specific cause. */
+	TRACE_FAULT,
+
+	/** Page of order \c a0 allocated at physical address \c a1. */
+	TRACE_ALLOC_PAGE,
+};
+
+/** One trace record, filled in by \ref SYS_TRACE. */
+struct sys_trace_rec {
+	/** When event happened, in ticks, see \ref SYS_TIMEBASE. */
+	unsigned long long ticks;
+
+	/** Event, see \ref sys_trace_event. */
+	unsigned short event;
+
+	/** Core event happened on. */
+	unsigned short cpu;
+
+	/** Thread running on core at the time. */
+	int tid;
+
+	/** First event specific argument. */
+	unsigned long long a0;
+
+	/** Second event specific argument. */
+	unsigned long long a1;
+};
+
+/** Number of events that can be counted through \ref SYS_PMU at once. */
+#define PMU_SLOTS 4
+
+/** Operations of \ref SYS_PMU. */
+enum sys_pmu_op {
+	/** Get number of counters the hardware has. */
+	PMU_NUM,
+
+	/** Get CSR number and width of counter. */
+	PMU_INFO,
+
+	/** Start counting event in slot. */
+	PMU_CONFIG,
+
+	/** Stop counting in slot. */
+	PMU_RELEASE,
+
+	/** Read how many events calling thread has caused in slot. */
+	PMU_READ,
+
+	/** Set which counters userspace can read directly, same layout as the
+	 * \c scounteren CSR. */
+	PMU_USER,
+};
+
+/** Events \ref SYS_PMU knows how to count. Which ones are actually available
+ * depends on the hardware. */
+enum sys_pmu_event {
+	/** Clock cycles. */
+	PMU_CYCLES,
+
+	/** Retired instructions. */
+	PMU_INSTRET,
+
+	/** Cache accesses, usually last level. */
+	PMU_CACHE_REFS,
+
+	/** Cache misses, usually last level. */
+	PMU_CACHE_MISSES,
+
+	/** Retired branches. */
+	PMU_BRANCHES,
+
+	/** Mispredicted branches. */
+	PMU_BRANCH_MISSES,
+
+	/** L1 data cache read misses. */
+	PMU_L1D_READ_MISSES,
+
+	/** L1 instruction cache read misses. */
+	PMU_L1I_READ_MISSES,
+
+	/** Data TLB read misses. */
+	PMU_DTLB_READ_MISSES,
+
+	/** Instruction TLB read misses. */
+	PMU_ITLB_READ_MISSES,
+
+	/** Number of events. */
+	PMU_EVENTS,
+};
+
+/** Operations of \ref SYS_PROFILE. */
+enum sys_profile_op {
+	/** Start taking samples. */
+	PROFILE_START,
+
+	/** Stop taking samples, already taken ones can still be drained. */
+	PROFILE_STOP,
+
+	/** Move samples taken on one core to userspace. */
+	PROFILE_DRAIN,
+};
+
+/** Where a core was when a sample was taken, see \ref
+ * sys_profile_rec.mode. */
+enum sys_profile_mode {
+	/** Running userspace code at \ref sys_profile_rec.pc. */
+	PROFILE_USER,
+
+	/** Running in the kernel on behalf of the thread that entered it at
+	 * \ref sys_profile_rec.pc. */
+	PROFILE_KERNEL,
+};
+
+/** Maximum number of return addresses in one sample. */
+#define PROFILE_FRAMES 8
+
+/** One sample, filled in by \ref SYS_PROFILE. */
+struct sys_profile_rec {
+	/** When sample was taken, in ticks, see \ref SYS_TIMEBASE. */
+	unsigned long long ticks;
+
+	/** Mode, see \ref sys_profile_mode. */
+	unsigned short mode;
+
+	/** Core sample was taken on. */
+	unsigned short cpu;
+
+	/** Thread that was running. */
+	int tid;
+
+	/** Process whose code was running. */
+	int pid;
+
+	/** Syscall number the kernel was handling for \ref PROFILE_KERNEL
+	 * samples, \c -1 for interrupts, exceptions and \ref PROFILE_USER
+	 * samples. */
+	int what;
+
+	/** Program counter. */
+	unsigned long long pc;
+
+	/** Return addresses of calling functions, innermost first and
+	 * terminated by \c 0 if there are fewer than \ref PROFILE_FRAMES.
+	 * Only filled in when the kernel is built with frame pointers, see \c
+	 * FRAMEPTR in scripts/makefile. */
+	unsigned long long frames[PROFILE_FRAMES];
+};
+
 #endif /* KMI_SYSCALLS_H */
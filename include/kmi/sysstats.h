@@ -0,0 +1,103 @@
+/* SPDX-License-Identifier: copyleft-next-0.3.1 */
+/* Copyright 2024, Kim Kuparinen < kimi.h.kuparinen@gmail.com > */
+
+#ifndef KMI_SYSSTATS_H
+#define KMI_SYSSTATS_H
+
+/**
+ * @file sysstats.h
+ *
+ * Per-syscall invocation counters and latency histograms, see \ref
+ * SYS_SYSCALL_STATS. Each core marks which syscall it's handling in \ref
+ * handle_syscall(), and \ref acct_leave() charges the time it already
+ * measured for the kernel entry to that syscall on the way out. This way
+ * syscalls that never return through \ref handle_syscall(), like IPC, are
+ * counted as well, and the only extra cost is a couple of loads and stores.
+ *
+ * Only compiled in with \c SYSCALL_STATS defined, see \c STATS in
+ * scripts/makefile.
+ */
+
+#include <kmi/syscalls.h>
+#include <kmi/timer.h>
+#include <kmi/types.h>
+#include <kmi/tcb.h>
+
+#if defined(SYSCALL_STATS)
+
+/**
+ * Mark that the core of \p t is handling syscall \p num.
+ *
+ * @param t Current thread.
+ * @param num Syscall number.
+ */
+void sysstats_enter(struct tcb *t, sys_arg_t num);
+
+/**
+ * Charge \p ticks to whatever syscall the core of \p t was handling, if any.
+ *
+ * @param t Thread about to run in userspace.
+ * @param ticks Ticks since kernel entry.
+ */
+void sysstats_leave(struct tcb *t, ticks_t ticks);
+
+/**
+ * Sum counters of syscall over all cores.
+ *
+ * @param num Syscall number.
+ * @param out Where to write counters.
+ * @return \ref OK on success, \ref ERR_INVAL if \p num isn't a syscall.
+ */
+stat_t sysstats_get(sys_arg_t num, struct sys_syscall_stats *out);
+
+/** Zero counters of all syscalls on all cores. */
+void sysstats_reset();
+
+#else
+
+/**
+ * Noop when syscall statistics are disabled.
+ *
+ * @param t Unused.
+ * @param num Unused.
+ */
+static inline void sysstats_enter(struct tcb *t, sys_arg_t num)
+{
+	(void)t;
+	(void)num;
+}
+
+/**
+ * Noop when syscall statistics are disabled.
+ *
+ * @param t Unused.
+ * @param ticks Unused.
+ */
+static inline void sysstats_leave(struct tcb *t, ticks_t ticks)
+{
+	(void)t;
+	(void)ticks;
+}
+
+/**
+ * Syscall statistics are disabled.
+ *
+ * @param num Unused.
+ * @param out Unused.
+ * @return \ref ERR_NOINIT.
+ */
+static inline stat_t sysstats_get(sys_arg_t num, struct sys_syscall_stats *out)
+{
+	(void)num;
+	(void)out;
+	return ERR_NOINIT;
+}
+
+/** Noop when syscall statistics are disabled. */
+static inline void sysstats_reset()
+{
+}
+
+#endif /* SYSCALL_STATS */
+
+#endif /* KMI_SYSSTATS_H */
@@ -22,6 +22,21 @@ struct tcb;
 
 #include <arch/tcb.h>
 
+/** State of an ongoing \ref sys_ipc_vec() batch. */
+struct ipc_batch {
+	/** Address of request descriptor array in the caller. */
+	vm_t vec;
+
+	/** Address of completion array in the caller. */
+	vm_t comp;
+
+	/** Number of requests in batch. */
+	sys_arg_t count;
+
+	/** Index of request currently being handled. */
+	sys_arg_t idx;
+};
+
 /** Structure for maintaining the required context data for an rpc call. */
 struct call_ctx {
 	/** Execution continuation point. */
@@ -40,6 +55,13 @@ struct call_ctx {
 	 * frame must restore registers as they were */
 	bool notify;
 
+	/** If this frame is part of a batch, in which case leaving the frame
+	 * should start the next request instead of returning */
+	bool batch;
+
+	/** Batch state, only valid if \ref batch is set. */
+	struct ipc_batch b;
+
 	/* register save area follows this in the stack */
 };
 
@@ -104,6 +126,92 @@ enum tcb_state {
 	TCB_ORPHAN = (1 << 1),
 };
 
+/** Number of notifications that can be queued per thread, must be a power of
+ * two. */
+#define NOTIFY_QUEUE_SIZE 16
+
+/**
+ * Queue of notifications sent with \ref sys_ipc_notify().
+ * Indexes are free-running, masked with \ref NOTIFY_QUEUE_SIZE - 1 on access.
+ */
+struct tcb_notify {
+	/** Queued notifications. */
+	struct sys_notify ev[NOTIFY_QUEUE_SIZE];
+
+	/** Oldest queued notification. */
+	size_t head;
+
+	/** Next free slot. */
+	size_t tail;
+};
+
+/** State of thread in \ref sys_wait(). */
+enum wait_state {
+	/** Not waiting. */
+	WAIT_NONE,
+
+	/** Waiting to be woken up. */
+	WAIT_SLEEPING,
+
+	/** Woken up, but hasn't returned from \ref sys_wait() yet. */
+	WAIT_DONE,
+};
+
+/** CPU time accounting of thread, see \ref acct.h. */
+struct tcb_acct {
+	/** Statistics exposed to userspace. */
+	struct sys_stats s;
+
+	/** Value of \ref sys_stats.rpc when thread last moved between
+	 * processes, everything after it should go to the current process'
+	 * \ref sys_stats.served. */
+	unsigned long long mark;
+};
+
+/** IPI queueing data of thread, see \ref ipi.h. */
+struct tcb_ipi {
+	/** Next thread in lock-free inbox of \ref cpu. */
+	struct tcb *next;
+
+	/** Position in local queue of \ref cpu, once moved out of inbox. */
+	struct queue_head q;
+
+	/** CPU whose queue thread is in. */
+	id_t cpu;
+
+	/** Whether thread is in some IPI queue. Set atomically to avoid
+	 * queueing thread twice. */
+	bool queued;
+};
+
+/** Performance counter values of thread, see \ref pmu.h. */
+struct tcb_pmu {
+	/** Generation of each slot the counts belong to, if a slot has been
+	 * reprogrammed since the count is stale. */
+	unsigned long gen[PMU_SLOTS];
+
+	/** How many events thread has caused in each slot. */
+	unsigned long long count[PMU_SLOTS];
+};
+
+/** Wait queue data of thread, see \ref wait.h. */
+struct tcb_wait {
+	/** Physical address we're waiting on. */
+	pm_t addr;
+
+	/** Timeout timer, \c 0 if none. */
+	id_t timer;
+
+	/** Status to return from \ref sys_wait(). */
+	stat_t status;
+
+	/** Current state. */
+	enum wait_state state;
+
+	/** Position in wait queue. */
+	struct queue_head q;
+};
+
 /** Wrapper around data for managing userspace virtual memory, defined here to
  * avoid loops */
 struct uvmem {
@@ -204,11 +312,23 @@ struct tcb {
 	/** Currently waiting notifications. */
 	enum notify_flag notify_flags;
 
+	/** Notifications with payloads waiting to be drained. */
+	struct tcb_notify notify_queue;
+
 	/** Capabilities of thread. */
 	enum sys_cap caps;
 
-	/** Queue that connects together threads waiting for an ipi */
-	struct queue_head ipi_queue;
+	/** IPI queueing data. */
+	struct tcb_ipi ipi;
+
+	/** Wait queue data. */
+	struct tcb_wait wait;
+
+	/** CPU time accounting. */
+	struct tcb_acct acct;
+
+	/** Performance counter values. */
+	struct tcb_pmu pmu;
 
 	/** Current state of thread. */
 	enum tcb_state state;
@@ -224,6 +344,12 @@ void init_tcbs();
  */
 size_t max_tcbs();
 
+/**
+ * @return Number of threads currently alive, including zombies that haven't
+ * been cleaned up yet.
+ */
+size_t alive_tcbs();
+
 /**
  * Destroy thread control subsystem.
  */
@@ -318,7 +444,8 @@ struct tcb *eff_proc();
 /**
  * Set \c t as current \ref tcb.
  *
- * Also updates the current cpu id of the tcb.
+ * Also updates the current cpu id of the tcb, and charges performance
+ * counters to the thread that was running, see \ref pmu_switch().
  *
  * @param t Thread to mark as current.
  */
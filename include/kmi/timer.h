@@ -11,6 +11,7 @@
  * \todo Document exceptions and return values better.
  */
 
+#include <kmi/nodes.h>
 #include <kmi/types.h>
 
 /**
@@ -39,38 +40,81 @@ struct timer {
 	/** ticks. Absolute number of ticks, essentially a timepoint for when
 	 * the timer should trigger. */
 	ticks_t ticks;
+
+	/** Period of timer in ticks, \c 0 for one-shot timers. */
+	ticks_t period;
+
+	/** Number of periods that passed without the thread getting a new
+	 * notification, either because the previous one was still pending or
+	 * because we were late enough to skip whole periods. */
+	size_t overruns;
+
+	/** Whether this is a timeout for \ref sys_wait() instead of a regular
+	 * timer that should send a notification. */
+	bool wait;
 };
 
 /**
  * Initialize timers.
  *
  * @param fdt Pointer to global FDT
+ * @return \ref OK on success, \ref ERR_OOMEM if the timer index couldn't be
+ * allocated.
  */
-void init_timer(const void *fdt);
+stat_t init_timer(const void *fdt);
 
 /**
  * Set up timer interrupt ticks from now.
  *
  * @param tid Thread id for callback.
  * @param ticks Ticks from \ref current_ticks().
+ * @param slack How many ticks late the timer is allowed to trigger.
  * @return Id of created timer.
  */
-id_t new_rel_timer(id_t tid, ticks_t ticks);
+id_t new_rel_timer(id_t tid, ticks_t ticks, ticks_t slack);
 
 /**
  * Set up timer interrupt at ticks.
  *
+ * The timer triggers somewhere between \p ticks and \p ticks + \p slack,
+ * at a point chosen so that timers with overlapping windows tend to trigger
+ * together.
+ *
  * @param tid Thread id for callback.
  * @param ticks Ticks from \ref current_ticks().
+ * @param slack How many ticks late the timer is allowed to trigger.
+ * @return Id of created timer.
+ */
+id_t new_abs_timer(id_t tid, ticks_t ticks, ticks_t slack);
+
+/**
+ * Set up periodic timer.
+ * The timer first triggers \p period ticks from now, and is then moved
+ * forward by \p period every time it triggers, so the thread gets a steady
+ * stream of notifications without having to rearm the timer itself.
+ *
+ * @param tid Thread id for callback.
+ * @param period Period in ticks, must not be zero.
  * @return Id of created timer.
  */
-id_t new_abs_timer(id_t tid, ticks_t ticks);
+id_t new_periodic_timer(id_t tid, ticks_t period);
 
 /**
- * Return a pointer to the newest timer, i.e. the one that is closest to
- * triggering.
+ * Set up timeout for \ref sys_wait() ticks from now.
+ * Instead of sending a notification, the thread is woken up with \ref
+ * ERR_TIMEOUT.
  *
- * @return Pointer to a timer or NULL if queue is empty.
+ * @param tid Thread id of waiting thread.
+ * @param ticks Ticks from \ref current_ticks().
+ * @return Id of created timer.
+ */
+id_t new_wait_timer(id_t tid, ticks_t ticks);
+
+/**
+ * Return a pointer to a timer on the current core that is due, if any.
+ * Timers are returned in the order they expired.
+ *
+ * @return Pointer to a timer or NULL if no timer is due yet.
  */
 struct timer *newest_timer();
 
@@ -136,4 +180,18 @@ static inline ticks_t secs_to_ticks(tunit_t secs)
 /** Callback for timer IRQs. */
 void handle_timer();
 
+/**
+ * Get timer node subsystem instance, for statistics.
+ *
+ * @return Timer node root.
+ */
+struct node_root *timer_nodes();
+
+/**
+ * Reprogram hardware timer of current core, for when the profiler changes
+ * when it wants its next sample. Doesn't touch any timers, so can be called
+ * without the big kernel lock.
+ */
+void refresh_timer();
+
 #endif /* KMI_TIMER_H */
@@ -0,0 +1,141 @@
+/* SPDX-License-Identifier: copyleft-next-0.3.1 */
+/* Copyright 2024, Kim Kuparinen < kimi.h.kuparinen@gmail.com > */
+
+#ifndef KMI_TRACE_H
+#define KMI_TRACE_H
+
+/**
+ * @file trace.h
+ *
+ * Kernel event tracing. Each core writes fixed size binary records, see \ref
+ * sys_trace_rec, into its own ring buffer, and userspace drains them through
+ * \ref SYS_TRACE. Nothing is formatted or printed in the kernel, so
+ * tracepoints are cheap enough to leave in hot paths. When tracing isn't
+ * running, a tracepoint is one load and a branch.
+ *
+ * Only compiled in with \c KERNEL_TRACE defined, see \c TRACE in
+ * scripts/makefile.
+ */
+
+#include <kmi/syscalls.h>
+#include <kmi/types.h>
+#include <kmi/utils.h>
+#include <kmi/vmem.h>
+
+#if defined(KERNEL_TRACE)
+
+/** Whether tracing is running, use \ref trace() instead of checking this
+ * directly. */
+extern bool trace_enabled;
+
+/**
+ * Record event on current core. Use \ref trace() instead.
+ *
+ * @param event Event to record.
+ * @param a0 First argument.
+ * @param a1 Second argument.
+ */
+void trace_record(enum sys_trace_event event, unsigned long long a0,
+                  unsigned long long a1);
+
+/**
+ * Record event on current core if tracing is running.
+ * If the buffer of the core is full, the event is dropped and counted.
+ *
+ * @param event Event to record.
+ * @param a0 First argument.
+ * @param a1 Second argument.
+ */
+static inline void trace(enum sys_trace_event event, unsigned long long a0,
+                         unsigned long long a1)
+{
+	if (unlikely(trace_enabled))
+		trace_record(event, a0, a1);
+}
+
+/**
+ * Start recording events. Buffers are allocated the first time around.
+ *
+ * @return \ref OK on success, \ref ERR_OOMEM if buffers couldn't be
+ * allocated.
+ */
+stat_t trace_start();
+
+/** Stop recording events. */
+void trace_stop();
+
+/**
+ * Move recorded events of core into \p buf. Must be called with the big
+ * kernel lock held.
+ *
+ * @param cpu Core whose events to drain.
+ * @param l Virtual memory \p buf is in.
+ * @param buf Where to write \ref sys_trace_rec entries.
+ * @param max Maximum number of entries to write.
+ * @param drained Number of entries written.
+ * @param dropped Number of events dropped due to a full buffer since last
+ * drain.
+ * @return \ref OK on success, \ref ERR_INVAL if \p cpu is invalid, \ref
+ * ERR_ADDR if \p buf isn't writable.
+ */
+stat_t trace_drain(id_t cpu, struct vmem *l, vm_t buf, size_t max,
+                   size_t *drained, size_t *dropped);
+
+#else
+
+/**
+ * Noop when tracing is disabled.
+ *
+ * @param event Unused.
+ * @param a0 Unused.
+ * @param a1 Unused.
+ */
+static inline void trace(enum sys_trace_event event, unsigned long long a0,
+                         unsigned long long a1)
+{
+	(void)event;
+	(void)a0;
+	(void)a1;
+}
+
+/**
+ * Tracing is disabled.
+ *
+ * @return \ref ERR_NOINIT.
+ */
+static inline stat_t trace_start()
+{
+	return ERR_NOINIT;
+}
+
+/** Noop when tracing is disabled. */
+static inline void trace_stop()
+{
+}
+
+/**
+ * Tracing is disabled.
+ *
+ * @param cpu Unused.
+ * @param l Unused.
+ * @param buf Unused.
+ * @param max Unused.
+ * @param drained Unused.
+ * @param dropped Unused.
+ * @return \ref ERR_NOINIT.
+ */
+static inline stat_t trace_drain(id_t cpu, struct vmem *l, vm_t buf,
+                                 size_t max, size_t *drained, size_t *dropped)
+{
+	(void)cpu;
+	(void)l;
+	(void)buf;
+	(void)max;
+	(void)drained;
+	(void)dropped;
+	return ERR_NOINIT;
+}
+
+#endif /* KERNEL_TRACE */
+
+#endif /* KMI_TRACE_H */
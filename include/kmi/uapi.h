@@ -394,6 +394,24 @@ SYSCALL_DECLARE4(req_sharedmem, tid, size, sflags, cflags);
  * Returns \ref OK and 0.
  */
 SYSCALL_DECLARE1(free_mem, start);
+
+/**
+ * Copy memory syscall.
+ *
+ * Copies a list of fragments between the caller and some process in the RPC
+ * chain of the caller. Each fragment is resolved one page at a time, so
+ * fragments don't have to be contiguous in physical memory.
+ *
+ * @param t Current tcb.
+ * @param pid Remote process.
+ * @param iov Array of \ref sys_iovec.
+ * @param count Number of elements in \p iov.
+ * @param dir Direction of copy, \ref copy_dir.
+ * @param e Unused.
+ *
+ * Returns \ref OK and number of bytes copied.
+ */
+SYSCALL_DECLARE4(copy_mem, pid, iov, count, dir);
 /** @} */
 
 /** @name Timer syscalls. */
@@ -431,19 +449,22 @@ SYSCALL_DECLARE0(ticks);
 /**
  * Request relative timer syscall.
  *
- * Request timer that triggers a number of ticks in the future.
+ * Request timer that triggers a number of ticks in the future. If the caller
+ * can tolerate some lateness, \p slack lets the kernel group the timer with
+ * other timers that trigger around the same time, saving on interrupts.
  *
  * @param t Current tcb.
  * @param ticks Number of ticks from now.
  * @param mult Multiplier for \p ticks if we're on 32bit systems to produce a
  * combined 64 bit value. Ignored on 64bit systems.
- * @param c Unused.
+ * @param slack Number of ticks the timer is allowed to be late, \c 0 for
+ * exact timers.
  * @param d Unused.
  * @param e Unused.
  *
  * Returns \ref OK and ID of timer.
  */
-SYSCALL_DECLARE2(req_rel_timer, ticks, mult);
+SYSCALL_DECLARE3(req_rel_timer, ticks, mult, slack);
 
 /**
  * Request absolute timer syscall.
@@ -453,14 +474,34 @@ SYSCALL_DECLARE2(req_rel_timer, ticks, mult);
  * @param t Current tcb.
  * @param ticks Timepoint.
  * @param mult Multiplier.
- * @param c Unused.
+ * @param slack Number of ticks the timer is allowed to be late.
  * @param d Unused.
  * @param e Unused.
  *
  * Returns \ref OK and ID of timer.
  * \todo Check repeat value.
  */
-SYSCALL_DECLARE2(req_abs_timer, ticks, mult);
+SYSCALL_DECLARE3(req_abs_timer, ticks, mult, slack);
+
+/**
+ * Request periodic timer syscall.
+ *
+ * Request timer that first triggers \p period ticks from now, and then every
+ * \p period ticks after that until freed with \ref sys_free_timer(). If a
+ * period passes while the previous timer notification is still pending, no
+ * new notification is sent and the timer's overrun count is incremented
+ * instead, see \ref sys_timer_overrun().
+ *
+ * @param t Current tcb.
+ * @param period Period in ticks.
+ * @param mult Multiplier for \p period, see \ref sys_req_rel_timer().
+ * @param c Unused.
+ * @param d Unused.
+ * @param e Unused.
+ *
+ * Returns \ref OK and ID of timer.
+ */
+SYSCALL_DECLARE2(req_periodic_timer, period, mult);
 
 /**
  * Free timer syscall.
@@ -475,6 +516,20 @@ SYSCALL_DECLARE2(req_abs_timer, ticks, mult);
  * Returns \ref OK.
  */
 SYSCALL_DECLARE1(free_timer, cid);
+
+/**
+ * Timer overrun syscall.
+ *
+ * @param t Current tcb.
+ * @param cid ID of periodic timer.
+ * @param b Unused.
+ * @param c Unused.
+ * @param d Unused.
+ * @param e Unused.
+ *
+ * Returns \ref OK and number of overruns since the previous call.
+ */
+SYSCALL_DECLARE1(timer_overrun, cid);
 /** @} */
 
 /** @name IPC syscalls. */
@@ -574,16 +629,88 @@ SYSCALL_DECLARE4(ipc_resp, d0, d1, d2, d3);
 /**
  * Notify thread syscall.
  *
+ * Each notification is queued along with the sender and \p payload, up to
+ * \ref NOTIFY_QUEUE_SIZE notifications per thread. The notification handler
+ * is told how many notifications are queued and can fetch all of them in one
+ * go with \ref sys_ipc_drain().
+ *
  * @param t Current tcb.
  * @param tid Thread ID to notify.
- * @param b Unused.
+ * @param payload Word of data to pass along.
  * @param c Unused.
  * @param d Unused.
  * @param e Unused.
  *
- * Returns \ref OK and 0.
+ * Returns \ref OK and 0, or \ref ERR_OOMEM if the queue of \p tid is full.
  */
-SYSCALL_DECLARE1(ipc_notify, tid);
+SYSCALL_DECLARE2(ipc_notify, tid, payload);
+
+/**
+ * Drain queued notifications syscall.
+ *
+ * @param t Current tcb.
+ * @param buf Array of \ref sys_notify.
+ * @param max Number of elements in \p buf.
+ * @param c Unused.
+ * @param d Unused.
+ * @param e Unused.
+ *
+ * Returns \ref OK and number of notifications written to \p buf.
+ */
+SYSCALL_DECLARE2(ipc_drain, buf, max);
+
+/**
+ * Vectored IPC syscall.
+ *
+ * Runs several IPC requests back-to-back on the calling thread, without
+ * returning to the caller in between. Each response is written to the
+ * completion array as it arrives, and requests to illegal processes get an
+ * \ref ERR_INVAL completion without aborting the batch.
+ *
+ * @param t Current tcb.
+ * @param vec Array of \ref sys_ipc_desc.
+ * @param count Number of elements in \p vec.
+ * @param comp Array of \ref sys_ret, at least \p count elements long.
+ * @param d Unused.
+ * @param e Unused.
+ *
+ * Returns \ref OK and number of completed requests.
+ */
+SYSCALL_DECLARE3(ipc_vec, vec, count, comp);
+
+/**
+ * Wait syscall.
+ *
+ * Puts the current thread to sleep if the 32bit word at \p addr holds \p
+ * expected, until some other thread calls \ref sys_wake() on the same word or
+ * \p ticks have passed. The word is compared while holding the kernel lock, so
+ * a wakeup that happens after the caller changed the word can't be missed.
+ *
+ * @param t Current tcb.
+ * @param addr Address of 32bit word to wait on.
+ * @param expected Value \p addr is expected to hold.
+ * @param ticks Relative timeout, \c 0 to wait forever.
+ * @param d Unused.
+ * @param e Unused.
+ *
+ * Returns \ref OK when woken up or if \p addr didn't hold \p expected,
+ * \ref ERR_TIMEOUT when timed out.
+ */
+SYSCALL_DECLARE3(wait, addr, expected, ticks);
+
+/**
+ * Wake syscall.
+ *
+ * @param t Current tcb.
+ * @param addr Address of 32bit word to wake waiters on.
+ * @param n Maximum number of threads to wake.
+ * @param c Unused.
+ * @param d Unused.
+ * @param e Unused.
+ *
+ * Returns \ref OK and number of threads woken up.
+ */
+SYSCALL_DECLARE2(wake, addr, n);
 /** @} */
 
 /** @name Process handling syscalls. */
@@ -671,6 +798,24 @@ SYSCALL_DECLARE2(spawn, bin, interp);
  */
 SYSCALL_DECLARE1(swap, tid);
 
+/**
+ * Thread statistics syscall.
+ *
+ * Copy CPU time and event counters of thread into caller's memory. Anyone can
+ * look at anyone, same as with \ref sys_get_cap().
+ *
+ * @param t Current tcb.
+ * @param tid Thread to get statistics of, \c 0 for current thread.
+ * @param buf Where to write \ref sys_stats.
+ * @param c Unused.
+ * @param d Unused.
+ * @param e Unused.
+ *
+ * Returns \ref OK, \ref ERR_NF if \p tid doesn't exist or \ref ERR_ADDR if
+ * \p buf isn't writable.
+ */
+SYSCALL_DECLARE2(thread_stats, tid, buf);
+
 /** @} */
 
 /** @name Configuration syscalls. */
@@ -707,6 +852,94 @@ SYSCALL_DECLARE2(set_conf, param, val);
  */
 SYSCALL_DECLARE2(get_conf, param, d0);
 
+/**
+ * Syscall statistics syscall.
+ *
+ * Get counters of one syscall, or reset counters of all syscalls. Anyone can
+ * look, resetting requires \ref CAP_CONF.
+ *
+ * @param t Current tcb.
+ * @param op Operation, see \ref sys_syscall_stats_op.
+ * @param num Syscall to get counters of.
+ * @param buf Where to write \ref sys_syscall_stats.
+ * @param d Unused.
+ * @param e Unused.
+ *
+ * Returns \ref OK on success, \ref ERR_INVAL if \p op or \p num is invalid,
+ * \ref ERR_ADDR if \p buf isn't writable, \ref ERR_PERM if not allowed to
+ * reset and \ref ERR_NOINIT if the kernel was built without syscall
+ * statistics.
+ */
+SYSCALL_DECLARE3(syscall_stats, op, num, buf);
+
+/**
+ * Trace syscall.
+ *
+ * Start or stop recording kernel events, or move recorded events of one core
+ * into caller's memory. Events are dropped while a core's buffer is full, so
+ * drain often enough. Requires \ref CAP_CONF.
+ *
+ * @param t Current tcb.
+ * @param op Operation, see \ref sys_trace_op.
+ * @param cpu Core whose events to drain.
+ * @param buf Where to write \ref sys_trace_rec entries.
+ * @param max Maximum number of entries to write.
+ * @param e Unused.
+ *
+ * Returns \ref OK, number of entries written and number of events dropped
+ * since the last drain on success. \ref ERR_PERM if not allowed, \ref
+ * ERR_INVAL if \p op or \p cpu is invalid, \ref ERR_ADDR if \p buf isn't
+ * writable, \ref ERR_OOMEM if buffers couldn't be allocated and \ref
+ * ERR_NOINIT if the kernel was built without tracing.
+ */
+SYSCALL_DECLARE4(trace, op, cpu, buf, max);
+
+/**
+ * Hardware performance counters.
+ *
+ * @param t Current tcb.
+ * @param op Operation, see \ref sys_pmu_op.
+ * @param a Counter index for \ref PMU_INFO, slot for \ref PMU_CONFIG, \ref
+ * PMU_RELEASE and \ref PMU_READ, counter mask for \ref PMU_USER.
+ * @param b Event for \ref PMU_CONFIG, see \ref sys_pmu_event.
+ * @param d Unused.
+ * @param e Unused.
+ *
+ * \ref PMU_NUM returns \ref OK and the number of counters. \ref PMU_INFO
+ * returns \ref OK, CSR number and width of the counter. \ref PMU_CONFIG
+ * returns \ref OK and the index of the counter on the current core, \ref
+ * ERR_NF if the event can't be counted. \ref PMU_READ returns \ref OK and how
+ * many events the calling thread has caused. \ref PMU_CONFIG, \ref
+ * PMU_RELEASE and \ref PMU_USER require \ref CAP_CONF and return \ref ERR_PERM
+ * without it. Invalid input returns \ref ERR_INVAL.
+ */
+SYSCALL_DECLARE3(pmu, op, a, b);
+
+/**
+ * Sampling profiler.
+ *
+ * Start or stop taking samples of what each core is running, or move samples
+ * taken on one core into caller's memory. Samples that come due while a core
+ * is in the kernel are charged to the syscall being handled, see \ref
+ * sys_profile_rec. Samples are dropped while a core's buffer is full, so drain
+ * often enough. Requires \ref CAP_CONF.
+ *
+ * @param t Current tcb.
+ * @param op Operation, see \ref sys_profile_op.
+ * @param a Ticks between samples for \ref PROFILE_START, core whose samples
+ * to drain for \ref PROFILE_DRAIN.
+ * @param buf Where to write \ref sys_profile_rec entries.
+ * @param max Maximum number of entries to write.
+ * @param e Unused.
+ *
+ * Returns \ref OK, number of entries written and number of samples dropped
+ * since the last drain on success. \ref ERR_PERM if not allowed, \ref
+ * ERR_INVAL if \p op or \p a is invalid, \ref ERR_ADDR if \p buf isn't
+ * writable, \ref ERR_OOMEM if buffers couldn't be allocated and \ref
+ * ERR_NOINIT if the kernel was built without the profiler.
+ */
+SYSCALL_DECLARE4(profile, op, a, buf, max);
+
 /**
  * Set capabilities.
  *
@@ -827,6 +1060,25 @@ SYSCALL_DECLARE1(irq_req, id);
  */
 SYSCALL_DECLARE1(free_irq, id);
 
+/**
+ * Set IRQ affinity.
+ *
+ * Route IRQ to core \p cpu, so device interrupts can be delivered to the core
+ * that is running the driver thread instead of going through an IPI. IRQs
+ * start out routed to whichever core called \ref sys_irq_req().
+ *
+ * @param t Current tcb.
+ * @param id ID of IRQ to route, must be registered to current thread.
+ * @param cpu CPU ID of core to route IRQ to.
+ * @param c Unused.
+ * @param d Unused.
+ * @param e Unused.
+ *
+ * Returns \ref OK on success, \ref ERR_PERM if the IRQ isn't ours, \ref
+ * ERR_INVAL if \p id or \p cpu are out of range.
+ */
+SYSCALL_DECLARE2(irq_affinity, id, cpu);
+
 /**
  * Request that a thread exits, i.e. removes itself from the thread list and
  * frees all kernel data associated with thread.
@@ -854,6 +1106,25 @@ SYSCALL_DECLARE1(exit, tid);
  */
 SYSCALL_DECLARE1(detach, tid);
 
+/**
+ * Ring enter syscall.
+ *
+ * Processes up to \p count entries from the submission queue of \p ring, and
+ * writes the results to the completion queue. Only syscalls that always
+ * return to the caller are allowed in the ring, others get an \ref ERR_INVAL
+ * completion.
+ *
+ * @param t Current tcb.
+ * @param ring Address of \ref sys_ring.
+ * @param count Maximum number of entries to process.
+ * @param c Unused.
+ * @param d Unused.
+ * @param e Unused.
+ *
+ * Returns \ref OK and number of processed entries.
+ */
+SYSCALL_DECLARE2(ring_enter, ring, count);
+
 /** @} */
 
 /**
@@ -174,6 +174,36 @@ stat_t copy_uvmem(struct tcb *d, struct tcb *s);
  */
 vmflags_t sanitize_uvflags(vmflags_t flags);
 
+/**
+ * Translate user address into something the kernel can access directly.
+ *
+ * @param b Virtual memory to look in.
+ * @param v User address.
+ * @param flags Flags the page must have, in addition to \ref VM_U.
+ * @param left How many bytes are left in the page after \p v.
+ * @return Kernel address corresponding to \p v, \c 0 if \p v isn't mapped
+ * with \p flags or isn't backed by RAM.
+ */
+vm_t user_addr(struct vmem *b, vm_t v, vmflags_t flags, size_t *left);
+
+/**
+ * Copy bytes between address spaces, one page fragment at a time.
+ * Either address space can be \c NULL, in which case the corresponding address
+ * is assumed to be a kernel address. Pages are looked up with \ref
+ * stat_vpage(), so the address spaces don't have to be the currently active
+ * one.
+ *
+ * @param db Destination virtual memory.
+ * @param dst Destination address.
+ * @param sb Source virtual memory.
+ * @param src Source address.
+ * @param size How many bytes to copy.
+ * @return How many bytes were copied. Less than \p size if we ran into a page
+ * that isn't mapped or doesn't have the correct permissions.
+ */
+size_t copy_user(struct vmem *db, vm_t dst, struct vmem *sb, vm_t src,
+                 size_t size);
+
 /**
  * Handle page faults.
  * If a page fault was to some legal address, the TLB is repopulated and the
@@ -0,0 +1,59 @@
+/* SPDX-License-Identifier: copyleft-next-0.3.1 */
+/* Copyright 2024, Kim Kuparinen < kimi.h.kuparinen@gmail.com > */
+
+#ifndef KMI_WAIT_H
+#define KMI_WAIT_H
+
+/**
+ * @file wait.h
+ *
+ * Wait queues, used to implement \ref sys_wait() and \ref sys_wake().
+ * Waiters are keyed by physical address, so two processes waiting on the same
+ * shared memory page see each other regardless of where the page happens to
+ * be mapped.
+ */
+
+#include <kmi/timer.h>
+#include <kmi/types.h>
+#include <kmi/tcb.h>
+
+/** Initialize wait queues. */
+void init_waits();
+
+/**
+ * Put thread to wait on \p addr.
+ *
+ * @param t Thread to put to wait.
+ * @param addr Physical address to wait on.
+ * @param ticks Relative timeout in ticks, \c 0 means wait forever.
+ */
+void queue_wait(struct tcb *t, pm_t addr, ticks_t ticks);
+
+/**
+ * Wake up to \p n threads waiting on \p addr.
+ * Threads are woken up in the order they started waiting.
+ *
+ * @param addr Physical address to wake up threads on.
+ * @param n Maximum number of threads to wake.
+ * @return Number of threads woken up.
+ */
+size_t wake_addr(pm_t addr, size_t n);
+
+/**
+ * Timer for waiting thread expired.
+ * Called from \ref handle_timer().
+ *
+ * @param t Thread whose timer expired.
+ * @param cid ID of timer that expired.
+ */
+void wait_timeout(struct tcb *t, id_t cid);
+
+/**
+ * Remove thread from whatever wait queue it might be on and cancel its
+ * timeout, if any.
+ *
+ * @param t Thread to remove.
+ */
+void unqueue_wait(struct tcb *t);
+
+#endif /* KMI_WAIT_H */
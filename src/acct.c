@@ -0,0 +1,73 @@
+/* SPDX-License-Identifier: copyleft-next-0.3.1 */
+/* Copyright 2024, Kim Kuparinen < kimi.h.kuparinen@gmail.com > */
+
+/**
+ * @file acct.c
+ *
+ * CPU time accounting implementation. \ref acct_enter() and \ref
+ * acct_leave() only touch the current thread and the current core, so they
+ * don't need the big kernel lock.
+ */
+
+#include <kmi/sysstats.h>
+#include <kmi/profile.h>
+#include <kmi/acct.h>
+#include <kmi/trace.h>
+#include <kmi/timer.h>
+
+#include <arch/timer.h>
+
+/** When each core last crossed between user and kernel space, \c 0 if it
+ * hasn't yet. */
+static ticks_t stamps[MAX_CPUS] = { 0 };
+
+/**
+ * Get time since last crossing on core of \p t and start a new period.
+ *
+ * @param t Current thread.
+ * @return Ticks since last crossing, \c 0 if this is the first one.
+ */
+static ticks_t __period(struct tcb *t)
+{
+	ticks_t now = current_ticks();
+	ticks_t prev = stamps[t->cpu_id];
+	stamps[t->cpu_id] = now;
+
+	if (!prev)
+		return 0;
+
+	return now - prev;
+}
+
+void acct_enter(struct tcb *t)
+{
+	ticks_t d = __period(t);
+	if (t->pid == t->rid)
+		t->acct.s.user += d;
+	else
+		t->acct.s.rpc += d;
+
+	profile_enter(t);
+}
+
+void acct_leave(struct tcb *t)
+{
+	ticks_t d = __period(t);
+	t->acct.s.kernel += d;
+	sysstats_leave(t, d);
+	trace(TRACE_RETURN, 0, 0);
+	profile_leave(t);
+}
+
+void acct_migrate(struct tcb *t)
+{
+	unsigned long long d = t->acct.s.rpc - t->acct.mark;
+	t->acct.mark = t->acct.s.rpc;
+
+	if (t->pid == t->rid)
+		return;
+
+	struct tcb *p = get_tcb(t->pid);
+	if (p)
+		p->acct.s.served += d;
+}
@@ -12,7 +12,11 @@
 #include <kmi/bits.h>
 #include <kmi/vmem.h>
 #include <kmi/pmem.h>
+#include <kmi/atomic.h>
+#include <kmi/lock.h>
 #include <arch/vmem.h>
+#include <arch/cpu.h>
+#include <arch/smp.h>
 #include <libfdt.h>
 #include <stdarg.h>
 
@@ -29,6 +33,10 @@ struct dbg_info {
 	enum serial_dev dev;
 	/** Physical address of serial device. */
 	pm_t addr;
+	/** Interrupt of serial device, \c 0 if it doesn't have one. */
+	irq_t irq;
+	/** How many bytes can be written once transmitter is empty. */
+	size_t fifo;
 };
 
 /** Static debugging information. */
@@ -36,6 +44,9 @@ static struct dbg_info dbg_info = (struct dbg_info){ 0 };
 
 /* forward declarations. */
 static struct dbg_info __dbg_from_fdt(const void *fdt);
+#if defined(DEFERRED_LOG)
+static void __dlog_stop();
+#endif
 
 void init_dbg(const void *fdt)
 {
@@ -103,6 +114,60 @@ vm_t map_io_dbg(struct vmem *b)
 /** Line status error in RCVR FIFO. */
 #define LSR_ERR (1 << 7)
 
+/** Interrupt enable transmitter holding register empty. */
+#define IER_ETBEI (1 << 1)
+
+/** Interrupt identification FIFOs enabled. */
+#define IIR_FIFO (3 << 6)
+
+/** Modem control OUT2, gates the interrupt line on PC style UARTs. */
+#define MCR_OUT2 (1 << 3)
+
+/** Size of 16550 transmit FIFO. */
+#define UART_8250_FIFO 16
+
+/** Size of transmit buffer. */
+#define TX_SIZE 4096
+
+/** Transmit buffer. Once the serial interrupt is up, output is written here
+ * and drained from the interrupt handler so printing doesn't have to wait
+ * on the serial lines. */
+static struct {
+	/** Lock held while printing a message. Doubles as keeping messages from
+	 * different cores from getting mixed up. */
+	spinlock_t lock;
+
+	/** Whether output goes through the buffer. */
+	bool buffered;
+
+	/** Whether transmitter interrupt is enabled. */
+	bool irq_on;
+
+	/** Set when panicking. Output then skips both the buffer and the
+	 * lock, since whoever holds the lock might never release it. */
+	bool panic;
+
+	/** Number of bytes ever written to buffer. */
+	size_t head;
+
+	/** Number of bytes ever written out to serial device. */
+	size_t tail;
+
+	/** Buffer itself. */
+	char buf[TX_SIZE];
+} tx = { 0 };
+
+/**
+ * Get 8250 register.
+ *
+ * @param reg Register index.
+ * @return Pointer to register.
+ */
+static volatile uint8_t *__8250_reg(size_t reg)
+{
+	return (uint8_t *)dbg_info.base + (reg << dbg_info.shift);
+}
+
 /**
  * 8250 transmitter empty.
  *
@@ -110,9 +175,7 @@ vm_t map_io_dbg(struct vmem *b)
  */
 static int __8250_tx_empty()
 {
-	volatile uint8_t *lsr = (uint8_t *)dbg_info.base +
-	                        (UART_8250_LSR << dbg_info.shift);
-	return (*lsr) & LSR_THRE;
+	return *__8250_reg(UART_8250_LSR) & LSR_THRE;
 }
 
 /**
@@ -128,9 +191,57 @@ static void __8250_putchar(char c)
 	while (__8250_tx_empty() == 0)
 		;
 
-	volatile uint8_t *data = (uint8_t *)dbg_info.base +
-	                         (UART_8250_DATA << dbg_info.shift);
-	*data = c;
+	*__8250_reg(UART_8250_DATA) = c;
+}
+
+/**
+ * Move bytes from transmit buffer to 8250.
+ * Only writes as much as fits into the FIFO, and leaves the transmitter
+ * interrupt on for as long as there's something left in the buffer. Caller
+ * should hold \ref tx lock.
+ */
+static void __8250_fill()
+{
+	if (!dbg_info.base)
+		return;
+
+	if (__8250_tx_empty()) {
+		volatile uint8_t *data = __8250_reg(UART_8250_DATA);
+		for (size_t i = 0; i < dbg_info.fifo && tx.tail != tx.head; ++i)
+			*data = tx.buf[tx.tail++ % TX_SIZE];
+	}
+
+	bool on = tx.tail != tx.head;
+	if (on == tx.irq_on)
+		return;
+
+	volatile uint8_t *ier = __8250_reg(UART_8250_IRQ);
+	*ier = on ? *ier | IER_ETBEI : *ier & ~IER_ETBEI;
+	tx.irq_on = on;
+}
+
+/**
+ * Write out everything in transmit buffer, waiting on the serial lines as
+ * long as it takes. Caller should hold \ref tx lock.
+ */
+static void __8250_drain()
+{
+	while (tx.tail != tx.head)
+		__8250_putchar(tx.buf[tx.tail++ % TX_SIZE]);
+}
+
+/**
+ * Put character into transmit buffer.
+ * If the buffer is full, fall back to waiting on the serial lines.
+ *
+ * @param c Character to put.
+ */
+static void __8250_push(char c)
+{
+	if (tx.head - tx.tail == TX_SIZE)
+		__8250_drain();
+
+	tx.buf[tx.head++ % TX_SIZE] = c;
 }
 
 /**
@@ -145,8 +256,104 @@ static void __putchar(char c)
 		__putchar('\r');
 
 	switch (dbg_info.dev) {
-	case UART_8250: __8250_putchar(c); return;
+	case UART_8250:
+		if (tx.buffered && !atomic_load(&tx.panic))
+			__8250_push(c);
+		else
+			__8250_putchar(c);
+		return;
+	}
+}
+
+/** Start writing out whatever was just put into the transmit buffer. */
+static void __kick()
+{
+	if (!tx.buffered || atomic_load(&tx.panic))
+		return;
+
+	switch (dbg_info.dev) {
+	case UART_8250: __8250_fill(); return;
+	}
+}
+
+irq_t dbg_irq()
+{
+	return dbg_info.irq;
+}
+
+void enable_dbg_irq()
+{
+	switch (dbg_info.dev) {
+	case UART_8250:
+		if (!dbg_info.base)
+			return;
+
+		/* reading IIR also clears a pending transmitter interrupt, but
+		 * that's fine as we haven't enabled it yet */
+		if ((*__8250_reg(UART_8250_IRQ_ID) & IIR_FIFO) == IIR_FIFO)
+			dbg_info.fifo = UART_8250_FIFO;
+
+		*__8250_reg(UART_8250_MCR) |= MCR_OUT2;
+		break;
+	}
+
+	spin_lock(&tx.lock);
+	tx.buffered = true;
+	spin_unlock(&tx.lock);
+}
+
+void handle_dbg_irq()
+{
+	spin_lock(&tx.lock);
+	__kick();
+	spin_unlock(&tx.lock);
+}
+
+/** Write out buffer and go back to synchronous output. Caller should hold
+ * \ref tx lock. */
+static void __sync()
+{
+	if (!tx.buffered)
+		return;
+
+	switch (dbg_info.dev) {
+	case UART_8250:
+		__8250_drain();
+		/* turns off the interrupt */
+		__8250_fill();
+		break;
+	}
+
+	tx.buffered = false;
+}
+
+void dbg_sync()
+{
+#if defined(DEFERRED_LOG)
+	__dlog_stop();
+#endif
+	spin_lock(&tx.lock);
+	__sync();
+	spin_unlock(&tx.lock);
+#if defined(DEFERRED_LOG)
+	__dlog_stop();
+#endif
+}
+
+void dbg_panic()
+{
+	/* we might've panicked while printing, or some other core might be in
+	 * the middle of printing, so don't touch the lock at all. Write out
+	 * what's buffered and bypass the buffer from now on. Might mess up
+	 * whatever some other core is printing but at least we get our message
+	 * out. */
+	atomic_store(&tx.panic, true);
+	switch (dbg_info.dev) {
+	case UART_8250: __8250_drain(); break;
 	}
+#if defined(DEFERRED_LOG)
+	__dlog_stop();
+#endif
 }
 
 /**
@@ -211,9 +418,18 @@ static struct dbg_info __dbg_from_fdt(const void *fdt)
 	if (shift_ptr)
 		shift = (size_t)fdt_load_int32_ptr(shift_ptr);
 
+	/* get serial device interrupt if present, first cell is the ID with
+	 * both the PLIC and APLIC */
+	irq_t irq = 0;
+	const void *irq_ptr = fdt_getprop(fdt, stdout_offset, "interrupts",
+	                                  NULL);
+
+	if (irq_ptr)
+		irq = (irq_t)fdt_load_int32_ptr(irq_ptr);
+
 	/* while in direct map, base == addr, and this changes only when we jump
 	 * into virtually mapped io */
-	return (struct dbg_info){ dbg_ptr, shift, dev, dbg_ptr };
+	return (struct dbg_info){ dbg_ptr, shift, dev, dbg_ptr, irq, 1 };
 }
 
 /** Printf formatting left align flag. */
@@ -258,6 +474,39 @@ static struct dbg_info __dbg_from_fdt(const void *fdt)
 /** Printf padding flag. */
 #define PAD_FLAG (1 << 14)
 
+/** Where \ref __format() reads its arguments from. */
+struct dbg_args {
+	/** Variable arguments of \ref dbg(), used when \ref raw is \c NULL. */
+	va_list *vl;
+
+	/** Arguments stored by deferred logging. */
+	const unsigned long long *raw;
+
+	/** Index of next argument in \ref raw. */
+	size_t i;
+};
+
+/**
+ * Get next integer argument.
+ *
+ * @param a Arguments, \ref dbg_args.
+ * @param type Type of argument.
+ * @return Next argument.
+ */
+#define __arg(a, type) \
+	((a)->raw ? (type)(a)->raw[(a)->i++] : va_arg(*(a)->vl, type))
+
+/**
+ * Get next pointer argument.
+ *
+ * @param a Arguments, \ref dbg_args.
+ * @param type Type of argument.
+ * @return Next argument.
+ */
+#define __arg_ptr(a, type) \
+	((a)->raw ? (type)(uintptr_t)(a)->raw[(a)->i++] \
+	          : va_arg(*(a)->vl, type))
+
 /** Printf continue flag. */
 #define CONT 1
 
@@ -291,6 +540,20 @@ static int __atoi(const char *s)
 	return i;
 }
 
+/**
+ * Skip past number in string.
+ *
+ * @param s Number string.
+ * @return Pointer to first non-digit character.
+ */
+static const char *__skip_digits(const char *s)
+{
+	while (__is_digit(*s))
+		s++;
+
+	return s;
+}
+
 /**
  * Calculate signed char from value using type interpretation.
  *
@@ -528,7 +791,13 @@ static size_t __print_integral(ssize_t value, size_t base, size_t flags,
 	return ret;
 }
 
-void dbg(const char *fmt, ...)
+/**
+ * Format and print out a message.
+ *
+ * @param fmt Format string, see \ref dbg().
+ * @param args Where to read arguments from.
+ */
+static void __format(const char *fmt, struct dbg_args *args)
 {
 	/* largely inspired by
 	 * https://github.com/mpaland/printf/blob/master/printf.c
@@ -536,9 +805,6 @@ void dbg(const char *fmt, ...)
 
 	/* Note that X is binary formatting, because who uses uppercase hex? */
 
-	va_list vl;
-	va_start(vl, fmt);
-
 	size_t chars_written = 0;
 
 	while (*fmt) {
@@ -607,10 +873,11 @@ void dbg(const char *fmt, ...)
 		/* check width */
 		size_t width = 0;
 		if (__is_digit(*fmt)) {
-			width = __atoi(fmt++);
+			width = __atoi(fmt);
+			fmt = __skip_digits(fmt);
 			set_bit(flags, WIDTH_FLAG | PAD_FLAG | SPACE_FLAG);
 		} else if (*fmt == '*') {
-			int w = va_arg(vl, int);
+			int w = __arg(args, int);
 			if (w < 0) {
 				width = -w;
 				set_bit(flags, LEFT_FLAG);
@@ -627,9 +894,10 @@ void dbg(const char *fmt, ...)
 			fmt++;
 			set_bit(flags, PRECS_FLAG | PAD_FLAG | ZERO_FLAG);
 			if (__is_digit(*fmt)) {
-				precision = __atoi(fmt++);
+				precision = __atoi(fmt);
+				fmt = __skip_digits(fmt);
 			} else if (*fmt == '*') {
-				precision = va_arg(vl, int);
+				precision = __arg(args, int);
 				fmt++;
 			}
 		}
@@ -729,11 +997,11 @@ void dbg(const char *fmt, ...)
 			}
 
 			if (is_set(flags, LLONG_FLAG))
-				value = va_arg(vl, long long);
+				value = __arg(args, long long);
 			else if (is_set(flags, LONG_FLAG))
-				value = va_arg(vl, long);
+				value = __arg(args, long);
 			else
-				value = va_arg(vl, int);
+				value = __arg(args, int);
 
 			chars_written +=
 				__print_integral(value, base, flags, width);
@@ -741,14 +1009,14 @@ void dbg(const char *fmt, ...)
 			break;
 
 		case 'c':
-			c = va_arg(vl, int);
+			c = __arg(args, int);
 			__putchar(c);
 			chars_written++;
 			fmt++;
 			break;
 
 		case 's':
-			s = va_arg(vl, const char *);
+			s = __arg_ptr(args, const char *);
 
 			if (is_set(flags, PRECS_FLAG))
 				i = precision;
@@ -761,7 +1029,7 @@ void dbg(const char *fmt, ...)
 			break;
 
 		case 'p':
-			p = va_arg(vl, void *);
+			p = __arg_ptr(args, void *);
 			set_bit(flags, UNSIGN_FLAG | HASH_FLAG);
 
 			if (sizeof(void *) == sizeof(long))
@@ -775,13 +1043,319 @@ void dbg(const char *fmt, ...)
 			break;
 
 		case 'n':
-			n = va_arg(vl, int *);
-			*n = chars_written;
+			n = __arg_ptr(args, int *);
+			/* whatever n pointed to is likely long gone by the time a
+			 * deferred message is formatted */
+			if (!args->raw)
+				*n = chars_written;
+			fmt++;
+			break;
+		}
+	}
+}
+
+/**
+ * Format and print out message as one unit.
+ *
+ * @param fmt Format string.
+ * @param args Where to read arguments from.
+ */
+static void __print(const char *fmt, struct dbg_args *args)
+{
+	if (atomic_load(&tx.panic)) {
+		__format(fmt, args);
+		return;
+	}
+
+	spin_lock(&tx.lock);
+	__format(fmt, args);
+	__kick();
+	spin_unlock(&tx.lock);
+}
+
+#if defined(DEFERRED_LOG)
+
+/** Maximum number of arguments a deferred message can have. */
+#define DLOG_ARGS 8
+
+/** Number of deferred messages each core can hold. */
+#define DLOG_RECORDS 64
+
+/** One deferred message. */
+struct dlog_rec {
+	/** Format string. */
+	const char *fmt;
+
+	/** Raw arguments, each widened to 64 bits. */
+	unsigned long long args[DLOG_ARGS];
+};
+
+/** Deferred messages of one core. */
+struct dlog {
+	/** Number of messages ever written. */
+	size_t head;
+
+	/** Number of messages ever printed. */
+	size_t tail;
+
+	/** Ring of messages. */
+	struct dlog_rec recs[DLOG_RECORDS];
+};
+
+/** Deferred messages of each core. Only ever touched by the core itself, so
+ * no locking needed. */
+static struct dlog dlogs[MAX_CPUS];
+
+/** Number of cores that have called \ref dbg_defer(). */
+static size_t dlog_online = 0;
+
+/** Set when powering off or panicking, after which nothing is deferred. */
+static bool dlog_stopped = false;
+
+/**
+ * Check if messages should be deferred.
+ * While cores are still being brought up, \ref cpu_id() isn't reliable on all
+ * of them, so print everything directly until every core has a thread.
+ *
+ * @return \c true if messages should be deferred, \c false otherwise.
+ */
+static bool __dlog_active()
+{
+	return !atomic_load_explicit(&dlog_stopped, memory_order_acquire)
+	       && atomic_load_explicit(&dlog_online, memory_order_acquire)
+	       == smp_cpus();
+}
+
+/**
+ * Print out all deferred messages.
+ *
+ * @param l Deferred messages of current core.
+ */
+static void __dlog_drain(struct dlog *l)
+{
+	while (l->tail != l->head) {
+		struct dlog_rec *r = &l->recs[l->tail % DLOG_RECORDS];
+		struct dbg_args a = { .raw = r->args };
+		__print(r->fmt, &a);
+		l->tail++;
+	}
+}
+
+/**
+ * Store one argument, helper for \ref __dlog_collect().
+ * Bails out if there are more than \ref DLOG_ARGS arguments.
+ *
+ * @param x Argument to store.
+ */
+#define __dlog_store(x)                \
+	do {                           \
+		if (n == DLOG_ARGS)    \
+			return false;  \
+		args[n++] = (x);       \
+	} while (0)
+
+/**
+ * Copy arguments out of variable argument list.
+ * Walks the format string the same way \ref __format() does, but only to
+ * figure out how many arguments there are and how large each one is.
+ *
+ * @param fmt Format string.
+ * @param vl Variable argument list.
+ * @param args Where to store arguments.
+ * @return \c true if arguments fit in \p args, \c false otherwise.
+ */
+static bool __dlog_collect(const char *fmt, va_list *vl,
+                           unsigned long long *args)
+{
+	size_t n = 0;
+	while (*fmt) {
+		if (*fmt++ != '%')
+			continue;
+
+		if (*fmt == '%') {
+			fmt++;
+			continue;
+		}
+
+		while (*fmt == ' ' || *fmt == '-' || *fmt == '+'
+		       || *fmt == '#' || *fmt == '0' || *fmt == '\'')
+			fmt++;
+
+		if (*fmt == '*') {
+			__dlog_store(va_arg(*vl, int));
+			fmt++;
+		} else {
+			fmt = __skip_digits(fmt);
+		}
+
+		if (*fmt == '.') {
+			fmt++;
+			if (*fmt == '*') {
+				__dlog_store(va_arg(*vl, int));
+				fmt++;
+			} else {
+				fmt = __skip_digits(fmt);
+			}
+		}
+
+		size_t flags = 0;
+		switch (*fmt) {
+		case 'l':
+			fmt++;
+			if (*fmt == 'l') {
+				set_bit(flags, LLONG_FLAG);
+				fmt++;
+			} else {
+				set_bit(flags, LONG_FLAG);
+			}
+			break;
+
+		case 'h':
+			fmt++;
+			if (*fmt == 'h')
+				fmt++;
+			break;
+
+		case 'j':
+			fmt++;
+			if (sizeof(intmax_t) == sizeof(long))
+				set_bit(flags, LONG_FLAG);
+			else
+				set_bit(flags, LLONG_FLAG);
+			break;
+
+		case 'z':
+			fmt++;
+			if (sizeof(size_t) == sizeof(long))
+				set_bit(flags, LONG_FLAG);
+			else
+				set_bit(flags, LLONG_FLAG);
+			break;
+
+		case 't':
+			fmt++;
+			if (sizeof(ptrdiff_t) == sizeof(long))
+				set_bit(flags, LONG_FLAG);
+			else
+				set_bit(flags, LLONG_FLAG);
+			break;
+		}
+
+		switch (*fmt) {
+		case 'd':
+		case 'i':
+		case 'u':
+		case 'x':
+		case 'X':
+		case 'o':
+		case 'b':
+			if (is_set(flags, LLONG_FLAG))
+				__dlog_store(va_arg(*vl, long long));
+			else if (is_set(flags, LONG_FLAG))
+				__dlog_store(va_arg(*vl, long));
+			else
+				__dlog_store(va_arg(*vl, int));
+
+			fmt++;
+			break;
+
+		case 'c':
+			__dlog_store(va_arg(*vl, int));
+			fmt++;
+			break;
+
+		case 's':
+		case 'p':
+		case 'n':
+			__dlog_store((uintptr_t)va_arg(*vl, void *));
 			fmt++;
 			break;
 		}
 	}
 
+	return true;
+}
+
+/**
+ * Try to defer message.
+ *
+ * @param fmt Format string.
+ * @param vl Arguments of message.
+ * @return \c true if message was deferred, \c false if it should be printed
+ * right away.
+ */
+static bool __dlog_push(const char *fmt, va_list *vl)
+{
+	if (!__dlog_active())
+		return false;
+
+	struct dlog *l = &dlogs[cpu_id()];
+
+	/* rather than drop messages, take the hit of printing out everything
+	 * right now */
+	if (l->head - l->tail == DLOG_RECORDS)
+		__dlog_drain(l);
+
+	struct dlog_rec *r = &l->recs[l->head % DLOG_RECORDS];
+	if (!__dlog_collect(fmt, vl, r->args)) {
+		/* keep messages in order */
+		__dlog_drain(l);
+		return false;
+	}
+
+	r->fmt = fmt;
+	l->head++;
+	return true;
+}
+
+void dbg_defer()
+{
+	atomic_fetch_add_explicit(&dlog_online, 1, memory_order_acq_rel);
+}
+
+void dbg_flush()
+{
+	if (!__dlog_active())
+		return;
+
+	struct dlog *l = &dlogs[cpu_id()];
+	if (l->tail != l->head)
+		__dlog_drain(l);
+}
+
+/**
+ * Stop deferring messages and print out whatever every core has deferred so
+ * far. Other cores might still be running, so this is best effort, but losing
+ * their last messages on shutdown or panic is worse.
+ */
+static void __dlog_stop()
+{
+	atomic_store_explicit(&dlog_stopped, true, memory_order_release);
+	for (size_t i = 0; i < MAX_CPUS; ++i)
+		__dlog_drain(&dlogs[i]);
+}
+
+#endif /* DEFERRED_LOG */
+
+void dbg(const char *fmt, ...)
+{
+	va_list vl;
+	va_start(vl, fmt);
+
+#if defined(DEFERRED_LOG)
+	va_list cp;
+	va_copy(cp, vl);
+	bool deferred = __dlog_push(fmt, &cp);
+	va_end(cp);
+
+	if (deferred) {
+		va_end(vl);
+		return;
+	}
+#endif
+
+	struct dbg_args a = { .vl = &vl };
+	__print(fmt, &a);
 	va_end(vl);
 }
 
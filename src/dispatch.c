@@ -1,7 +1,9 @@
 /* SPDX-License-Identifier: copyleft-next-0.3.1 */
 /* Copyright 2023 Kim Kuparinen < kimi.h.kuparinen@gmail.com > */
 
+#include <kmi/debug.h>
 #include <kmi/uapi.h>
+#include <kmi/acct.h>
 #include <kmi/bkl.h>
 #include <kmi/ipi.h>
 
@@ -32,7 +34,15 @@
 void dispatch(sys_arg_t a, sys_arg_t b, sys_arg_t c,
               sys_arg_t d, sys_arg_t e, sys_arg_t f)
 {
+	/* syscall arguments are still in registers at this point, so do entry
+	 * accounting here instead of in entry.S */
+	struct tcb *t = cur_tcb();
+	acct_enter(t);
+
 	bkl_lock();
-	handle_syscall(a, b, c, d, e, f, cur_tcb());
+	handle_syscall(a, b, c, d, e, f, t);
 	bkl_unlock();
+
+	/* print out deferred messages without holding up other cores */
+	dbg_flush();
 }
@@ -2,6 +2,8 @@
 /* Copyright 2023 Kim Kuparinen < kimi.h.kuparinen@gmail.com > */
 
 #include <kmi/notify.h>
+#include <kmi/atomic.h>
+#include <kmi/kdata.h>
 #include <kmi/queue.h>
 #include <kmi/bkl.h>
 #include <kmi/ipi.h>
@@ -9,44 +11,169 @@
 #include <arch/proc.h>
 #include <arch/cpu.h>
 
-/** List for keeping track of which threads have an ipi queued. */
-static struct queue_head fifo = INIT_QUEUE(fifo);
-
 /**
  * @file ipi.c
  *
  * IPI function implementations.
+ *
+ * Each CPU has its own multi-producer single-consumer queue of threads waiting
+ * for an IPI. Producers push onto a lock-free singly linked inbox, and the CPU
+ * owning the queue moves the whole inbox into a local queue in one go when it
+ * gets around to handling the IPI. Anything touching the local queue does so
+ * with the BKL held.
+ *
+ * A bit in \ref pending is set for each CPU that has an IPI in flight, so any
+ * number of sends to one CPU before it handles them costs one interrupt.
+ */
+
+#if MAX_CPUS > 32
+#error "MAX_CPUS doesn't fit into pending IPI bitmap"
+#endif
+
+/** Per-CPU IPI queue. */
+struct ipi_queue {
+	/** Threads pushed by other CPUs, newest first. */
+	struct tcb *inbox;
+
+	/** Threads moved out of \ref inbox, oldest first. */
+	struct queue_head local;
+};
+
+/** IPI queues, one for each CPU. */
+static struct ipi_queue queues[MAX_CPUS];
+
+/** Bitmap of CPUs with an IPI in flight. */
+static unsigned long pending = 0;
+
+void init_ipis()
+{
+	for (size_t i = 0; i < MAX_CPUS; ++i)
+		queues[i].local = (struct queue_head)INIT_QUEUE(queues[i].local);
+}
+
+/**
+ * Push thread onto inbox of CPU.
+ *
+ * @param q Queue of CPU.
+ * @param t Thread to push.
+ */
+static void __inbox_push(struct ipi_queue *q, struct tcb *t)
+{
+	struct tcb *head = atomic_load_explicit(&q->inbox,
+	                                        memory_order_relaxed);
+	do {
+		t->ipi.next = head;
+	} while (!atomic_compare_exchange_weak_explicit(&q->inbox, &head, t,
+	                                                memory_order_release,
+	                                                memory_order_relaxed));
+}
+
+/**
+ * Move everything in inbox of CPU into its local queue, preserving the order
+ * they were pushed in.
+ *
+ * @param q Queue of CPU.
+ */
+static void __inbox_drain(struct ipi_queue *q)
+{
+	struct tcb *t = atomic_exchange_explicit(&q->inbox, NULL,
+	                                         memory_order_acquire);
+
+	/* inbox is newest first, so flip it around */
+	struct tcb *rev = NULL;
+	while (t) {
+		struct tcb *next = t->ipi.next;
+		t->ipi.next = rev;
+		rev = t;
+		t = next;
+	}
+
+	for (t = rev; t; t = t->ipi.next)
+		queue_push(&t->ipi.q, &q->local);
+}
+
+/**
+ * Mark IPI pending for CPU and send it one if there wasn't one already.
+ *
+ * @param cpu CPU to kick.
  */
+static void __kick(id_t cpu)
+{
+	unsigned long bit = 1UL << cpu;
+	if (atomic_fetch_or_explicit(&pending, bit, memory_order_acq_rel) & bit)
+		return;
+
+	cpu_send_ipi(cpu);
+}
 
 void send_ipi(struct tcb *t)
 {
-	/** @todo this should probably have a spinlock guard */
-	/** @todo killing a thread should make sure it gets removed from ipi
-	 * queue */
-	queue_push(&fifo, &t->ipi_queue);
-	cpu_send_ipi(t->cpu_id);
+	/* already queued somewhere, whoever handles it will resend if needed */
+	if (atomic_exchange_explicit(&t->ipi.queued, true,
+	                             memory_order_acq_rel))
+		return;
+
+	id_t cpu = t->cpu_id;
+	t->ipi.cpu = cpu;
+	__inbox_push(&queues[cpu], t);
+	__kick(cpu);
+}
+
+void clear_ipi(struct tcb *t)
+{
+	adjust_ipi(t);
+
+	/* a real IPI might've been sent at the same time, so if one is marked
+	 * pending make sure it isn't lost */
+	atomic_thread_fence(memory_order_seq_cst);
+	id_t cpu = cpu_id();
+	if (atomic_load_explicit(&pending, memory_order_acquire) & (1UL << cpu))
+		cpu_send_ipi(cpu);
 }
 
 void unqueue_ipi(struct tcb *t)
 {
-	queue_del(&t->ipi_queue);
+	if (!atomic_load_explicit(&t->ipi.queued, memory_order_acquire))
+		return;
+
+	/* we're holding the BKL, so we're free to play consumer for whichever
+	 * CPU the thread was queued on */
+	struct ipi_queue *q = &queues[t->ipi.cpu];
+	__inbox_drain(q);
+	queue_del(&t->ipi.q);
+	atomic_store_explicit(&t->ipi.queued, false, memory_order_release);
 }
 
 void handle_ipi()
 {
 	bkl_lock();
+	kdata_cpu()->ipis++;
 
 	struct tcb *t = cur_tcb();
 	adjust_ipi(t);
 
-	struct queue_head *q = queue_pop(&fifo);
-	if (!q) {
-		bkl_unlock();
-		return;
+	/* clear pending before draining, so anything pushed after the drain
+	 * sends a new IPI */
+	id_t cpu = cpu_id();
+	atomic_fetch_and_explicit(&pending, ~(1UL << cpu), memory_order_acq_rel);
+
+	struct ipi_queue *q = &queues[cpu];
+	__inbox_drain(q);
+
+	struct queue_head *e;
+	while ((e = queue_pop(&q->local))) {
+		struct tcb *r = container_of(e, struct tcb, ipi.q);
+		atomic_store_explicit(&r->ipi.queued, false,
+		                      memory_order_release);
+
+		/* running a notification doesn't return, so make sure we get
+		 * back here for whatever's left */
+		if (!queue_empty(&q->local))
+			__kick(cpu);
+
+		notify(r, 0);
 	}
 
-	struct tcb *r = container_of(q, struct tcb, ipi_queue);
-	notify(r, 0);
 	/* notify didn't take for whatever reason so return whence we came from */
 	bkl_unlock();
 }
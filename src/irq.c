@@ -10,10 +10,14 @@
 #include <kmi/bkl.h>
 #include <kmi/pmem.h>
 #include <kmi/debug.h>
+#include <kmi/kdata.h>
+#include <kmi/trace.h>
 #include <kmi/assert.h>
 #include <kmi/notify.h>
 #include <kmi/string.h>
 #include <arch/irq.h>
+#include <arch/smp.h>
+#include <arch/cpu.h>
 
 /** Hold maximum IRQ id supported by system. */
 static size_t max_irq;
@@ -21,14 +25,31 @@ static size_t max_irq;
 /** Hold map of IRD ID -> thread id. @todo process id? */
 static id_t *irq_map;
 
+/** Marks IRQ as handled by the kernel itself in \ref irq_map. */
+#define IRQ_KERNEL ((id_t)-1)
+
 void init_irq(void *fdt)
 {
-	/** @todo check arch max irq and adjust accordingly */
-	irq_map = (id_t *)alloc_page(MM_O0);
-	memset(irq_map, 0, order_size(MM_O0));
-	max_irq = order_size(MM_O0) / sizeof(irq_map[0]);
-
 	setup_irq(fdt);
+
+	/* IMSICs can have a couple thousand identities, so the map might not
+	 * fit into a single base page */
+	size_t size = irq_sources() * sizeof(irq_map[0]);
+	enum mm_order order = MM_O0;
+	while (order_size(order) < size && order < max_order())
+		order++;
+
+	irq_map = (id_t *)alloc_page(order);
+	memset(irq_map, 0, order_size(order));
+	max_irq = order_size(order) / sizeof(irq_map[0]);
+
+	/* we're still on the boot core, which is always 0, but cur_tcb() isn't
+	 * set up yet so cpu_id() wouldn't work */
+	irq_t dirq = dbg_irq();
+	if (dirq && dirq < max_irq && !activate_irq(dirq, 0)) {
+		irq_map[dirq] = IRQ_KERNEL;
+		enable_dbg_irq();
+	}
 }
 
 stat_t register_irq(struct tcb *t, irq_t id)
@@ -39,12 +60,21 @@ stat_t register_irq(struct tcb *t, irq_t id)
 	if (irq_map[id])
 		return ERR_EXT;
 
+	/* default to whichever core the driver is running on, it's likely to
+	 * stay there */
+	stat_t r = activate_irq(id, cpu_id());
+	if (r)
+		return r;
+
 	irq_map[id] = t->tid;
-	return activate_irq(id);
+	return OK;
 }
 
 stat_t unregister_irq(struct tcb *t, irq_t id)
 {
+	if (id >= max_irq)
+		return ERR_INVAL;
+
 	id_t tid = irq_map[id];
 	if (tid != t->tid)
 		return ERR_PERM;
@@ -53,17 +83,53 @@ stat_t unregister_irq(struct tcb *t, irq_t id)
 	return deactivate_irq(id);
 }
 
+stat_t set_irq_affinity(struct tcb *t, irq_t id, id_t cpu)
+{
+	if (id >= max_irq)
+		return ERR_INVAL;
+
+	if (irq_map[id] != t->tid)
+		return ERR_PERM;
+
+	if (cpu < 0 || (size_t)cpu >= smp_cpus())
+		return ERR_INVAL;
+
+	return activate_irq(id, cpu);
+}
+
 void handle_irq()
 {
 	bkl_lock();
+	kdata_cpu()->irqs++;
 
+	/* some other core might've claimed it already */
 	irq_t id = get_irq();
+	if (!id) {
+		bkl_unlock();
+		return;
+	}
+
+	trace(TRACE_IRQ, id, 0);
+
 	assert(id < max_irq);
 
 	id_t tid = irq_map[id];
+	if (tid == IRQ_KERNEL) {
+		handle_dbg_irq();
+		complete_irq(id);
+		bkl_unlock();
+		return;
+	}
+
+	/* completing right away lets the source fire again, but the owner is
+	 * notified with irqs disabled on this core so we won't see it again
+	 * until the notification has been handled */
+	complete_irq(id);
 
 	if (!tid) {
 		bug("unregistered irq %llu\n", (unsigned long long)id);
+		deactivate_irq(id);
+		bkl_unlock();
 		return;
 	}
 
@@ -75,6 +141,7 @@ void handle_irq()
 
 		/* unregister irq handler */
 		irq_map[id] = 0;
+		deactivate_irq(id);
 		bkl_unlock();
 		return;
 	}
@@ -0,0 +1,148 @@
+/* SPDX-License-Identifier: copyleft-next-0.3.1 */
+/* Copyright 2024, Kim Kuparinen < kimi.h.kuparinen@gmail.com > */
+
+/**
+ * @file kdata.c
+ *
+ * Kernel data page implementation. All writes happen with the big kernel lock
+ * held, so the sequence lock is only there for readers in userspace.
+ */
+
+#include <kmi/string.h>
+#include <kmi/atomic.h>
+#include <kmi/kdata.h>
+#include <kmi/timer.h>
+#include <kmi/pmem.h>
+#include <kmi/conf.h>
+#include <kmi/tcb.h>
+#include <kmi/mem.h>
+
+#include <arch/timer.h>
+#include <arch/vmem.h>
+#include <arch/cpu.h>
+
+#if MAX_CPUS > KDATA_CPUS
+#error "MAX_CPUS doesn't fit into kernel data page"
+#endif
+
+/** Kernel data page, \c NULL until \ref init_kdata() is done. */
+static struct sys_kdata *kdata = NULL;
+
+/** Counters used before the kernel data page exists. */
+static struct sys_kdata_cpu dummy_cpu;
+
+/** Start updating kernel data page. */
+static void __kdata_begin()
+{
+	kdata->seq++;
+	atomic_thread_fence(memory_order_release);
+}
+
+/** Finish updating kernel data page. */
+static void __kdata_end()
+{
+	atomic_thread_fence(memory_order_release);
+	kdata->seq++;
+}
+
+stat_t init_kdata()
+{
+#if !defined(KDATA_ADDR)
+	/* arch has nowhere to map the page (Sv32 kvmem is already a leaf
+	 * table), so run without it. Per-core counters go to dummy_cpu and
+	 * everything else is a no-op. */
+	return OK;
+#else
+	pm_t page = alloc_page(BASE_PAGE);
+	if (!page)
+		return ERR_OOMEM;
+
+	struct sys_kdata *k = (struct sys_kdata *)page;
+	memset(k, 0, BASE_PAGE_SIZE);
+
+	k->timebase = secs_to_ticks(1);
+	k->ticks = current_ticks();
+	k->cpus = 1;
+
+	size_t orders = max_order() + 1;
+	if (orders > KDATA_ORDERS)
+		orders = KDATA_ORDERS;
+
+	k->orders = orders;
+	for (size_t i = 0; i < orders; ++i)
+		k->page_size[i] = order_size(i);
+
+	k->ram_size = get_ram_size();
+	k->ram_usage = query_used();
+	k->max_threads = max_tcbs();
+	k->thread_stack = thread_stack_size();
+	k->rpc_stack = rpc_stack_size();
+
+	stat_t r = map_kdata(page);
+	if (r) {
+		free_page(BASE_PAGE, page);
+		return r;
+	}
+
+	kdata = k;
+	return OK;
+#endif
+}
+
+void kdata_set_cpus(size_t cpus)
+{
+	if (!kdata)
+		return;
+
+	__kdata_begin();
+	kdata->cpus = cpus;
+	__kdata_end();
+}
+
+/**
+ * Write runtime values to kernel data page.
+ *
+ * @param force Write even if nothing but ticks has changed.
+ */
+static void __kdata_update(bool force)
+{
+	if (!kdata)
+		return;
+
+	sys_arg_t ram_usage = query_used();
+	sys_arg_t thread_stack = thread_stack_size();
+	sys_arg_t rpc_stack = rpc_stack_size();
+
+	/* every write makes concurrent readers retry, so don't bother if
+	 * there's nothing new to show */
+	if (!force
+	    && kdata->ram_usage == ram_usage
+	    && kdata->thread_stack == thread_stack
+	    && kdata->rpc_stack == rpc_stack)
+		return;
+
+	__kdata_begin();
+	kdata->ticks = current_ticks();
+	kdata->ram_usage = ram_usage;
+	kdata->thread_stack = thread_stack;
+	kdata->rpc_stack = rpc_stack;
+	__kdata_end();
+}
+
+void update_kdata()
+{
+	__kdata_update(false);
+}
+
+void tick_kdata()
+{
+	__kdata_update(true);
+}
+
+struct sys_kdata_cpu *kdata_cpu()
+{
+	if (!kdata)
+		return &dummy_cpu;
+
+	return &kdata->cpu[cpu_id()];
+}
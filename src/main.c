@@ -12,7 +12,11 @@
 #include <kmi/attrs.h>
 #include <kmi/proc.h>
 #include <kmi/debug.h>
+#include <kmi/power.h>
+#include <kmi/kdata.h>
 #include <kmi/vmem.h>
+#include <kmi/wait.h>
+#include <kmi/ipi.h>
 #include <kmi/irq.h>
 #include <kmi/bkl.h>
 #include <arch/arch.h>
@@ -80,16 +84,28 @@ __noreturn void kernel(void *fdt, uintptr_t load_addr, struct vmem *d)
 	init_pmem(fdt, load_addr);
 
 	init_irq(fdt);
-	init_timer(fdt);
+	if (init_timer(fdt)) {
+		/* nothing works without timers */
+		error("failed setting up timers\n");
+		poweroff(SYS_SHUTDOWN);
+	}
+
+	init_waits();
+	init_ipis();
 
 	vm_t proc_fdt = 0, proc_initrd = 0;
 	init_proc(fdt, &proc_fdt, &proc_initrd);
 
+	if (init_kdata())
+		warn("failed setting up kernel data page\n");
+
 	/* lock kernel since we're about to start other threads as well */
 	bkl_init();
 	bkl_lock();
 	/* try to bring up other cores on system */
 	smp_bringup(d, fdt);
+	kdata_set_cpus(smp_cpus());
+	dbg_defer();
 
 	/* start running init program */
 	run_init(cur_tcb(), proc_fdt, proc_initrd);
@@ -65,6 +65,8 @@ static struct node_region *__create_region()
 void init_nodes(struct node_root *r, size_t node_size)
 {
 	r->head = __create_region();
+	r->used = 0;
+	r->regions = 1;
 	r->av_head = r->head;
 	r->node_size = node_size;
 	r->bitmap = sizeof(struct node_region);
@@ -118,7 +120,7 @@ static void *__find_free_node(struct node_root *r, struct node_region *nr)
 static void __pop_av_head(struct node_root *r)
 {
 	struct node_region *t = r->av_head;
-	r->av_head = r->av_head->next;
+	r->av_head = r->av_head->av_next;
 	if (r->av_head)
 		r->av_head->av_prev = 0;
 
@@ -138,8 +140,10 @@ void *get_node(struct node_root *r)
 		r->head->next = r->av_head;
 
 		r->head = r->av_head;
+		r->regions++;
 	}
 
+	r->used++;
 	void *p = __find_free_node(r, r->av_head);
 	if (++r->av_head->used_nodes == r->max_nodes)
 		__pop_av_head(r);
@@ -171,6 +175,14 @@ static void __push_av_head(struct node_root *r, struct node_region *nr)
  */
 static void __free_region(struct node_root *r, struct node_region *nr)
 {
+	/* always keep at least one region around, and available */
+	if (nr == r->head && !nr->prev) {
+		if (!nr->av_next && !nr->av_prev && nr != r->av_head)
+			__push_av_head(r, nr);
+
+		return;
+	}
+
 	struct node_region *av_n = nr->av_next;
 	struct node_region *av_p = nr->av_prev;
 
@@ -193,13 +205,11 @@ static void __free_region(struct node_root *r, struct node_region *nr)
 		p->next = n;
 
 	if (nr == r->head) {
-		if (r->head->prev) {
-			r->head->next = 0;
-			r->head = r->head->prev;
-		} else
-			return;
+		r->head->next = 0;
+		r->head = r->head->prev;
 	}
 
+	r->regions--;
 	free_page(BASE_PAGE, (pm_t)nr);
 }
 
@@ -210,12 +220,14 @@ void free_node(struct node_root *r, void *p)
 	size_t i =
 		((uintptr_t)p - (r->first_node + (uintptr_t)nr)) / r->node_size;
 	bitmap_clear(bitmap, i);
+	r->used--;
 
 	if (--nr->used_nodes == 0) {
 		__free_region(r, nr);
 		return;
 	}
 
-	else if (!nr->av_next && !nr->av_prev)
+	/* the last region in the free list has neither neighbour */
+	else if (!nr->av_next && !nr->av_prev && nr != r->av_head)
 		__push_av_head(r, nr);
 }
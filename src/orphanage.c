@@ -1,6 +1,7 @@
 /* SPDX-License-Identifier: copyleft-next-0.3.1 */
 /* Copyright 2024, Kim Kuparinen < kimi.h.kuparinen@gmail.com > */
 
+#include <kmi/acct.h>
 #include <kmi/bkl.h>
 #include <kmi/assert.h>
 #include <kmi/orphanage.h>
@@ -34,6 +35,7 @@ void unorphanize(struct tcb *t)
 	reset_rpc_stack(t);
 
 	id_t old_rid = t->rid;
+	acct_migrate(t);
 	t->rid = 1;
 	t->pid = 1;
 	t->eid = 1;
@@ -13,6 +13,8 @@
 
 void kernel_panic(void *pc, void *addr, long cause)
 {
+	dbg_panic();
+
 	/* could be useful to print out register values as well? */
 	error("kernel paniced at pc: %p with address %p and cause %lx\n",
 	      pc, addr, cause);
@@ -28,6 +30,8 @@ void kernel_panic(void *pc, void *addr, long cause)
 
 void unhandled_panic(void *pc, void *addr, long cause)
 {
+	dbg_panic();
+
 	/* could be useful to print out register values as well? */
 	error(
 		"thread %d unhandled panic at pc: %p with address %p and cause %lx\n",
@@ -18,8 +18,11 @@
 #include <kmi/pmem.h>
 #include <kmi/dmem.h>
 #include <kmi/debug.h>
+#include <kmi/trace.h>
 #include <kmi/initrd.h>
 #include <kmi/regions.h>
+#include <kmi/timer.h>
+#include <kmi/tcb.h>
 #include <kmi/string.h> /* memset */
 #include <kmi/bits.h> /* is_nset etc */
 #include <libfdt.h>
@@ -150,8 +153,9 @@ static size_t __get_set_index(struct mm_bucket *bucket, struct mm_bmap *bmap)
  */
 static void __attach_set(struct mm_bucket *bucket, struct mm_bmap *bmap)
 {
-	/* already attached */
-	if (bmap->next || bucket->head == bmap)
+	/* already attached, note that the last node in the freelist has no next
+	 * node */
+	if (bmap->next || bmap->prev || bucket->head == bmap)
 		return;
 
 	bmap->next = bucket->head;
@@ -216,6 +220,10 @@ static void __get_bit(struct mm_bucket *bucket, pm_t a, size_t *s, size_t *b)
 /** Counter for how many bytes are currently in use. */
 static size_t used = 0;
 
+/** Counter for how many pages of each order are currently in use. Pages that
+ * were split up to hand out smaller pages aren't counted. */
+static size_t used_pages[MM_NUM] = { 0 };
+
 /**
  * Non-usage counting worker for \ref free_page().
  *
@@ -239,11 +247,12 @@ static bool __free_page(enum mm_order order, pm_t addr)
 	bitmap_clear(bmap->bits, bit);
 	__attach_set(bucket, bmap);
 
-	if (bmap->used == 0) {
+	/* only bitmaps that were split off of a larger page are given back,
+	 * the top order and any trailing bitmaps have nowhere to go and must
+	 * stay on the freelist */
+	if (bmap->used == 0 && bmap->size == order_width(order + 1)) {
 		__detach_set(bucket, bmap);
-
-		if (bmap->size == order_width(order + 1))
-			__free_page(order + 1, __page_addr(bucket, set, bit));
+		__free_page(order + 1, __page_addr(bucket, set, bit));
 	}
 
 	return true;
@@ -251,8 +260,11 @@ static bool __free_page(enum mm_order order, pm_t addr)
 
 void free_page(enum mm_order order, pm_t addr)
 {
-	if (__free_page(order, addr))
-		used -= order_size(order);
+	if (!__free_page(order, addr))
+		return;
+
+	used -= order_size(order);
+	used_pages[order]--;
 }
 
 /**
@@ -299,11 +311,35 @@ static pm_t __alloc_page(enum mm_order order)
 	return __page_addr(bucket, set, bit);
 }
 
+/**
+ * Dump memory statistics the first time an allocation larger than a base page
+ * fails. Exhaustion tests run out of memory on purpose, so only do it once to
+ * not drown everything else.
+ *
+ * @param order Order of failed allocation.
+ */
+static void __dump_once(enum mm_order order)
+{
+	static bool dumped = false;
+	if (dumped || order == BASE_PAGE)
+		return;
+
+	dumped = true;
+	info("failed allocating page of order %d\n", (int)order);
+	dump_mem();
+}
+
 pm_t alloc_page(enum mm_order order)
 {
 	pm_t page = __alloc_page(order);
-	if (page)
+	if (page) {
 		used += order_size(order);
+		used_pages[order]++;
+	}
+	else
+		__dump_once(order);
+
+	trace(TRACE_ALLOC_PAGE, order, page);
 
 	return page;
 }
@@ -349,8 +385,11 @@ static bool __mark_used(enum mm_order order, pm_t addr)
 
 void mark_used(enum mm_order order, pm_t addr)
 {
-	if (__mark_used(order, addr))
-		used += order_size(order);
+	if (!__mark_used(order, addr))
+		return;
+
+	used += order_size(order);
+	used_pages[order]++;
 }
 
 size_t query_used()
@@ -358,6 +397,69 @@ size_t query_used()
 	return used;
 }
 
+size_t query_used_pages(enum mm_order order)
+{
+	if (order < 0 || order > max_order())
+		return 0;
+
+	return used_pages[order];
+}
+
+size_t query_free_pages(enum mm_order order)
+{
+	if (order < 0 || order > max_order())
+		return 0;
+
+	struct mm_bucket *bucket = pmap->buckets[order];
+	if (!bucket)
+		return 0;
+
+	/* completely free bitmaps are detached and accounted for as free
+	 * pages of the next order up, so everything on the freelist is
+	 * partially used, except for the top order which starts out with
+	 * everything attached */
+	size_t n = 0;
+	for (struct mm_bmap *b = bucket->head; b; b = b->next)
+		n += b->size - b->used;
+
+	return n;
+}
+
+size_t query_largest_free()
+{
+	reverse_foreach_order(iter) {
+		if (query_free_pages(iter))
+			return order_size(iter);
+	}
+
+	return 0;
+}
+
+void dump_mem()
+{
+	info("ram: %zu of %zu bytes used, largest free page %zu bytes\n",
+	     used, get_ram_size(), query_largest_free());
+
+	reverse_foreach_order(iter) {
+		info("ram: order %d: %zu used, %zu free\n", (int)iter,
+		     used_pages[iter], query_free_pages(iter));
+	}
+
+	info("nodes: regions %zu of %zu used, %zu pages\n",
+	     mem_nodes()->used,
+	     mem_nodes()->regions * mem_nodes()->max_nodes,
+	     mem_nodes()->regions);
+
+	info("nodes: timers %zu of %zu used, %zu pages\n",
+	     timer_nodes()->used,
+	     timer_nodes()->regions * timer_nodes()->max_nodes,
+	     timer_nodes()->regions);
+
+	info("threads: %zu of %zu alive\n", alive_tcbs(), max_tcbs());
+	info("vmem: %zu page tables, %zu bytes of rpc stacks\n",
+	     page_tables(), rpc_stack_usage());
+}
+
 /**
  * Helper for probing/populating a bucket.
  *
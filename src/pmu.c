@@ -0,0 +1,200 @@
+/* SPDX-License-Identifier: copyleft-next-0.3.1 */
+/* Copyright 2024, Kim Kuparinen < kimi.h.kuparinen@gmail.com > */
+
+/**
+ * @file pmu.c
+ *
+ * Per-thread hardware performance counter implementation. Everything here
+ * runs under the BKL, and each core only ever touches its own counters.
+ */
+
+#include <kmi/pmu.h>
+#include <kmi/utils.h>
+#include <arch/pmu.h>
+#include <arch/cpu.h>
+
+/** What's been programmed through \ref SYS_PMU. */
+static struct {
+	/** Bumped whenever anything changes, so cores can tell if they have to
+	 * catch up. \c 0 means nothing has ever been programmed. */
+	unsigned long gen;
+
+	/** Generation each slot was last changed in, see \ref tcb_pmu.gen. */
+	unsigned long slot_gen[PMU_SLOTS];
+
+	/** Whether slot is in use. */
+	bool used[PMU_SLOTS];
+
+	/** Event counted in slot. */
+	enum sys_pmu_event event[PMU_SLOTS];
+
+	/** Counters userspace can read directly. */
+	unsigned long user;
+} conf = { 0 };
+
+/** Counters of one core. */
+struct pmu_cpu {
+	/** Value of \ref conf.gen the core has caught up with. */
+	unsigned long gen;
+
+	/** Value of \ref conf.slot_gen the counter of slot was started for. */
+	unsigned long slot_gen[PMU_SLOTS];
+
+	/** Whether counter of slot is running. */
+	bool running[PMU_SLOTS];
+
+	/** Index of counter of slot. */
+	size_t idx[PMU_SLOTS];
+
+	/** Value of counter at last thread switch. */
+	uint64_t last[PMU_SLOTS];
+};
+
+/** Counters of each core. */
+static struct pmu_cpu cpus[MAX_CPUS];
+
+/**
+ * Charge events counted since last switch to thread.
+ *
+ * @param c Counters of current core.
+ * @param t Thread to charge.
+ */
+static void __charge(struct pmu_cpu *c, struct tcb *t)
+{
+	for (size_t i = 0; i < PMU_SLOTS; ++i) {
+		/* reprogrammed slots are sorted out by __sync() */
+		if (!c->running[i] || c->slot_gen[i] != conf.slot_gen[i])
+			continue;
+
+		uint64_t now = pmu_read(c->idx[i]);
+		uint64_t delta = now - c->last[i];
+		c->last[i] = now;
+
+		if (t->pmu.gen[i] != conf.slot_gen[i]) {
+			t->pmu.gen[i] = conf.slot_gen[i];
+			t->pmu.count[i] = 0;
+		}
+
+		t->pmu.count[i] += delta;
+	}
+}
+
+/**
+ * Start counter of slot on current core.
+ *
+ * @param c Counters of current core.
+ * @param slot Slot to start.
+ * @return \ref OK on success, otherwise whatever \ref pmu_start() returned.
+ */
+static stat_t __start(struct pmu_cpu *c, size_t slot)
+{
+	if (c->running[slot]) {
+		pmu_stop(c->idx[slot]);
+		c->running[slot] = false;
+	}
+
+	c->slot_gen[slot] = conf.slot_gen[slot];
+	if (!conf.used[slot])
+		return OK;
+
+	stat_t r = pmu_start(conf.event[slot], &c->idx[slot]);
+	if (r)
+		return r;
+
+	c->running[slot] = true;
+	c->last[slot] = pmu_read(c->idx[slot]);
+	return OK;
+}
+
+/**
+ * Bring counters of current core up to date with \ref conf.
+ *
+ * @param c Counters of current core.
+ */
+static void __sync(struct pmu_cpu *c)
+{
+	if (c->gen == conf.gen)
+		return;
+
+	for (size_t i = 0; i < PMU_SLOTS; ++i) {
+		if (c->slot_gen[i] == conf.slot_gen[i])
+			continue;
+
+		/* not much we can do if some core can't count the event, the
+		 * slot just won't count anything there */
+		__start(c, i);
+	}
+
+	pmu_user(conf.user);
+	c->gen = conf.gen;
+}
+
+void pmu_switch(struct tcb *prev)
+{
+	/* don't bother if nobody's ever used the counters */
+	if (likely(!conf.gen))
+		return;
+
+	struct pmu_cpu *c = &cpus[cpu_id()];
+	__charge(c, prev);
+	__sync(c);
+}
+
+stat_t pmu_config(size_t slot, enum sys_pmu_event event, size_t *idx)
+{
+	if (slot >= PMU_SLOTS || event >= PMU_EVENTS)
+		return ERR_INVAL;
+
+	conf.used[slot] = true;
+	conf.event[slot] = event;
+	conf.slot_gen[slot] = ++conf.gen;
+
+	struct pmu_cpu *c = &cpus[cpu_id()];
+	stat_t r = __start(c, slot);
+	if (r) {
+		/* leave slot empty */
+		conf.used[slot] = false;
+		conf.slot_gen[slot] = ++conf.gen;
+		__sync(c);
+		return r;
+	}
+
+	__sync(c);
+	*idx = c->idx[slot];
+	return OK;
+}
+
+stat_t pmu_release(size_t slot)
+{
+	if (slot >= PMU_SLOTS)
+		return ERR_INVAL;
+
+	conf.used[slot] = false;
+	conf.slot_gen[slot] = ++conf.gen;
+	__sync(&cpus[cpu_id()]);
+	return OK;
+}
+
+stat_t pmu_count(struct tcb *t, size_t slot, unsigned long long *count)
+{
+	if (slot >= PMU_SLOTS)
+		return ERR_INVAL;
+
+	if (!conf.used[slot])
+		return ERR_NF;
+
+	struct pmu_cpu *c = &cpus[cpu_id()];
+	__charge(c, t);
+	__sync(c);
+
+	*count = t->pmu.gen[slot] == conf.slot_gen[slot] ? t->pmu.count[slot]
+	                                                 : 0;
+	return OK;
+}
+
+void pmu_set_user(unsigned long mask)
+{
+	conf.user = mask;
+	conf.gen++;
+	__sync(&cpus[cpu_id()]);
+}
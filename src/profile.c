@@ -0,0 +1,300 @@
+/* SPDX-License-Identifier: copyleft-next-0.3.1 */
+/* Copyright 2024, Kim Kuparinen < kimi.h.kuparinen@gmail.com > */
+
+/**
+ * @file profile.c
+ *
+ * Sampling profiler implementation. Rings work exactly like the ones in
+ * trace.c, each core is the only producer of its own ring and \ref
+ * profile_drain() is the only consumer. Per-core state is likewise only ever
+ * touched by its own core, so samples can be taken without the big kernel
+ * lock. The exception is walking userspace stacks, which needs the lock to
+ * keep other cores from unmapping them under us.
+ */
+
+#include <kmi/profile.h>
+#include <kmi/atomic.h>
+#include <kmi/timer.h>
+#include <kmi/pmem.h>
+#include <kmi/bkl.h>
+#include <kmi/tcb.h>
+#include <kmi/mem.h>
+
+#include <arch/timer.h>
+#include <arch/proc.h>
+#include <arch/cpu.h>
+
+#if defined(KERNEL_PROFILE)
+
+/** Sample ring buffer and sampling state of one core. */
+struct profile_cpu {
+	/** Samples written by the core, only ever incremented. */
+	size_t head;
+
+	/** Samples drained, only ever incremented. */
+	size_t tail;
+
+	/** Samples dropped since last drain. */
+	size_t dropped;
+
+	/** Buffer of \ref entries samples. */
+	struct sys_profile_rec *rec;
+
+	/** Value of \ref gen the core last saw. */
+	size_t gen;
+
+	/** When the core should take its next sample, \c (ticks_t)-1 if not
+	 * sampling. */
+	ticks_t due;
+
+	/** Where userspace entered the kernel from. */
+	vm_t pc;
+
+	/** Thread that entered the kernel. */
+	id_t tid;
+
+	/** Process that entered the kernel. */
+	id_t pid;
+
+	/** Syscall being handled, \c -1 if none. */
+	int what;
+};
+
+bool profile_enabled = false;
+
+/** Profiler state, one per core. */
+static struct profile_cpu cpus[MAX_CPUS] = { 0 };
+
+/** Number of samples in each ring, power of two. */
+static size_t entries = 0;
+
+/** Ticks between samples. */
+static ticks_t period = 0;
+
+/** Incremented each time profiling is started, so cores notice they should
+ * start over. */
+static size_t gen = 0;
+
+/** Order of page backing all rings. */
+#define PROFILE_ORDER MM_O1
+
+/**
+ * Write sample into ring of \p c.
+ *
+ * @param c Profiler state of current core.
+ * @param mode Mode, see \ref sys_profile_mode.
+ * @param now Current ticks.
+ * @return Sample to fill in the rest of, \c NULL if ring is full.
+ */
+static struct sys_profile_rec *__record(struct profile_cpu *c,
+                                        enum sys_profile_mode mode,
+                                        ticks_t now)
+{
+	size_t head = c->head;
+	size_t tail = atomic_load_explicit(&c->tail, memory_order_acquire);
+	if (head - tail >= entries) {
+		atomic_fetch_add_explicit(&c->dropped, 1, memory_order_relaxed);
+		return NULL;
+	}
+
+	struct sys_profile_rec *r = &c->rec[head & (entries - 1)];
+	*r = (struct sys_profile_rec){
+		.ticks = now,
+		.mode = mode,
+		.cpu = c - cpus,
+		.what = -1
+	};
+
+	return r;
+}
+
+/**
+ * Publish sample written by \ref __record().
+ *
+ * @param c Profiler state of current core.
+ */
+static void __publish(struct profile_cpu *c)
+{
+	atomic_store_explicit(&c->head, c->head + 1, memory_order_release);
+}
+
+/**
+ * Check if profiler was started or stopped since core last looked, and if so,
+ * (re)schedule the next sample.
+ *
+ * @param c Profiler state of current core.
+ * @param now Current ticks.
+ * @return \c true if something changed and no sample should be taken.
+ */
+static bool __restart(struct profile_cpu *c, ticks_t now)
+{
+	size_t g = atomic_load_explicit(&gen, memory_order_acquire);
+	if (c->gen == g)
+		return false;
+
+	c->gen = g;
+	c->due = now + period;
+	refresh_timer();
+	return true;
+}
+
+/**
+ * Schedule next sample after one was taken.
+ *
+ * @param c Profiler state of current core.
+ * @param now Current ticks.
+ */
+static void __next(struct profile_cpu *c, ticks_t now)
+{
+	/* keep to the original schedule, unless we're so late that whole
+	 * periods have passed */
+	c->due += period;
+	if (c->due <= now)
+		c->due = now + period;
+}
+
+void profile_entry(struct tcb *t)
+{
+	struct profile_cpu *c = &cpus[t->cpu_id];
+	c->pc = t->exec;
+	c->tid = t->tid;
+	c->pid = t->pid;
+	c->what = -1;
+}
+
+void profile_mark(struct tcb *t, sys_arg_t num)
+{
+	cpus[t->cpu_id].what = num;
+}
+
+void profile_exit(struct tcb *t)
+{
+	struct profile_cpu *c = &cpus[t->cpu_id];
+	ticks_t now = current_ticks();
+	if (__restart(c, now) || now < c->due)
+		return;
+
+	struct sys_profile_rec *r = __record(c, PROFILE_KERNEL, now);
+	if (r) {
+		r->tid = c->tid;
+		r->pid = c->pid;
+		r->what = c->what;
+		r->pc = c->pc;
+		__publish(c);
+	}
+
+	/* don't let the timer go off as soon as we're back in userspace */
+	__next(c, now);
+	refresh_timer();
+}
+
+void profile_sample(struct tcb *t)
+{
+	if (!atomic_load_explicit(&profile_enabled, memory_order_acquire))
+		return;
+
+	struct profile_cpu *c = &cpus[t->cpu_id];
+	ticks_t now = current_ticks();
+	if (__restart(c, now) || now < c->due)
+		return;
+
+	struct sys_profile_rec *r = __record(c, PROFILE_USER, now);
+	if (r) {
+		r->tid = t->tid;
+		r->pid = t->pid;
+		r->pc = t->exec;
+#if defined(FRAME_POINTERS)
+		bkl_lock();
+		get_backtrace(t, r->frames, PROFILE_FRAMES);
+		bkl_unlock();
+#endif
+		__publish(c);
+	}
+
+	/* handle_timer() reprograms the timer */
+	__next(c, now);
+}
+
+ticks_t profile_due()
+{
+	if (!atomic_load_explicit(&profile_enabled, memory_order_acquire))
+		return (ticks_t)-1;
+
+	return cpus[cpu_id()].due;
+}
+
+stat_t profile_start(ticks_t p)
+{
+	if (!p)
+		return ERR_INVAL;
+
+	if (!entries) {
+		pm_t page = alloc_page(PROFILE_ORDER);
+		if (!page)
+			return ERR_OOMEM;
+
+		size_t n = order_size(PROFILE_ORDER) / MAX_CPUS
+		           / sizeof(struct sys_profile_rec);
+		size_t e = 1;
+		while (e * 2 <= n)
+			e *= 2;
+
+		struct sys_profile_rec *rec = (struct sys_profile_rec *)page;
+		for (size_t i = 0; i < MAX_CPUS; ++i)
+			cpus[i].rec = rec + i * e;
+
+		entries = e;
+	}
+
+	period = p;
+	atomic_fetch_add_explicit(&gen, 1, memory_order_release);
+	atomic_store_explicit(&profile_enabled, true, memory_order_release);
+	return OK;
+}
+
+void profile_stop()
+{
+	/* cores that still have a sample scheduled get one extra timer
+	 * interrupt, which handle_timer() treats as spurious */
+	atomic_store_explicit(&profile_enabled, false, memory_order_release);
+}
+
+stat_t profile_drain(id_t cpu, struct vmem *l, vm_t buf, size_t max,
+                     size_t *drained, size_t *dropped)
+{
+	if (cpu < 0 || cpu >= MAX_CPUS)
+		return ERR_INVAL;
+
+	*drained = 0;
+	*dropped = 0;
+
+	/* never started */
+	if (!entries)
+		return OK;
+
+	struct profile_cpu *c = &cpus[cpu];
+	size_t head = atomic_load_explicit(&c->head, memory_order_acquire);
+	size_t tail = c->tail;
+
+	size_t n = 0;
+	while (tail + n != head && n < max) {
+		struct sys_profile_rec *e = &c->rec[(tail + n) & (entries - 1)];
+		vm_t dst = buf + n * sizeof(*e);
+		if (copy_user(l, dst, NULL, (vm_t)e, sizeof(*e)) != sizeof(*e))
+			break;
+
+		n++;
+	}
+
+	atomic_store_explicit(&c->tail, tail + n, memory_order_release);
+
+	*drained = n;
+	*dropped = atomic_exchange_explicit(&c->dropped, 0,
+	                                    memory_order_relaxed);
+	if (n == 0 && head != tail)
+		return ERR_ADDR;
+
+	return OK;
+}
+
+#endif /* KERNEL_PROFILE */
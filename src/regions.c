@@ -27,6 +27,11 @@ void destroy_mem_nodes()
 	destroy_nodes(&root);
 }
 
+struct node_root *mem_nodes()
+{
+	return &root;
+}
+
 /**
  * Allocate a new memory region node and return it.
  *
@@ -360,21 +365,22 @@ struct mem_region *find_free_region(struct mem_region_root *r, size_t size,
 
 			/* we're the only free region left to check,
 			 * are we large enough to carve a chunk out of? */
-			size_t offset = r->reserved - t->start;
-			if (size < qsize - offset)
+			size_t skip = r->start + r->reserved - t->start;
+			if (skip >= qsize || size > qsize - skip)
 				return quick_best;
 
 			/* we are, so let's set the alignment to match that at
 			 * least some parts of this block should be skipped */
 
 			/* try to use page order alignment if possible */
-			if (size <= bsize - offset) {
+			start = align_up(t->start + skip, offset);
+			if (start <= t->end && size <= t->end - start) {
 				*align = start - t->start;
 				return t;
 			}
 
 			/* otherwise, carve out a block at the top of this node. */
-			*align = t->end - size;
+			*align = qsize - size;
 			return t;
 		}
 
@@ -79,40 +79,50 @@ __weak char *strncat(char * restrict dst, const char * restrict src, size_t num)
 #undef strcmp
 __weak int strcmp(const char *str1, const char *str2)
 {
-	const char *s1 = (const char *)str1;
-	const char *s2 = (const char *)str2;
+	/* characters are compared as unsigned, like libc does */
+	const unsigned char *s1 = (const unsigned char *)str1;
+	const unsigned char *s2 = (const unsigned char *)str2;
 
-	while ((*(s1++) == *(s2++)) && *s1 && *s2)
-		;
+	while (*s1 && *s1 == *s2) {
+		s1++;
+		s2++;
+	}
 
-	return (int)(s1[-1] - s2[-1]);
+	return (int)*s1 - (int)*s2;
 }
 
 #undef strncmp
 __weak int strncmp(const char *str1, const char *str2, size_t num)
 {
-	const char *s1 = (const char *)str1;
-	const char *s2 = (const char *)str2;
+	const unsigned char *s1 = (const unsigned char *)str1;
+	const unsigned char *s2 = (const unsigned char *)str2;
 
-	while ((*(s1++) == *(s2++)) && *s1 && *s2 && --num)
-		;
+	if (!num)
+		return 0;
+
+	while (--num && *s1 && *s1 == *s2) {
+		s1++;
+		s2++;
+	}
 
-	return (int)(s1[-1] - s2[-1]);
+	return (int)*s1 - (int)*s2;
 }
 
 #undef strchr
 __weak char *strchr(const char *str, int chr)
 {
+	/* the terminating null character counts as part of the string */
 	const char *s1 = str;
-	ssize_t num = strlen(s1);
+	char c = (char)chr;
 
-	while (num-- && *(s1++) != chr)
-		;
+	while (*s1 != c) {
+		if (!*s1)
+			return 0;
 
-	if (num < 0)
-		return 0;
+		s1++;
+	}
 
-	return (char *)(s1 - 1);
+	return (char *)s1;
 }
 
 #undef strtok
@@ -330,9 +340,9 @@ static inline void *__aligned_memcpy(long *restrict dst,
  */
 static inline void *__aligned_memset(long *ptr, int value, size_t num)
 {
-	long bits = 0;
+	unsigned long bits = 0;
 	for (size_t i = 0; i < sizeof(long) / sizeof(unsigned char); ++i)
-		bits |= ((unsigned char)value) << i * CHAR_BIT;
+		bits |= (unsigned long)(unsigned char)value << i * CHAR_BIT;
 
 	size_t count = num / sizeof(long);
 	for (size_t i = 0; i < count; i += MAGIC_NUMBER) {
@@ -393,10 +403,18 @@ __weak void *memmove(void *dst, const void *src, size_t num)
 	const char *m1 = (const char *)src;
 	char *m2 = (char *)dst;
 
+	/* copy forwards if destination is below source, so that overlapping
+	 * bytes are read before they're overwritten */
+	if ((uintptr_t)m2 < (uintptr_t)m1) {
+		while (num--)
+			*(m2++) = *(m1++);
+
+		return dst;
+	}
+
 	m1 += num;
 	m2 += num;
 
-	/* doesn't really take into account aliasing yet */
 	while (num--)
 		*(--m2) = *(--m1);
 
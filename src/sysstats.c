@@ -0,0 +1,110 @@
+/* SPDX-License-Identifier: copyleft-next-0.3.1 */
+/* Copyright 2024, Kim Kuparinen < kimi.h.kuparinen@gmail.com > */
+
+/**
+ * @file sysstats.c
+ *
+ * Per-syscall statistics implementation. Counters are kept per core so that
+ * \ref sysstats_leave() can update them without the big kernel lock, and are
+ * only summed up when someone asks for them.
+ */
+
+#include <kmi/sysstats.h>
+#include <kmi/string.h>
+
+#if defined(SYSCALL_STATS)
+
+/** Counters of one syscall on one core. */
+struct sysstat {
+	/** Number of invocations. */
+	unsigned long long count;
+
+	/** Total ticks. */
+	unsigned long long ticks;
+
+	/** Longest invocation. */
+	unsigned long long max;
+
+	/** Latency histogram, see \ref sys_syscall_stats.hist. 32 bits should
+	 * be enough per core, and keeps the table a bit smaller. */
+	uint32_t hist[SYSCALL_STATS_BUCKETS];
+};
+
+/** Counters of each syscall on each core. */
+static struct sysstat stats[MAX_CPUS][SYS_NUM];
+
+/** Syscall each core is currently handling plus one, \c 0 if none. */
+static sys_arg_t pending[MAX_CPUS] = { 0 };
+
+/**
+ * Get histogram bucket of latency.
+ *
+ * @param ticks Latency.
+ * @return Corresponding bucket.
+ */
+static size_t __bucket(ticks_t ticks)
+{
+	/* position of highest set bit plus one, capped to the last bucket.
+	 * Avoid __builtin_clzll() since that might end up calling into libgcc
+	 * on rv32 */
+	size_t b = 0;
+	while (ticks && b < SYSCALL_STATS_BUCKETS - 1) {
+		ticks >>= 1;
+		b++;
+	}
+
+	return b;
+}
+
+void sysstats_enter(struct tcb *t, sys_arg_t num)
+{
+	/* out of range syscalls are just ignored */
+	if (num < 0 || num >= SYS_NUM)
+		return;
+
+	pending[t->cpu_id] = num + 1;
+}
+
+void sysstats_leave(struct tcb *t, ticks_t ticks)
+{
+	sys_arg_t num = pending[t->cpu_id];
+	if (!num)
+		return;
+
+	pending[t->cpu_id] = 0;
+
+	struct sysstat *s = &stats[t->cpu_id][num - 1];
+	s->count++;
+	s->ticks += ticks;
+	if (ticks > s->max)
+		s->max = ticks;
+
+	s->hist[__bucket(ticks)]++;
+}
+
+stat_t sysstats_get(sys_arg_t num, struct sys_syscall_stats *out)
+{
+	if (num < 0 || num >= SYS_NUM)
+		return ERR_INVAL;
+
+	memset(out, 0, sizeof(*out));
+	for (size_t c = 0; c < MAX_CPUS; ++c) {
+		struct sysstat *s = &stats[c][num];
+		out->count += s->count;
+		out->ticks += s->ticks;
+		if (s->max > out->max)
+			out->max = s->max;
+
+		for (size_t i = 0; i < SYSCALL_STATS_BUCKETS; ++i)
+			out->hist[i] += s->hist[i];
+	}
+
+	return OK;
+}
+
+void sysstats_reset()
+{
+	memset(stats, 0, sizeof(stats));
+}
+
+#endif /* SYSCALL_STATS */
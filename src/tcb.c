@@ -8,6 +8,8 @@
 
 #include <kmi/tcb.h>
 #include <kmi/ipi.h>
+#include <kmi/pmu.h>
+#include <kmi/wait.h>
 #include <kmi/mem.h>
 #include <kmi/conf.h>
 #include <kmi/pmem.h>
@@ -29,6 +31,9 @@ static id_t start_tid = 0;
 /** Maximum number of concurrently active threads. */
 static id_t num_tcbs;
 
+/** Number of threads currently alive. */
+static size_t num_alive = 0;
+
 /** Pointer to array of \ref tcb structures. Length of the array is \c num_tids.*/
 static struct tcb **tcbs;
 
@@ -45,6 +50,11 @@ size_t max_tcbs()
 	return num_tcbs;
 }
 
+size_t alive_tcbs()
+{
+	return num_alive;
+}
+
 void init_tcbs()
 {
 	/* MM_O1 is 2MiB on riscv64, so 262144 different possible thread ids.
@@ -190,6 +200,7 @@ struct tcb *create_thread(struct tcb *p)
 
 	reference_thread(t);
 	set_canary(t);
+	num_alive++;
 	return t;
 }
 
@@ -247,6 +258,7 @@ static void __destroy_thread_data(struct tcb *t)
 	/* free associated kernel stack and the structure itself */
 	vm_t bottom = align_down((vm_t)t, order_size(MM_O0));
 	free_page(MM_O0, (pm_t)bottom);
+	num_alive--;
 }
 
 stat_t destroy_thread(struct tcb *t)
@@ -265,6 +277,7 @@ stat_t destroy_thread(struct tcb *t)
 	destroy_rpcmem(t->rpc.vmem);
 
 	unqueue_ipi(t);
+	unqueue_wait(t);
 
 	/** @todo timers, irqs? theoretically we could allow them to stay and
 	 * let the handler check if the thread is still interested in the
@@ -337,6 +350,7 @@ struct tcb *eff_proc()
 
 void use_tcb(struct tcb *t)
 {
+	pmu_switch(cur_tcb());
 	cpu_assign(t);
 
 	__cpu_tcb[t->cpu_id] = t;
@@ -6,52 +6,124 @@
  * Timer handling implementation. Currently we only expect an architecture to
  * support a single timer per core.
  *
- * By keeping all timers in a binary search
- * tree ordered by time, we can just set the single timer to interrupt us when
- * the next timer is due and with thread info call the thread that set the
- * timer. From what I can tell, this is largely what Linux does.
+ * Each core keeps its timers in a hierarchical timing wheel, where each level
+ * has \ref WHEEL_SLOTS slots and each slot on level \c n covers \ref
+ * WHEEL_SLOTS times more ticks than a slot on level \c n - 1. Timers are
+ * placed on the lowest level that can fit their expiry, and as time passes
+ * timers on higher levels are cascaded down to lower levels until they reach
+ * level 0, where they expire. Inserting and removing timers is constant time,
+ * and we can just set the single hardware timer to interrupt us when the next
+ * thing on the wheel should happen. This is pretty much the old Linux timer
+ * wheel, except each slot on level 0 is exactly one tick so timers aren't
+ * rounded in any way.
+ *
+ * Since there's no periodic tick, each level also keeps a bitmap of which
+ * slots have timers in them, so we can jump directly to the next interesting
+ * point in time instead of stepping through every empty slot.
+ *
+ * Timers are additionally hashed by their \c cid, so they can be found and
+ * removed from any core.
  *
  * \todo Figure out if there are any advantages to having multiple concurrent
  * timers.
  */
 
-#include <kmi/sp_tree.h>
 #include <kmi/string.h>
+#include <kmi/assert.h>
 #include <kmi/notify.h>
+#include <kmi/profile.h>
 #include <kmi/nodes.h>
 #include <kmi/utils.h>
 #include <kmi/timer.h>
 #include <kmi/debug.h>
+#include <kmi/kdata.h>
+#include <kmi/trace.h>
+#include <kmi/pmem.h>
+#include <kmi/wait.h>
+#include <kmi/bits.h>
+#include <kmi/list.h>
 #include <kmi/bkl.h>
+#include <kmi/mem.h>
 
 #include <arch/timer.h>
 #include <arch/cpu.h>
 
+/** Bits of slot index per wheel level. */
+#define WHEEL_BITS 6
+
+/** Number of slots per wheel level. */
+#define WHEEL_SLOTS (1 << WHEEL_BITS)
+
+/** Mask of slot index. */
+#define WHEEL_MASK (WHEEL_SLOTS - 1)
+
+/**
+ * Number of wheel levels. With one tick per level 0 slot this covers 2^48
+ * ticks, or about 325 days at 10MHz. Anything further away than that is parked
+ * in the last slot and reinserted once it's reached.
+ */
+#define WHEEL_LEVELS 8
+
+/** Largest distance from wheel clock a timer can be placed at. */
+#define WHEEL_RANGE ((((ticks_t)1) << (WHEEL_BITS * WHEEL_LEVELS)) - 1)
+
 /** Timer resolution. */
 static ticks_t ticks_per_sec = 0;
 
-/** Array of timer maps for each cpu. */
-static struct sp_root cpu_timers[MAX_CPUS] = { 0 };
+/** Timing wheel of one cpu. */
+struct timer_wheel {
+	/** Next tick that hasn't been processed yet. */
+	ticks_t clk;
+
+	/** Bitmap of non-empty slots for each level. */
+	uint64_t used[WHEEL_LEVELS];
+
+	/** Timers that have expired but haven't been handled yet. */
+	struct list_head expired;
+
+	/** When the hardware timer should go off for the wheel. Only ever
+	 * touched by the core the wheel belongs to. */
+	ticks_t armed;
+
+	/** Wheel slots. */
+	struct list_head slots[WHEEL_LEVELS][WHEEL_SLOTS];
+};
+
+/** Array of timer wheels for each cpu. */
+static struct timer_wheel cpu_wheels[MAX_CPUS];
 
 /** Timer node subsystem instance. */
 static struct node_root node_root;
 
-/** Node in timer map. */
+/** Node in timer wheel. */
 struct timer_node {
-	/** Sp tree node. */
-	struct sp_node sp_n;
+	/** Position in wheel slot or expired list. */
+	struct list_head l;
+
+	/** Head of list this node is in. */
+	struct list_head *head;
+
+	/** Next node in the same \c cid bucket. */
+	struct timer_node *next;
+
+	/** Which cpu's wheel this node is in. */
+	id_t cpu_id;
+
+	/** Whether \ref handle_timer() has already picked this node to notify
+	 * its thread. */
+	bool batched;
 
 	/** Corresponding timer. */
 	struct timer timer;
 };
 
 /**
- * Get \ref timer_node from \ref sp_node.
+ * Get \ref timer_node from \ref list_head.
  *
- * @param ptr \ref sp_node whose parent \ref timer_node to get.
+ * @param ptr \ref list_head whose parent \ref timer_node to get.
  * @return Corresponding \ref timer_node.
  */
-#define timer_container(ptr) container_of(ptr, struct timer_node, sp_n)
+#define timer_container(ptr) container_of(ptr, struct timer_node, l)
 
 /**
  * Get \ref timer_node from \ref timer.
@@ -61,68 +133,283 @@ struct timer_node {
  */
 #define timer_node_container(ptr) container_of(ptr, struct timer_node, timer)
 
+/** Buckets of \c cid to timer index. */
+static struct timer_node **timer_index;
+
+/** Number of buckets in \ref timer_index, power of two. */
+static size_t num_buckets;
+
+/** Next \c cid to hand out. */
+static id_t next_cid = 1;
+
 /**
- * Get timer map of current cpu.
+ * Get timer wheel of current cpu.
  *
- * @return Root of current cpu's timer map.
+ * @return Current cpu's timer wheel.
  */
-static struct sp_root *__cpu_timers()
+static struct timer_wheel *__cpu_wheel()
 {
-	return &cpu_timers[cpu_id()];
+	return &cpu_wheels[cpu_id()];
 }
 
-void init_timer(const void *fdt)
+stat_t init_timer(const void *fdt)
 {
 	ticks_per_sec = stat_timer(fdt);
 	info("ticks_per_sec: %" PRIu64 "\n", ticks_per_sec);
 	info("current ticks: %" PRIu64 "\n", current_ticks());
 	init_nodes(&node_root, sizeof(struct timer_node));
+
+	ticks_t now = current_ticks();
+	for (size_t c = 0; c < MAX_CPUS; ++c) {
+		struct timer_wheel *w = &cpu_wheels[c];
+		w->clk = now;
+		w->expired = (struct list_head)INIT_LIST(w->expired);
+		for (size_t l = 0; l < WHEEL_LEVELS; ++l)
+			for (size_t s = 0; s < WHEEL_SLOTS; ++s)
+				w->slots[l][s] =
+					(struct list_head)INIT_LIST(w->slots[l][s]);
+	}
+
+	/* same deal as with tcbs, a couple hundred thousand timers should be
+	 * plenty */
+	timer_index = (struct timer_node **)alloc_page(MM_O1);
+	if (!timer_index)
+		return ERR_OOMEM;
+
+	num_buckets = order_size(MM_O1) / sizeof(struct timer_node *);
+	assert(is_powerof2(num_buckets));
+	memset(timer_index, 0, order_size(MM_O1));
+	return OK;
+}
+
+struct node_root *timer_nodes()
+{
+	return &node_root;
 }
 
 /**
- * Insert timer into current cpu's timer map.
+ * Get bucket of \c cid.
  *
- * \note \c ti.cid might change during the insertion if there already is a node
- * with identical \c cid to avoid collisions. Very unlikely though.
+ * @param cid Control ID.
+ * @return Head of bucket chain \p cid belongs to.
+ */
+static struct timer_node **__bucket(id_t cid)
+{
+	/* cids are handed out sequentially, so consecutive timers fall into
+	 * consecutive buckets */
+	return &timer_index[(size_t)cid & (num_buckets - 1)];
+}
+
+/**
+ * Give timer a new \c cid and add it to the index.
  *
- * @param ti Timer node to insert.
- * @return \c cid of timer node.
+ * @param n Timer node to index.
  */
-static id_t __insert_timer(struct timer_node *ti)
+static void __index_timer(struct timer_node *n)
 {
-	struct sp_root *root = __cpu_timers();
-	struct sp_node *n = sp_root(root), *p = NULL;
-	enum sp_dir d = SP_LEFT;
-	while (n) {
-		struct timer_node *t = container_of(n, struct timer_node, sp_n);
-		if (ti->timer.cid == t->timer.cid) {
-			/* if there's an identical ID, we'll just increment our
-			 * ID until we get and ID that doesn't exist yet. There
-			 * is a very small possibility that this will set a
-			 * timer that's very slightly ahead of some other timer
-			 * to be handled after the one that's very close, but
-			 * the timescales that we're dealing with are probably
-			 * tiny enough that this won't matter, even if it
-			 * occurs.
-			 *
-			 * This is one thing we couldn't do without having the
-			 * internals of sptrees exposed. Pretty cool, huh? */
-			ti->timer.cid++;
-		}
+	n->timer.cid = next_cid++;
+	if (next_cid <= 0)
+		next_cid = 1;
+
+	struct timer_node **b = __bucket(n->timer.cid);
+	n->next = *b;
+	*b = n;
+}
+
+/**
+ * Remove timer from index.
+ *
+ * @param n Timer node to remove.
+ */
+static void __unindex_timer(struct timer_node *n)
+{
+	struct timer_node **b = __bucket(n->timer.cid);
+	while (*b != n)
+		b = &(*b)->next;
+
+	*b = n->next;
+}
+
+/**
+ * Get index of first set bit in 64bit mask.
+ *
+ * @param m Mask, must not be zero.
+ * @return Index of least significant set bit.
+ */
+static size_t __first_bit(uint64_t m)
+{
+	uint32_t lo = (uint32_t)m;
+	if (lo)
+		return ffs(lo) - 1;
+
+	return 32 + ffs((uint32_t)(m >> 32)) - 1;
+}
+
+/**
+ * Add timer node to list and keep track of which list it's in.
+ *
+ * @param w Wheel the list belongs to.
+ * @param n Timer node to add.
+ * @param head List to add to.
+ */
+static void __add_node(struct timer_wheel *w, struct timer_node *n,
+                       struct list_head *head)
+{
+	list_add_tail(&n->l, head);
+	n->head = head;
+	n->cpu_id = w - cpu_wheels;
+}
+
+/**
+ * Remove timer node from whichever list it's in, and clear the slot bit if it
+ * was the last node in the slot.
+ *
+ * @param n Timer node to remove.
+ */
+static void __del_node(struct timer_node *n)
+{
+	struct timer_wheel *w = &cpu_wheels[n->cpu_id];
+	struct list_head *head = n->head;
+	list_del(&n->l);
+	n->head = NULL;
+
+	if (head == &w->expired || !list_empty(head))
+		return;
+
+	size_t i = head - &w->slots[0][0];
+	clear_bits(w->used[i / WHEEL_SLOTS], (uint64_t)1 << (i % WHEEL_SLOTS));
+}
+
+/**
+ * Place timer node in the appropriate wheel slot.
+ *
+ * @param w Wheel to place node in.
+ * @param n Node to place.
+ */
+static void __wheel_insert(struct timer_wheel *w, struct timer_node *n)
+{
+	ticks_t idx = n->timer.ticks < w->clk ? w->clk : n->timer.ticks;
+	ticks_t delta = idx - w->clk;
+	if (delta > WHEEL_RANGE) {
+		/* park in last slot, __wheel_expire() will notice */
+		delta = WHEEL_RANGE;
+		idx = w->clk + delta;
+	}
+
+	size_t l = 0;
+	while (l < WHEEL_LEVELS - 1 && (delta >> (WHEEL_BITS * (l + 1))))
+		l++;
+
+	size_t s = (idx >> (WHEEL_BITS * l)) & WHEEL_MASK;
+	__add_node(w, n, &w->slots[l][s]);
+	set_bits(w->used[l], (uint64_t)1 << s);
+}
+
+/**
+ * Find tick at which the next thing happens on a wheel, i.e. either a timer
+ * on level 0 expires or a slot on some higher level should be cascaded down.
+ *
+ * @param w Wheel to look at.
+ * @return Tick of next event, \c (ticks_t)-1 if wheel is empty.
+ */
+static ticks_t __next_event(struct timer_wheel *w)
+{
+	ticks_t next = (ticks_t)-1;
+	for (size_t l = 0; l < WHEEL_LEVELS; ++l) {
+		uint64_t m = w->used[l];
+		if (!m)
+			continue;
+
+		/* first slot boundary at or after clk on this level */
+		size_t shift = WHEEL_BITS * l;
+		ticks_t base = (w->clk + ((((ticks_t)1) << shift) - 1)) >> shift;
+		size_t r = base & WHEEL_MASK;
+
+		/* rotate so that bit 0 corresponds to base */
+		m = (m >> r) | (m << ((WHEEL_SLOTS - r) & WHEEL_MASK));
+		ticks_t at = (base + __first_bit(m)) << shift;
+		if (at < next)
+			next = at;
+	}
+
+	return next;
+}
+
+/**
+ * Move all timers in slot to lower levels.
+ *
+ * @param w Wheel whose slot to cascade.
+ * @param l Level of slot.
+ * @param s Index of slot.
+ */
+static void __wheel_cascade(struct timer_wheel *w, size_t l, size_t s)
+{
+	struct list_head *head = &w->slots[l][s];
+	struct list_head *e;
+	while ((e = list_front(head))) {
+		struct timer_node *n = timer_container(e);
+		__del_node(n);
+		__wheel_insert(w, n);
+	}
+}
 
-		p = n;
+/**
+ * Move timers in slot on level 0 to expired list.
+ *
+ * @param w Wheel whose slot to expire.
+ * @param s Index of slot.
+ * @param now Current ticks.
+ */
+static void __wheel_expire(struct timer_wheel *w, size_t s, ticks_t now)
+{
+	struct list_head *head = &w->slots[0][s];
+	struct list_head *e;
+	while ((e = list_front(head))) {
+		struct timer_node *n = timer_container(e);
+		__del_node(n);
 
-		if (ti->timer.cid < t->timer.cid) {
-			n = sp_left(n);
-			d = SP_LEFT;
-		} else {
-			n = sp_right(n);
-			d = SP_RIGHT;
+		/* was parked, still not due */
+		if (n->timer.ticks > now) {
+			/* step past current slot so we don't land here again */
+			w->clk++;
+			__wheel_insert(w, n);
+			w->clk--;
+			continue;
 		}
+
+		__add_node(w, n, &w->expired);
 	}
+}
 
-	sp_insert(&sp_root(root), p, &ti->sp_n, d);
-	return ti->timer.cid;
+/**
+ * Process wheel up to and including \p now, moving expired timers to the
+ * expired list.
+ *
+ * @param w Wheel to process.
+ * @param now Current ticks.
+ */
+static void __wheel_advance(struct timer_wheel *w, ticks_t now)
+{
+	while (w->clk <= now) {
+		ticks_t next = __next_event(w);
+		if (next > now) {
+			/* nothing happens in between, just skip ahead */
+			w->clk = now + 1;
+			return;
+		}
+
+		w->clk = next;
+		for (size_t l = 1; l < WHEEL_LEVELS; ++l) {
+			size_t shift = WHEEL_BITS * l;
+			if (w->clk & ((((ticks_t)1) << shift) - 1))
+				break;
+
+			__wheel_cascade(w, l, (w->clk >> shift) & WHEEL_MASK);
+		}
+
+		__wheel_expire(w, w->clk & WHEEL_MASK, now);
+		w->clk++;
+	}
 }
 
 /**
@@ -130,53 +417,144 @@ static id_t __insert_timer(struct timer_node *ti)
  *
  * @param tid Requesting thread ID.
  * @param ticks Absolute timepoint.
+ * @param wait Whether timer is a \ref sys_wait() timeout.
  * @return \c cid of created timer.
  */
-static id_t __new_timer(id_t tid, ticks_t ticks)
+static id_t __new_timer(id_t tid, ticks_t ticks, bool wait)
+{
+	struct timer_node *n = (struct timer_node *)get_node(&node_root);
+	n->timer.ticks = ticks;
+	n->timer.tid = tid;
+	n->timer.wait = wait;
+	n->timer.period = 0;
+	n->timer.overruns = 0;
+	n->batched = false;
+	__index_timer(n);
+	__wheel_insert(__cpu_wheel(), n);
+	return n->timer.cid;
+}
+
+/**
+ * Program hardware timer for \p ticks, or for the next profiler sample if
+ * that comes first.
+ *
+ * @param w Wheel of current core.
+ * @param ticks When the wheel wants to be interrupted.
+ */
+static void __set_timer(struct timer_wheel *w, ticks_t ticks)
 {
-	struct timer_node *ti = (struct timer_node *)get_node(&node_root);
-	ti->timer.ticks = ticks;
-	/* preliminary ID, may change after actual insertion */
-	ti->timer.cid = ticks;
-	ti->timer.tid = tid;
-	return __insert_timer(ti);
+	w->armed = ticks;
+
+	ticks_t due = profile_due();
+	set_timer(due < ticks ? due : ticks);
+}
+
+void refresh_timer()
+{
+	struct timer_wheel *w = __cpu_wheel();
+	__set_timer(w, w->armed);
+}
+
+/**
+ * Program hardware timer for whichever event is due next on this core, if
+ * any.
+ */
+static void __rearm_timer()
+{
+	struct timer_wheel *w = __cpu_wheel();
+	if (!list_empty(&w->expired)) {
+		/* still have stuff to handle, interrupt us as soon as possible */
+		__set_timer(w, current_ticks());
+		return;
+	}
+
+	/* if there's nothing to wait for, the timer is pushed as far into the
+	 * future as possible so we don't keep getting interrupts */
+	__set_timer(w, __next_event(w));
+}
+
+/**
+ * Pick expiry for timer with slack.
+ *
+ * Out of all timepoints in the allowed window, pick the one with the most
+ * trailing zero bits. Timers with overlapping windows are then likely to land
+ * on the exact same tick, and can be handled with a single interrupt.
+ *
+ * @param ticks Earliest allowed expiry.
+ * @param slack Number of ticks expiry can be delayed by.
+ * @return Expiry within [\p ticks, \p ticks + \p slack].
+ */
+static ticks_t __apply_slack(ticks_t ticks, ticks_t slack)
+{
+	ticks_t limit = ticks + slack;
+	if (limit < ticks)
+		limit = (ticks_t)-1;
+
+	if (limit == ticks)
+		return ticks;
+
+	/* highest bit where ticks and limit differ, ticks has it cleared and
+	 * limit has it set */
+	ticks_t diff = ticks ^ limit;
+	ticks_t top = 1;
+	while (diff >>= 1)
+		top <<= 1;
+
+	return limit & ~(top - 1);
 }
 
 /* these are likely not perfectly accurate timers due to some random delay from
  * function calls etc, but probably good enough. */
-id_t new_rel_timer(id_t tid, ticks_t ticks)
+id_t new_rel_timer(id_t tid, ticks_t ticks, ticks_t slack)
+{
+	return new_abs_timer(tid, ticks + current_ticks(), slack);
+}
+
+id_t new_abs_timer(id_t tid, ticks_t ticks, ticks_t slack)
+{
+	id_t id = __new_timer(tid, __apply_slack(ticks, slack), false);
+	/* some other timer might be due before us */
+	__rearm_timer();
+	return id;
+}
+
+id_t new_periodic_timer(id_t tid, ticks_t period)
 {
-	return new_abs_timer(tid, ticks + current_ticks());
+	id_t id = __new_timer(tid, period + current_ticks(), false);
+	find_timer(id)->period = period;
+	__rearm_timer();
+	return id;
 }
 
-id_t new_abs_timer(id_t tid, ticks_t ticks)
+id_t new_wait_timer(id_t tid, ticks_t ticks)
 {
-	id_t id = __new_timer(tid, ticks);
-	set_timer(ticks);
+	id_t id = __new_timer(tid, ticks + current_ticks(), true);
+	__rearm_timer();
 	return id;
 }
 
 struct timer *newest_timer()
 {
-	struct sp_node *t = sp_first(sp_root(__cpu_timers()));
-	return &timer_container(t)->timer;
+	struct timer_wheel *w = __cpu_wheel();
+	__wheel_advance(w, current_ticks());
+
+	struct list_head *e = list_front(&w->expired);
+	if (!e)
+		return NULL;
+
+	return &timer_container(e)->timer;
 }
 
 struct timer *find_timer(id_t cid)
 {
-	struct sp_node *n = sp_root(__cpu_timers());
-	while (n) {
-		struct timer_node *t = timer_container(n);
-		if (t->timer.cid == cid)
-			return &t->timer;
+	if (cid <= 0)
+		return NULL;
 
-		if (t->timer.cid < cid)
-			n = sp_left(n);
-		else
-			n = sp_right(n);
-	}
+	struct timer_node *n = *__bucket(cid);
+	while (n && n->timer.cid != cid)
+		n = n->next;
 
-	return 0;
+	return n ? &n->timer : NULL;
 }
 
 stat_t remove_timer(struct timer *t)
@@ -184,9 +562,10 @@ stat_t remove_timer(struct timer *t)
 	if (!t)
 		return ERR_INVAL;
 
-	struct sp_node *n = &timer_node_container(t)->sp_n;
-	sp_remove(&sp_root(__cpu_timers()), n);
-	free_node(&node_root, t);
+	struct timer_node *n = timer_node_container(t);
+	__del_node(n);
+	__unindex_timer(n);
+	free_node(&node_root, n);
 	return OK;
 }
 
@@ -196,23 +575,130 @@ ticks_t nsecs_to_ticks(tunit_t nsecs)
 	return t == 0 ? 1 : t;
 }
 
+/**
+ * Move periodic timer to its next period.
+ * The next expiry is always counted from the previous expiry, not from when
+ * we got around to handling it, so the timer doesn't drift. If we're so late
+ * that whole periods have passed, they're skipped and counted as overruns.
+ *
+ * @param n Expired periodic timer node.
+ * @param now Current ticks.
+ */
+static void __next_period(struct timer_node *n, ticks_t now)
+{
+	struct timer *t = &n->timer;
+	t->ticks += t->period;
+	if (t->ticks <= now) {
+		ticks_t missed = (now - t->ticks) / t->period + 1;
+		t->ticks += missed * t->period;
+		t->overruns += missed;
+	}
+
+	__del_node(n);
+	n->batched = false;
+	__wheel_insert(__cpu_wheel(), n);
+}
+
+/**
+ * First pass over expired timers.
+ *
+ * Timeouts are handled immediately, as they never swap us out. Timers that
+ * should send a notification are coalesced so that each thread only keeps one
+ * timer on the expired list, the rest are freed.
+ *
+ * @param w Wheel whose expired timers to go through.
+ * @param now Current ticks.
+ */
+static void __batch_expired(struct timer_wheel *w, ticks_t now)
+{
+	struct list_head *e = w->expired.next;
+	while (e != &w->expired) {
+		struct timer_node *n = timer_container(e);
+		e = e->next;
+
+		if (n->batched)
+			continue;
+
+		id_t cid = n->timer.cid;
+		id_t tid = n->timer.tid;
+		struct tcb *r = get_tcb(tid);
+		if (!r || orphan(r)) {
+			info("tcb %llu dead at timer\n",
+			     (unsigned long long)tid);
+			remove_timer(&n->timer);
+			continue;
+		}
+
+		if (n->timer.wait) {
+			remove_timer(&n->timer);
+			wait_timeout(r, cid);
+			continue;
+		}
+
+		/* thread already has a timer notification on the way */
+		if (is_set(r->notify_flags, NOTIFY_TIMER)) {
+			if (n->timer.period) {
+				n->timer.overruns++;
+				__next_period(n, now);
+			}
+			else
+				remove_timer(&n->timer);
+
+			continue;
+		}
+
+		set_bits(r->notify_flags, NOTIFY_TIMER);
+		n->batched = true;
+	}
+}
+
 /* call to this function from exception handlers */
 void handle_timer()
 {
+	/* make sure deferred messages get out eventually even if we never
+	 * idle, while we're not holding the lock */
+	dbg_flush();
+
+	/* only the profiler wanted to be woken up, no need to go through the
+	 * wheel or take the lock. armed is only touched by this core so reading
+	 * it without the lock is fine. */
+	struct timer_wheel *w = __cpu_wheel();
+	ticks_t now = current_ticks();
+	if (now < w->armed) {
+		refresh_timer();
+		return;
+	}
+
 	/** @todo should this also disable irqs? */
 	bkl_lock();
-	struct timer *t = newest_timer();
-	id_t tid = t->tid;
-	remove_timer(t);
-
-	struct tcb *r = get_tcb(tid);
-	if (!r || orphan(r)) {
-		info("tcb %llu dead at timer\n",
-		     (unsigned long long)tid);
-		bkl_unlock();
-		return;
+	kdata_cpu()->timers++;
+	tick_kdata();
+
+	now = current_ticks();
+	trace(TRACE_TIMER, now, 0);
+	__wheel_advance(w, now);
+	__batch_expired(w, now);
+
+	/* now send out one notification per thread. Notifications might swap
+	 * us out, but whatever is left over stays on the expired list and the
+	 * timer is rearmed to fire immediately, so we'll get back here as soon
+	 * as we return to userspace */
+	struct list_head *e;
+	while ((e = list_front(&w->expired))) {
+		struct timer_node *n = timer_container(e);
+		struct tcb *r = get_tcb(n->timer.tid);
+		if (n->timer.period)
+			__next_period(n, now);
+		else
+			remove_timer(&n->timer);
+
+		__rearm_timer();
+
+		/* might've died in the meantime */
+		if (r)
+			notify(r, NOTIFY_TIMER);
 	}
 
-	notify(r, NOTIFY_TIMER);
+	__rearm_timer();
 	bkl_unlock();
 }
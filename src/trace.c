@@ -0,0 +1,148 @@
+/* SPDX-License-Identifier: copyleft-next-0.3.1 */
+/* Copyright 2024, Kim Kuparinen < kimi.h.kuparinen@gmail.com > */
+
+/**
+ * @file trace.c
+ *
+ * Kernel event tracing implementation. Each ring has exactly one producer,
+ * the core it belongs to, and since the kernel doesn't take interrupts,
+ * recording an event can't be interrupted by another one. The consumer is
+ * whoever calls \ref trace_drain() with the big kernel lock held, so the
+ * rings themselves don't need any locks, just some care with memory ordering.
+ */
+
+#include <kmi/atomic.h>
+#include <kmi/trace.h>
+#include <kmi/timer.h>
+#include <kmi/pmem.h>
+#include <kmi/tcb.h>
+#include <kmi/mem.h>
+
+#include <arch/timer.h>
+#include <arch/cpu.h>
+
+#if defined(KERNEL_TRACE)
+
+/** Trace ring buffer of one core. */
+struct trace_ring {
+	/** Records written by the core, only ever incremented. */
+	size_t head;
+
+	/** Records drained, only ever incremented. */
+	size_t tail;
+
+	/** Records dropped since last drain. */
+	size_t dropped;
+
+	/** Buffer of \ref entries records. */
+	struct sys_trace_rec *rec;
+};
+
+bool trace_enabled = false;
+
+/** Trace rings, one per core. */
+static struct trace_ring rings[MAX_CPUS] = { 0 };
+
+/** Number of records in each ring, power of two. */
+static size_t entries = 0;
+
+/** Order of page backing all rings. */
+#define TRACE_ORDER MM_O1
+
+void trace_record(enum sys_trace_event event, unsigned long long a0,
+                  unsigned long long a1)
+{
+	struct tcb *t = cur_tcb();
+	struct trace_ring *r = &rings[t->cpu_id];
+
+	size_t head = r->head;
+	size_t tail = atomic_load_explicit(&r->tail, memory_order_acquire);
+	if (head - tail >= entries) {
+		atomic_fetch_add_explicit(&r->dropped, 1, memory_order_relaxed);
+		return;
+	}
+
+	r->rec[head & (entries - 1)] = (struct sys_trace_rec){
+		.ticks = current_ticks(),
+		.event = event,
+		.cpu = t->cpu_id,
+		.tid = t->tid,
+		.a0 = a0,
+		.a1 = a1
+	};
+
+	/* publish record only after it's been written */
+	atomic_store_explicit(&r->head, head + 1, memory_order_release);
+}
+
+stat_t trace_start()
+{
+	if (!entries) {
+		pm_t page = alloc_page(TRACE_ORDER);
+		if (!page)
+			return ERR_OOMEM;
+
+		/* split page evenly between all cores, rounding down to a
+		 * power of two so we can mask indexes */
+		size_t n = order_size(TRACE_ORDER) / MAX_CPUS
+		           / sizeof(struct sys_trace_rec);
+		size_t p = 1;
+		while (p * 2 <= n)
+			p *= 2;
+
+		struct sys_trace_rec *rec = (struct sys_trace_rec *)page;
+		for (size_t i = 0; i < MAX_CPUS; ++i)
+			rings[i].rec = rec + i * p;
+
+		entries = p;
+	}
+
+	atomic_store_explicit(&trace_enabled, true, memory_order_release);
+	return OK;
+}
+
+void trace_stop()
+{
+	atomic_store_explicit(&trace_enabled, false, memory_order_release);
+}
+
+stat_t trace_drain(id_t cpu, struct vmem *l, vm_t buf, size_t max,
+                   size_t *drained, size_t *dropped)
+{
+	if (cpu < 0 || cpu >= MAX_CPUS)
+		return ERR_INVAL;
+
+	*drained = 0;
+	*dropped = 0;
+
+	/* never started */
+	if (!entries)
+		return OK;
+
+	struct trace_ring *r = &rings[cpu];
+	size_t head = atomic_load_explicit(&r->head, memory_order_acquire);
+	size_t tail = r->tail;
+
+	size_t n = 0;
+	while (tail + n != head && n < max) {
+		struct sys_trace_rec *e = &r->rec[(tail + n) & (entries - 1)];
+		vm_t dst = buf + n * sizeof(*e);
+		if (copy_user(l, dst, NULL, (vm_t)e, sizeof(*e)) != sizeof(*e))
+			break;
+
+		n++;
+	}
+
+	/* free up space for the core only after we've copied things out */
+	atomic_store_explicit(&r->tail, tail + n, memory_order_release);
+
+	*drained = n;
+	*dropped = atomic_exchange_explicit(&r->dropped, 0,
+	                                    memory_order_relaxed);
+	if (n == 0 && head != tail)
+		return ERR_ADDR;
+
+	return OK;
+}
+
+#endif /* KERNEL_TRACE */
@@ -8,12 +8,19 @@
  * At the moment there are not runtime configuration parameters.
  */
 
+#include <kmi/sysstats.h>
 #include <kmi/power.h>
+#include <kmi/profile.h>
 #include <kmi/sizes.h>
+#include <kmi/timer.h>
+#include <kmi/pmem.h>
+#include <kmi/trace.h>
+#include <kmi/pmu.h>
 #include <kmi/uapi.h>
 #include <kmi/conf.h>
 #include <kmi/bkl.h>
 #include <arch/irq.h>
+#include <arch/pmu.h>
 
 #include <arch/proc.h>
 
@@ -36,6 +43,22 @@ size_t rpc_stack_size()
 	return __rpc_stack_size;
 }
 
+/**
+ * Get node pool for statistics.
+ *
+ * @param pool Pool to get, see \ref conf_nodes.
+ * @return Node root of \p pool, \c NULL if \p pool is invalid.
+ */
+static struct node_root *__nodes(sys_arg_t pool)
+{
+	switch (pool) {
+	case NODES_REGIONS: return mem_nodes();
+	case NODES_TIMERS: return timer_nodes();
+	}
+
+	return NULL;
+}
+
 /**
  * Configuration parameter read syscall handler.
  *
@@ -81,6 +104,58 @@ SYSCALL_DEFINE2(get_conf)(struct tcb *t, sys_arg_t param, sys_arg_t d0)
 		val = max_tcbs();
 		break;
 
+	case CONF_RAM_USED_PAGES:
+		if (d0 < 0 || d0 > max_order()) {
+			val = 0;
+			break;
+		}
+
+		val = query_used_pages(d0);
+		break;
+
+	case CONF_RAM_FREE_PAGES:
+		if (d0 < 0 || d0 > max_order()) {
+			val = 0;
+			break;
+		}
+
+		val = query_free_pages(d0);
+		break;
+
+	case CONF_RAM_LARGEST_FREE:
+		val = query_largest_free();
+		break;
+
+	case CONF_NODES_USED: {
+		struct node_root *r = __nodes(d0);
+		val = r ? r->used : 0;
+		break;
+	}
+
+	case CONF_NODES_CAPACITY: {
+		struct node_root *r = __nodes(d0);
+		val = r ? r->regions * r->max_nodes : 0;
+		break;
+	}
+
+	case CONF_NODES_PAGES: {
+		struct node_root *r = __nodes(d0);
+		val = r ? r->regions : 0;
+		break;
+	}
+
+	case CONF_THREADS:
+		val = alive_tcbs();
+		break;
+
+	case CONF_PAGE_TABLES:
+		val = page_tables();
+		break;
+
+	case CONF_RPC_STACK_USAGE:
+		val = rpc_stack_usage();
+		break;
+
 	default:
 		return_args1(t, ERR_NF);
 	}
@@ -124,6 +199,180 @@ SYSCALL_DEFINE2(set_conf)(struct tcb *t, sys_arg_t param, sys_arg_t val)
 	return_args1(t, OK);
 }
 
+/**
+ * Syscall statistics syscall handler.
+ *
+ * @param t Current tcb.
+ * @param op Operation, see \ref sys_syscall_stats_op.
+ * @param num Syscall to get counters of.
+ * @param buf Where to write counters.
+ * @return \ref OK and \c 0 on success, error and \c 0 otherwise.
+ */
+SYSCALL_DEFINE3(syscall_stats)(struct tcb *t, sys_arg_t op, sys_arg_t num,
+                               sys_arg_t buf)
+{
+	struct sys_syscall_stats st;
+	stat_t r = OK;
+	switch (op) {
+	case SYSCALL_STATS_GET:
+		if ((r = sysstats_get(num, &st)))
+			return_args1(t, r);
+
+		struct vmem *l = get_cproc(t)->uvmem.vmem;
+		if (copy_user(l, buf, NULL, (vm_t)&st, sizeof(st)) != sizeof(st))
+			return_args1(t, ERR_ADDR);
+
+		break;
+
+	case SYSCALL_STATS_RESET:
+		if (!has_cap(t->caps, CAP_CONF))
+			return_args1(t, ERR_PERM);
+
+		/* see if we're compiled in at all */
+		if ((r = sysstats_get(0, &st)))
+			return_args1(t, r);
+
+		sysstats_reset();
+		break;
+
+	default:
+		return_args1(t, ERR_INVAL);
+	}
+
+	return_args1(t, OK);
+}
+
+/**
+ * Trace syscall handler.
+ *
+ * @param t Current tcb.
+ * @param op Operation, see \ref sys_trace_op.
+ * @param cpu Core whose events to drain.
+ * @param buf Where to write events.
+ * @param max Maximum number of events to write.
+ * @return \ref OK, number of events written and number of events dropped
+ * since last drain on success, error otherwise.
+ */
+SYSCALL_DEFINE4(trace)(struct tcb *t, sys_arg_t op, sys_arg_t cpu,
+                       sys_arg_t buf, sys_arg_t max)
+{
+	if (!has_cap(t->caps, CAP_CONF))
+		return_args1(t, ERR_PERM);
+
+	stat_t r = OK;
+	size_t drained = 0, dropped = 0;
+	switch (op) {
+	case TRACE_START:
+		r = trace_start();
+		break;
+
+	case TRACE_STOP:
+		trace_stop();
+		break;
+
+	case TRACE_DRAIN:
+		r = trace_drain(cpu, get_cproc(t)->uvmem.vmem, buf, max,
+		                &drained, &dropped);
+		break;
+
+	default:
+		r = ERR_INVAL;
+	}
+
+	return_args3(t, r, drained, dropped);
+}
+
+/**
+ * Performance counter syscall handler.
+ *
+ * @param t Current tcb.
+ * @param op Operation, see \ref sys_pmu_op.
+ * @param a Operation specific argument.
+ * @param b Operation specific argument.
+ * @return See \ref sys_pmu().
+ */
+SYSCALL_DEFINE3(pmu)(struct tcb *t, sys_arg_t op, sys_arg_t a, sys_arg_t b)
+{
+	switch (op) {
+	case PMU_NUM:
+		return_args2(t, OK, pmu_counters());
+
+	case PMU_INFO: {
+		unsigned long csr = 0;
+		size_t width = 0;
+		stat_t r = pmu_counter_info(a, &csr, &width);
+		return_args3(t, r, csr, width);
+	}
+
+	case PMU_READ: {
+		unsigned long long count = 0;
+		stat_t r = pmu_count(t, a, &count);
+		return_args2(t, r, count);
+	}
+	}
+
+	if (!has_cap(t->caps, CAP_CONF))
+		return_args1(t, ERR_PERM);
+
+	switch (op) {
+	case PMU_CONFIG: {
+		size_t idx = 0;
+		stat_t r = pmu_config(a, b, &idx);
+		return_args2(t, r, idx);
+	}
+
+	case PMU_RELEASE:
+		return_args1(t, pmu_release(a));
+
+	case PMU_USER:
+		pmu_set_user(a);
+		return_args1(t, OK);
+	}
+
+	return_args1(t, ERR_INVAL);
+}
+
+/**
+ * Profile syscall handler.
+ *
+ * @param t Current tcb.
+ * @param op Operation, see \ref sys_profile_op.
+ * @param a Ticks between samples for \ref PROFILE_START, core whose samples
+ * to drain for \ref PROFILE_DRAIN.
+ * @param buf Where to write samples.
+ * @param max Maximum number of samples to write.
+ * @return \ref OK, number of samples written and number of samples dropped
+ * since last drain on success, error otherwise.
+ */
+SYSCALL_DEFINE4(profile)(struct tcb *t, sys_arg_t op, sys_arg_t a,
+                         sys_arg_t buf, sys_arg_t max)
+{
+	if (!has_cap(t->caps, CAP_CONF))
+		return_args1(t, ERR_PERM);
+
+	stat_t r = OK;
+	size_t drained = 0, dropped = 0;
+	switch (op) {
+	case PROFILE_START:
+		r = profile_start(a);
+		break;
+
+	case PROFILE_STOP:
+		profile_stop();
+		break;
+
+	case PROFILE_DRAIN:
+		r = profile_drain(a, get_cproc(t)->uvmem.vmem, buf, max,
+		                  &drained, &dropped);
+		break;
+
+	default:
+		r = ERR_INVAL;
+	}
+
+	return_args3(t, r, drained, dropped);
+}
+
 /**
  * Poweroff syscall handler.
  *
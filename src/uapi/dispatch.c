@@ -6,7 +6,11 @@
  * Syscall dispatch.
  */
 
+#include <kmi/sysstats.h>
+#include <kmi/profile.h>
 #include <kmi/canary.h>
+#include <kmi/trace.h>
+#include <kmi/kdata.h>
 #include <kmi/debug.h>
 #include <kmi/uapi.h>
 
@@ -44,6 +48,12 @@ void handle_syscall(sys_arg_t syscall, sys_arg_t a, sys_arg_t b,
                     sys_arg_t c, sys_arg_t d, sys_arg_t e, struct tcb *t)
 {
 	adjust_syscall(t);
+	kdata_cpu()->syscalls++;
+	t->acct.s.syscalls++;
+	sysstats_enter(t, syscall);
+	profile_syscall(t, syscall);
+	trace(TRACE_SYSCALL, syscall, a);
+	update_kdata();
 
 	switch (syscall) {
 	case SYS_NOOP: sys_noop(t, a, b, c, d, e); break;
@@ -55,25 +65,38 @@ void handle_syscall(sys_arg_t syscall, sys_arg_t a, sys_arg_t b,
 	case SYS_REQ_SHAREDMEM: sys_req_sharedmem(t, a, b, c, d, e); break;
 	case SYS_REF_SHAREDMEM: sys_ref_sharedmem(t, a, b, c, d, e); break;
 	case SYS_FREE_MEM: sys_free_mem(t, a, b, c, d, e); break;
+	case SYS_COPY_MEM: sys_copy_mem(t, a, b, c, d, e); break;
 	case SYS_TIMEBASE: sys_timebase(t, a, b, c, d, e); break;
 	case SYS_TICKS: sys_ticks(t, a, b, c, d, e); break;
 	case SYS_REQ_REL_TIMER: sys_req_rel_timer(t, a, b, c, d, e); break;
 	case SYS_REQ_ABS_TIMER: sys_req_abs_timer(t, a, b, c, d, e); break;
+	case SYS_REQ_PERIODIC_TIMER:
+		sys_req_periodic_timer(t, a, b, c, d, e); break;
 	case SYS_FREE_TIMER: sys_free_timer(t, a, b, c, d, e); break;
+	case SYS_TIMER_OVERRUN: sys_timer_overrun(t, a, b, c, d, e); break;
 	case SYS_IPC_REQ: sys_ipc_req(t, a, b, c, d, e); break;
 	case SYS_IPC_FWD: sys_ipc_fwd(t, a, b, c, d, e); break;
 	case SYS_IPC_TAIL: sys_ipc_tail(t, a, b, c, d, e); break;
 	case SYS_IPC_KICK: sys_ipc_kick(t, a, b, c, d, e); break;
 	case SYS_IPC_RESP: sys_ipc_resp(t, a, b, c, d, e); break;
 	case SYS_IPC_NOTIFY: sys_ipc_notify(t, a, b, c, d, e); break;
+	case SYS_IPC_VEC: sys_ipc_vec(t, a, b, c, d, e); break;
+	case SYS_IPC_DRAIN: sys_ipc_drain(t, a, b, c, d, e); break;
+	case SYS_WAIT: sys_wait(t, a, b, c, d, e); break;
+	case SYS_WAKE: sys_wake(t, a, b, c, d, e); break;
 	case SYS_SET_HANDLER: sys_set_handler(t, a, b, c, d, e); break;
 	case SYS_CREATE: sys_create(t, a, b, c, d, e); break;
 	case SYS_FORK: sys_fork(t, a, b, c, d, e); break;
 	case SYS_EXEC: sys_exec(t, a, b, c, d, e); break;
 	case SYS_SPAWN: sys_spawn(t, a, b, c, d, e); break;
 	case SYS_SWAP: sys_swap(t, a, b, c, d, e); break;
+	case SYS_THREAD_STATS: sys_thread_stats(t, a, b, c, d, e); break;
 	case SYS_SET_CONF: sys_set_conf(t, a, b, c, d, e); break;
 	case SYS_GET_CONF: sys_get_conf(t, a, b, c, d, e); break;
+	case SYS_SYSCALL_STATS: sys_syscall_stats(t, a, b, c, d, e); break;
+	case SYS_TRACE: sys_trace(t, a, b, c, d, e); break;
+	case SYS_PMU: sys_pmu(t, a, b, c, d, e); break;
+	case SYS_PROFILE: sys_profile(t, a, b, c, d, e); break;
 	case SYS_SET_CAP: sys_set_cap(t, a, b, c, d, e); break;
 	case SYS_GET_CAP: sys_get_cap(t, a, b, c, d, e); break;
 	case SYS_CLEAR_CAP: sys_clear_cap(t, a, b, c, d, e); break;
@@ -81,8 +104,10 @@ void handle_syscall(sys_arg_t syscall, sys_arg_t a, sys_arg_t b,
 	case SYS_SLEEP: sys_sleep(t, a, b, c, d, e); break;
 	case SYS_IRQ_REQ: sys_irq_req(t, a, b, c, d, e); break;
 	case SYS_FREE_IRQ: sys_free_irq(t, a, b, c, d, e); break;
+	case SYS_IRQ_AFFINITY: sys_irq_affinity(t, a, b, c, d, e); break;
 	case SYS_DETACH: sys_detach(t, a, b, c, d, e); break;
 	case SYS_EXIT: sys_exit(t, a, b, c, d, e); break;
+	case SYS_RING_ENTER: sys_ring_enter(t, a, b, c, d, e); break;
 	default:
 		error("Syscall %zu outside allowed range [0 - %i]\n", syscall,
 		      SYS_NUM - 1);
@@ -8,12 +8,15 @@
 
 #include <kmi/orphanage.h>
 #include <kmi/debug.h>
+#include <kmi/trace.h>
+#include <kmi/acct.h>
 #include <kmi/uapi.h>
 #include <kmi/bkl.h>
 #include <kmi/tcb.h>
 #include <kmi/ipi.h>
 #include <kmi/irq.h>
 #include <kmi/conf.h>
+#include <kmi/vmem.h>
 
 /**
  * Represents difference between where rpc stack was before rpc call and during.
@@ -35,6 +38,8 @@ enum ipc_flags {
 	/** Don't update the effective ID. */
 	IPC_FORWARD = (1 << 1),
 	IPC_NOTIFY = (1 << 2),
+	/** Part of a \ref sys_ipc_vec() batch. */
+	IPC_BATCH = (1 << 3),
 };
 
 /**
@@ -70,6 +75,7 @@ static __inline void enter_rpc(struct tcb *t, struct tcb *r, struct sys_ret a,
 		ctx->pid = t->pid;
 		ctx->eid = t->eid;
 		ctx->notify = flags & IPC_NOTIFY;
+		ctx->batch = flags & IPC_BATCH;
 		new_rpc(t);
 	}
 	else {
@@ -88,6 +94,8 @@ static __inline void enter_rpc(struct tcb *t, struct tcb *r, struct sys_ret a,
 
 	set_return(t, r->callback);
 	reference_thread(r);
+	acct_migrate(t);
+	trace(TRACE_RPC_ENTER, r->rid, t->pid);
 	t->pid = r->rid;
 }
 
@@ -136,9 +144,15 @@ static __noreturn void __run_notify(struct tcb *t, struct tcb *r)
 		disable_irqs();
 	}
 
+	/* let the handler know how many queued notifications it can expect to
+	 * drain, so it can size its buffer accordingly */
+	struct tcb_notify *q = &t->notify_queue;
+	sys_arg_t queued = is_set(flags, NOTIFY_SIGNAL) ? q->tail - q->head : 0;
+
 	/* signal to whoever is receiving us that we're from the kernel
 	 * ("pid 0"), and we are notifying the current thread */
-	enter_rpc(t, r, SYS_RET5(0, t->tid, code, flags, t->eid), IPC_NOTIFY);
+	enter_rpc(t, r, SYS_RET6(0, t->tid, code, flags, t->eid, queued),
+	          IPC_NOTIFY);
 
 	clear_bits(t->notify_flags, flags);
 
@@ -155,10 +169,12 @@ void notify(struct tcb *t, enum notify_flag flags)
 	if (!t->notify_flags)
 		return;
 
+	trace(TRACE_NOTIFY, t->tid, t->notify_flags);
 	struct tcb *r = get_tcb(t->notify_id);
 	if (!r || r->state || !r->callback) {
 		error("notify callback unavailable\n");
 		t->notify_flags = 0;
+		t->notify_queue.head = t->notify_queue.tail;
 		return;
 	}
 
@@ -184,6 +200,69 @@ void notify(struct tcb *t, enum notify_flag flags)
 	__run_notify(t, r);
 }
 
+/**
+ * Write completion of current batch request to the caller's completion array
+ * and move on to the next request.
+ *
+ * @param t Thread running the batch.
+ * @param b Batch state.
+ * @param a Completion of current request.
+ * @return \c true if completion could be written, \c false otherwise.
+ */
+static bool __batch_complete(struct tcb *t, struct ipc_batch *b,
+                             struct sys_ret a)
+{
+	struct vmem *l = get_cproc(t)->uvmem.vmem;
+	vm_t e = b->comp + b->idx * sizeof(a);
+	if (copy_user(l, e, NULL, (vm_t)&a, sizeof(a)) != sizeof(a))
+		return false;
+
+	b->idx++;
+	return true;
+}
+
+/**
+ * Start next request in batch.
+ * Doesn't return if a request could be started, otherwise sets return values
+ * for the caller of \ref sys_ipc_vec().
+ *
+ * @param t Thread running the batch.
+ * @param b Batch state.
+ */
+static void __batch_next(struct tcb *t, struct ipc_batch b)
+{
+	struct vmem *l = get_cproc(t)->uvmem.vmem;
+	while (b.idx < b.count) {
+		struct sys_ipc_desc d;
+		vm_t e = b.vec + b.idx * sizeof(d);
+		if (copy_user(NULL, (vm_t)&d, l, e, sizeof(d)) != sizeof(d))
+			return_args2(t, ERR_ADDR, b.idx);
+
+		struct tcb *r = get_tcb(d.pid);
+		if (unlikely(!r || !is_proc(r) || zombie(r))) {
+			if (!__batch_complete(t, &b, SYS_RET1(ERR_INVAL)))
+				return_args2(t, ERR_ADDR, b.idx);
+
+			continue;
+		}
+
+		if (!__enough_rpc_stack(t))
+			return_args2(t, ERR_OOMEM, b.idx);
+
+		enter_rpc(t, r, SYS_RET6(t->pid, t->tid, d.d0, d.d1, d.d2, d.d3),
+		          IPC_BATCH);
+
+		struct call_ctx *ctx = (struct call_ctx *)(t->rpc_stack) - 1;
+		ctx->b = b;
+
+		enable_irqs();
+		bkl_unlock();
+		ret_userspace_fast();
+	}
+
+	return_args2(t, OK, b.idx);
+}
+
 /**
  * Jump back to process where rpc came from, assuming such a thing exists.
  * If we're queued for a notification, jump to it instead.
@@ -205,12 +284,16 @@ static void leave_rpc(struct tcb *t, struct sys_ret a)
 	if (!ctx->notify)
 		set_ret_fast(t, a);
 
+	bool orphaned = false;
 	struct tcb *r = get_tcb(ctx->pid);
 	while (!r || !is_proc(r) || zombie(r)) {
+		a = SYS_RET1(ERR_NF);
+
 		/* we unwound back to our root process which is apparently dead,
 		 * we're orphaned :( */
 		if (rpc_stack_empty(ctx->rpc_stack)) {
 			orphanize(t);
+			orphaned = true;
 			break;
 		}
 
@@ -233,11 +316,28 @@ static void leave_rpc(struct tcb *t, struct sys_ret a)
 	 * no-op */
 	t->rpc_stack = ctx->rpc_stack;
 	destroy_rpc(t);
-	flush_tlb_full();
 
+	acct_migrate(t);
+	trace(TRACE_RPC_LEAVE, ctx->pid, t->pid);
 	t->pid = ctx->pid;
 	t->eid = ctx->eid;
 
+	/* if there are more requests in the batch, __batch_next() jumps
+	 * directly into the next server and we can skip flushing the TLB here,
+	 * as enter_rpc() does it for us anyway. If some process along the way
+	 * died, the loop above has already unwound to a live context with
+	 * ERR_NF in a, which becomes the completion and the batch carries on.
+	 * Only if we were orphaned is there nobody to write completions to. */
+	if (unlikely(ctx->batch) && !orphaned) {
+		struct ipc_batch b = ctx->b;
+		if (__batch_complete(t, &b, a))
+			__batch_next(t, b);
+		else
+			set_args2(t, ERR_ADDR, b.idx);
+	}
+
+	flush_tlb_full();
+
 	/* notification queued, try to run it */
 	if (t->notify_flags)
 		notify(t, 0);
@@ -396,15 +496,32 @@ SYSCALL_DEFINE4(ipc_resp)(struct tcb *t, sys_arg_t d0, sys_arg_t d1,
 }
 
 /**
- * Notify syscall handler.
+ * Queue notification with payload.
  *
- * \todo Implement.
+ * @param r Thread to queue notification to.
+ * @param n Notification to queue.
+ * @return \c true if notification was queued, \c false if queue was full.
+ */
+static bool __queue_notify(struct tcb *r, struct sys_notify n)
+{
+	struct tcb_notify *q = &r->notify_queue;
+	if (q->tail - q->head == NOTIFY_QUEUE_SIZE)
+		return false;
+
+	q->ev[q->tail++ & (NOTIFY_QUEUE_SIZE - 1)] = n;
+	return true;
+}
+
+/**
+ * Notify syscall handler.
  *
  * @param t Current tcb.
  * @param tid Thread ID to notify.
- * @return \ref OK and 0.
+ * @param payload Word of data to pass along with notification.
+ * @return \ref OK and 0, \ref ERR_OOMEM if the notification queue of \p tid is
+ * full.
  */
-SYSCALL_DEFINE1(ipc_notify)(struct tcb *t, sys_arg_t tid){
+SYSCALL_DEFINE2(ipc_notify)(struct tcb *t, sys_arg_t tid, sys_arg_t payload){
 	if (t->tid != tid && !has_cap(t->caps, CAP_NOTIFY))
 		return_args1(t, ERR_PERM);
 
@@ -412,8 +529,67 @@ SYSCALL_DEFINE1(ipc_notify)(struct tcb *t, sys_arg_t tid){
 	if (!r)
 		return_args1(t, ERR_INVAL);
 
+	/* receiver is lagging behind, let the sender decide what to do */
+	if (!__queue_notify(r, (struct sys_notify){t->eid, t->tid, payload}))
+		return_args1(t, ERR_OOMEM);
+
 	/* set args, if notify swaps us out we pick them up the next time this
 	 * thread is scheduled */
 	set_args1(t, OK);
 	notify(r, NOTIFY_SIGNAL);
 }
+
+/**
+ * Drain notifications syscall handler.
+ *
+ * @param t Current tcb.
+ * @param buf Array of \ref sys_notify to write notifications to.
+ * @param max Maximum number of notifications to write.
+ * @return \ref OK and number of notifications written. \ref ERR_ADDR and
+ * number of notifications written if \p buf runs into inaccessible memory.
+ */
+SYSCALL_DEFINE2(ipc_drain)(struct tcb *t, sys_arg_t buf, sys_arg_t max)
+{
+	if (max < 0)
+		return_args1(t, ERR_INVAL);
+
+	struct vmem *l = get_cproc(t)->uvmem.vmem;
+	struct tcb_notify *q = &t->notify_queue;
+	sys_arg_t n = 0;
+	while (n < max && q->head != q->tail) {
+		struct sys_notify *e = &q->ev[q->head & (NOTIFY_QUEUE_SIZE - 1)];
+		vm_t dst = buf + n * sizeof(*e);
+		if (copy_user(l, dst, NULL, (vm_t)e, sizeof(*e)) != sizeof(*e))
+			return_args2(t, ERR_ADDR, n);
+
+		q->head++;
+		n++;
+	}
+
+	/* everything's been handled, no need to run the handler again for
+	 * these */
+	if (q->head == q->tail)
+		clear_bits(t->notify_flags, NOTIFY_SIGNAL);
+
+	return_args2(t, OK, n);
+}
+
+/**
+ * Vectored IPC syscall handler.
+ *
+ * @param t Current tcb.
+ * @param vec Array of \ref sys_ipc_desc.
+ * @param count Number of elements in \p vec.
+ * @param comp Array of \ref sys_ret, where completions are written.
+ * @return \ref OK and number of completed requests when succesful. If the
+ * batch was aborted, some error and number of requests completed up until
+ * that point.
+ */
+SYSCALL_DEFINE3(ipc_vec)(struct tcb *t, sys_arg_t vec, sys_arg_t count,
+                         sys_arg_t comp)
+{
+	if (count < 0)
+		return_args1(t, ERR_INVAL);
+
+	__batch_next(t, (struct ipc_batch){vec, comp, count, 0});
+}
@@ -43,6 +43,22 @@ SYSCALL_DEFINE1(free_irq)(struct tcb *t, sys_arg_t id)
 	return_args1(t, unregister_irq(t, id));
 }
 
+/**
+ * IRQ affinity syscall handler.
+ *
+ * @param t Current tcb.
+ * @param id ID of IRQ to route.
+ * @param cpu CPU ID of core to route IRQ to.
+ * @return \ref OK on success, non-zero otherwise.
+ */
+SYSCALL_DEFINE2(irq_affinity)(struct tcb *t, sys_arg_t id, sys_arg_t cpu)
+{
+	if (!has_cap(t->caps, CAP_IRQ))
+		return_args1(t, ERR_PERM);
+
+	return_args1(t, set_irq_affinity(t, id, cpu));
+}
+
 /**
  * Actual notification handler setter.
  *
@@ -193,3 +193,89 @@ SYSCALL_DEFINE3(ref_sharedmem)(struct tcb *t, sys_arg_t tid, sys_arg_t addr,
 	flush_tlb_all();
 	return_args2(t, OK, start);
 }
+
+/**
+ * Check whether \p pid is somewhere in the RPC chain of \p t.
+ * Essentially, we're only allowed to poke around in the memory of processes
+ * that have (directly or indirectly) called us, or our own memory.
+ *
+ * @param t Thread whose RPC chain to look through.
+ * @param pid Process to look for.
+ * @return \c true if \p pid was found, \c false otherwise.
+ */
+static bool __in_rpc_chain(struct tcb *t, id_t pid)
+{
+	if (pid == t->pid || pid == t->eid)
+		return true;
+
+	vm_t rpc_stack = t->rpc_stack;
+	while (!rpc_stack_empty(rpc_stack)) {
+		struct call_ctx *ctx = (struct call_ctx *)(rpc_stack) - 1;
+		if (ctx->pid == pid)
+			return true;
+
+		rpc_stack = ctx->rpc_stack;
+	}
+
+	return false;
+}
+
+/**
+ * Copy memory syscall handler.
+ *
+ * @param t Current tcb.
+ * @param pid Remote process.
+ * @param iov Array of \ref sys_iovec in caller's address space.
+ * @param count Number of elements in \p iov.
+ * @param dir Direction of copy, \ref copy_dir.
+ * @return \ref OK and number of bytes copied when succesful, \ref ERR_ADDR
+ * and number of bytes copied up until the faulting fragment if some address
+ * couldn't be accessed.
+ * At most \ref COPY_MEM_MAX_FRAGMENTS fragments and \ref COPY_MEM_MAX_BYTES
+ * bytes are copied in one go, as we're holding the BKL the whole time. If
+ * either limit is hit, \ref OK and the number of bytes copied so far is
+ * returned, and the caller can continue from there.
+ * \ref ERR_PERM if \p pid is not in the RPC chain, \ref ERR_INVAL for an
+ * illegal \p pid or \p dir.
+ */
+SYSCALL_DEFINE4(copy_mem)(struct tcb *t, sys_arg_t pid, sys_arg_t iov,
+                          sys_arg_t count, sys_arg_t dir)
+{
+	if (dir != COPY_FROM && dir != COPY_TO)
+		return_args1(t, ERR_INVAL);
+
+	struct tcb *r = get_tcb(pid);
+	if (!r || !is_proc(r) || zombie(r))
+		return_args1(t, ERR_INVAL);
+
+	if (!__in_rpc_chain(t, pid))
+		return_args1(t, ERR_PERM);
+
+	struct vmem *l = get_cproc(t)->uvmem.vmem;
+	struct vmem *b = r->uvmem.vmem;
+
+	size_t total = 0;
+	count = MIN(count, COPY_MEM_MAX_FRAGMENTS);
+	for (sys_arg_t i = 0; i < count; ++i) {
+		if (total == COPY_MEM_MAX_BYTES)
+			break;
+
+		struct sys_iovec v;
+		vm_t e = iov + i * sizeof(v);
+		if (copy_user(NULL, (vm_t)&v, l, e, sizeof(v)) != sizeof(v))
+			return_args2(t, ERR_ADDR, total);
+
+		size_t size = MIN((size_t)v.size, COPY_MEM_MAX_BYTES - total);
+		size_t copied = 0;
+		if (dir == COPY_FROM)
+			copied = copy_user(l, v.local, b, v.remote, size);
+		else
+			copied = copy_user(b, v.remote, l, v.local, size);
+
+		total += copied;
+		if (copied != size)
+			return_args2(t, ERR_ADDR, total);
+	}
+
+	return_args2(t, OK, total);
+}
@@ -308,3 +308,28 @@ SYSCALL_DEFINE1(swap)(struct tcb *t, sys_arg_t tid){
 
 	return swap(t, s);
 }
+
+/**
+ * Thread statistics syscall handler.
+ *
+ * @param t Current tcb.
+ * @param tid Thread to get statistics of, \c 0 for current thread.
+ * @param buf Where to write \ref sys_stats.
+ * @return \ref OK, \ref ERR_NF if \p tid doesn't exist or \ref ERR_ADDR if
+ * \p buf isn't writable.
+ */
+SYSCALL_DEFINE2(thread_stats)(struct tcb *t, sys_arg_t tid, sys_arg_t buf)
+{
+	struct tcb *s = tid ? get_tcb(tid) : t;
+	if (!s)
+		return_args1(t, ERR_NF);
+
+	/* times only get updated on kernel entry, so what we return is
+	 * accurate up until this syscall */
+	struct vmem *l = get_cproc(t)->uvmem.vmem;
+	struct sys_stats *st = &s->acct.s;
+	if (copy_user(l, buf, NULL, (vm_t)st, sizeof(*st)) != sizeof(*st))
+		return_args1(t, ERR_ADDR);
+
+	return_args1(t, OK);
+}
@@ -0,0 +1,125 @@
+/* SPDX-License-Identifier: copyleft-next-0.3.1 */
+/* Copyright 2021 - 2022, Kim Kuparinen < kimi.h.kuparinen@gmail.com > */
+
+/**
+ * @file ring.c
+ * Submission/completion ring syscall implementation.
+ *
+ * The ring lives in regular user memory, and the kernel walks it with \ref
+ * copy_user() so we don't have to keep track of the ring's lifetime. Each
+ * submission entry is run through the same handlers as a regular syscall, and
+ * the results are picked up from the return registers with \ref get_ret().
+ *
+ * Only syscalls that are guaranteed to return to the caller are allowed,
+ * anything that might migrate or switch threads (IPC, notifications, exec,
+ * etc.) still has to go through a regular trap.
+ */
+
+#include <kmi/uapi.h>
+#include <kmi/vmem.h>
+
+/**
+ * Run one submission entry.
+ *
+ * @param t Current tcb.
+ * @param e Submission entry to run.
+ * @return What the syscall returned.
+ */
+static struct sys_ret __ring_op(struct tcb *t, struct sys_sqe *e)
+{
+	sys_arg_t a = e->a0, b = e->a1, c = e->a2, d = e->a3, f = e->a4;
+	/* most handlers only set the registers they care about, so make sure
+	 * the leftovers from the previous entry don't leak into this one */
+	set_ret(t, 6, SYS_RET0());
+	switch (e->op) {
+	case SYS_NOOP: sys_noop(t, a, b, c, d, f); break;
+	case SYS_REQ_MEM: sys_req_mem(t, a, b, c, d, f); break;
+	case SYS_REQ_PMEM: sys_req_pmem(t, a, b, c, d, f); break;
+	case SYS_REQ_PAGE: sys_req_page(t, a, b, c, d, f); break;
+	case SYS_REQ_FIXMEM: sys_req_fixmem(t, a, b, c, d, f); break;
+	case SYS_REQ_SHAREDMEM: sys_req_sharedmem(t, a, b, c, d, f); break;
+	case SYS_REF_SHAREDMEM: sys_ref_sharedmem(t, a, b, c, d, f); break;
+	case SYS_FREE_MEM: sys_free_mem(t, a, b, c, d, f); break;
+	case SYS_COPY_MEM: sys_copy_mem(t, a, b, c, d, f); break;
+	case SYS_TIMEBASE: sys_timebase(t, a, b, c, d, f); break;
+	case SYS_TICKS: sys_ticks(t, a, b, c, d, f); break;
+	case SYS_REQ_REL_TIMER: sys_req_rel_timer(t, a, b, c, d, f); break;
+	case SYS_REQ_ABS_TIMER: sys_req_abs_timer(t, a, b, c, d, f); break;
+	case SYS_REQ_PERIODIC_TIMER:
+		sys_req_periodic_timer(t, a, b, c, d, f); break;
+	case SYS_FREE_TIMER: sys_free_timer(t, a, b, c, d, f); break;
+	case SYS_TIMER_OVERRUN: sys_timer_overrun(t, a, b, c, d, f); break;
+	case SYS_GET_CONF: sys_get_conf(t, a, b, c, d, f); break;
+	case SYS_GET_CAP: sys_get_cap(t, a, b, c, d, f); break;
+	case SYS_THREAD_STATS: sys_thread_stats(t, a, b, c, d, f); break;
+	default: return SYS_RET1(ERR_INVAL);
+	}
+
+	return get_ret(t);
+}
+
+/**
+ * Ring enter syscall handler.
+ *
+ * @param t Current tcb.
+ * @param ring Address of \ref sys_ring in caller's address space.
+ * @param count Maximum number of submission entries to process.
+ * @return \ref OK and number of entries processed. Processing stops early if
+ * the submission queue runs empty or the completion queue fills up.
+ * \ref ERR_ADDR if the ring couldn't be accessed, \ref ERR_INVAL if the ring
+ * size isn't a power of two.
+ */
+SYSCALL_DEFINE2(ring_enter)(struct tcb *t, sys_arg_t ring, sys_arg_t count)
+{
+	struct vmem *l = get_cproc(t)->uvmem.vmem;
+
+	struct sys_ring h;
+	if (copy_user(NULL, (vm_t)&h, l, ring, sizeof(h)) != sizeof(h))
+		return_args1(t, ERR_ADDR);
+
+	if (h.size <= 0 || (h.size & (h.size - 1)))
+		return_args1(t, ERR_INVAL);
+
+	vm_t sqes = ring + sizeof(struct sys_ring);
+	vm_t cqes = sqes + h.size * sizeof(struct sys_sqe);
+	sys_arg_t mask = h.size - 1;
+
+	stat_t status = OK;
+	sys_arg_t n = 0;
+	while (n < count && h.sq_head != h.sq_tail) {
+		/* completion queue full, userspace has to catch up first */
+		if (h.cq_tail - h.cq_head >= h.size)
+			break;
+
+		struct sys_sqe e;
+		vm_t sqe = sqes + (h.sq_head & mask) * sizeof(e);
+		if (copy_user(NULL, (vm_t)&e, l, sqe, sizeof(e)) != sizeof(e)) {
+			status = ERR_ADDR;
+			break;
+		}
+
+		struct sys_cqe c = {e.user, __ring_op(t, &e)};
+		vm_t cqe = cqes + (h.cq_tail & mask) * sizeof(c);
+		if (copy_user(l, cqe, NULL, (vm_t)&c, sizeof(c)) != sizeof(c)) {
+			status = ERR_ADDR;
+			break;
+		}
+
+		h.sq_head++;
+		h.cq_tail++;
+		n++;
+	}
+
+	/* only write back the fields we own */
+	vm_t sq_head = ring + offsetof(struct sys_ring, sq_head);
+	vm_t cq_tail = ring + offsetof(struct sys_ring, cq_tail);
+	if (copy_user(l, sq_head, NULL, (vm_t)&h.sq_head, sizeof(h.sq_head))
+	    != sizeof(h.sq_head))
+		return_args2(t, ERR_ADDR, n);
+
+	if (copy_user(l, cq_tail, NULL, (vm_t)&h.cq_tail, sizeof(h.cq_tail))
+	    != sizeof(h.cq_tail))
+		return_args2(t, ERR_ADDR, n);
+
+	return_args2(t, status, n);
+}
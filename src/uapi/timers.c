@@ -32,6 +32,19 @@ static ticks_t scaled_ticks(sys_arg_t ticks, sys_arg_t mult)
 #endif
 }
 
+/**
+ * Check whether \p t is allowed to touch \p timer. Timeouts for \ref
+ * sys_wait() are managed by the kernel, so they don't belong to anyone.
+ *
+ * @param t Current tcb.
+ * @param timer Timer to check.
+ * @return \c true if \p t scheduled \p timer, \c false otherwise.
+ */
+static bool __owns_timer(struct tcb *t, struct timer *timer)
+{
+	return !timer->wait && timer->tid == t->tid;
+}
+
 /**
  * Timebase syscall handler.
  *
@@ -80,11 +93,14 @@ SYSCALL_DEFINE0(ticks)(struct tcb *t)
  * @param t Current tcb.
  * @param ticks Number of ticks from now.
  * @param mult Multiply \c ticks by this value.
+ * @param slack Number of ticks timer is allowed to be late.
  * @return \ref OK and \c cid of created timer.
  */
-SYSCALL_DEFINE2(req_rel_timer)(struct tcb *t, sys_arg_t ticks, sys_arg_t mult)
+SYSCALL_DEFINE3(req_rel_timer)(struct tcb *t, sys_arg_t ticks, sys_arg_t mult,
+                               sys_arg_t slack)
 {
-	return_args2(t, OK, new_rel_timer(t->tid, scaled_ticks(ticks, mult)));
+	ticks_t rel = scaled_ticks(ticks, mult);
+	return_args2(t, OK, new_rel_timer(t->tid, rel, (ticks_t)slack));
 }
 
 /**
@@ -93,12 +109,34 @@ SYSCALL_DEFINE2(req_rel_timer)(struct tcb *t, sys_arg_t ticks, sys_arg_t mult)
  * @param t Current tcb.
  * @param ticks Absolute timepoint relative to some start point defined at boot.
  * @param mult Multiply \c ticks by this value.
+ * @param slack Number of ticks timer is allowed to be late.
  * @return \ref OK and \c cid of created timer.
  * \see req_rel_timer().
  */
-SYSCALL_DEFINE2(req_abs_timer)(struct tcb *t, sys_arg_t ticks, sys_arg_t mult)
+SYSCALL_DEFINE3(req_abs_timer)(struct tcb *t, sys_arg_t ticks, sys_arg_t mult,
+                               sys_arg_t slack)
+{
+	ticks_t at = scaled_ticks(ticks, mult);
+	return_args2(t, OK, new_abs_timer(t->tid, at, (ticks_t)slack));
+}
+
+/**
+ * Periodic timer request syscall handler.
+ *
+ * @param t Current tcb.
+ * @param period Period in ticks.
+ * @param mult Multiply \c period by this value.
+ * @return \ref OK and \c cid of created timer, \ref ERR_INVAL if \p period is
+ * zero.
+ */
+SYSCALL_DEFINE2(req_periodic_timer)(struct tcb *t, sys_arg_t period,
+                                    sys_arg_t mult)
 {
-	return_args2(t, OK, new_abs_timer(t->tid, scaled_ticks(ticks, mult)));
+	ticks_t p = scaled_ticks(period, mult);
+	if (!p)
+		return_args1(t, ERR_INVAL);
+
+	return_args2(t, OK, new_periodic_timer(t->tid, p));
 }
 
 /**
@@ -106,8 +144,9 @@ SYSCALL_DEFINE2(req_abs_timer)(struct tcb *t, sys_arg_t ticks, sys_arg_t mult)
  *
  * @param t Current tcb.
  * @param cid \c cid of timer to free.
- * @return \ref ERR_NF and \c 0if no timer could be found with \c cid, \ref OK
- * and 0 otherwise.
+ * @return \ref ERR_NF and \c 0if no timer could be found with \c cid, \ref
+ * ERR_PERM if the timer belongs to some other thread, \ref OK and 0
+ * otherwise.
  */
 SYSCALL_DEFINE1(free_timer)(struct tcb *t, sys_arg_t cid)
 {
@@ -115,6 +154,32 @@ SYSCALL_DEFINE1(free_timer)(struct tcb *t, sys_arg_t cid)
 	if (!timer)
 		return_args1(t, ERR_NF);
 
+	if (!__owns_timer(t, timer))
+		return_args1(t, ERR_PERM);
+
 	remove_timer(timer);
 	return_args1(t, OK);
 }
+
+/**
+ * Timer overrun syscall handler.
+ *
+ * @param t Current tcb.
+ * @param cid \c cid of timer.
+ * @return \ref ERR_NF if no timer could be found with \c cid, \ref ERR_PERM
+ * if the timer belongs to some other thread, \ref OK and number of overruns
+ * since last call otherwise.
+ */
+SYSCALL_DEFINE1(timer_overrun)(struct tcb *t, sys_arg_t cid)
+{
+	struct timer *timer = find_timer(cid);
+	if (!timer)
+		return_args1(t, ERR_NF);
+
+	if (!__owns_timer(t, timer))
+		return_args1(t, ERR_PERM);
+
+	size_t overruns = timer->overruns;
+	timer->overruns = 0;
+	return_args2(t, OK, overruns);
+}
@@ -0,0 +1,130 @@
+/* SPDX-License-Identifier: copyleft-next-0.3.1 */
+/* Copyright 2024, Kim Kuparinen < kimi.h.kuparinen@gmail.com > */
+
+/**
+ * @file wait.c
+ * Wait/wake syscall implementations.
+ *
+ * The kernel doesn't take interrupts while in kernelspace, so a waiting thread
+ * idles its core until some interrupt is pending. If we were woken up by
+ * \ref sys_wake() or our timeout, great, we just return. Otherwise we restart
+ * the syscall and return to userspace, where the interrupt is immediately taken
+ * and handled like usual. Once the thread gets to run again it reissues the
+ * syscall and picks up where it left off.
+ */
+
+#include <kmi/power.h>
+#include <kmi/uapi.h>
+#include <kmi/vmem.h>
+#include <kmi/wait.h>
+#include <kmi/bkl.h>
+#include <kmi/ipi.h>
+#include <kmi/debug.h>
+
+#include <arch/proc.h>
+#include <arch/irq.h>
+
+/**
+ * Resolve user address of wait word.
+ *
+ * @param t Current tcb.
+ * @param addr User address.
+ * @return Kernel address of wait word, \c 0 if \p addr is not accessible.
+ */
+static uint32_t *__wait_word(struct tcb *t, vm_t addr)
+{
+	size_t left = 0;
+	struct vmem *b = get_cproc(t)->uvmem.vmem;
+	return (uint32_t *)user_addr(b, addr, VM_R, &left);
+}
+
+/**
+ * Wait syscall handler.
+ *
+ * @param t Current tcb.
+ * @param addr Address of 32bit word to wait on.
+ * @param expected Value \p addr is expected to have.
+ * @param ticks Relative timeout in ticks, \c 0 to wait forever.
+ * @return \ref OK when woken up or if \p addr didn't hold \p expected,
+ * \ref ERR_TIMEOUT if timed out, \ref ERR_ALIGN if \p addr is misaligned and
+ * \ref ERR_ADDR if \p addr is not accessible.
+ */
+SYSCALL_DEFINE3(wait)(struct tcb *t, sys_arg_t addr, sys_arg_t expected,
+                      sys_arg_t ticks)
+{
+	if (!is_aligned(addr, sizeof(uint32_t)))
+		return_args1(t, ERR_ALIGN);
+
+	uint32_t *w = __wait_word(t, addr);
+	if (!w)
+		return_args1(t, ERR_ADDR);
+
+	pm_t paddr = (pm_t)__pa(w);
+
+	/* restarted wait that finished while we were away, or some stale
+	 * state from a wait that was never restarted */
+	if (t->wait.state != WAIT_NONE && t->wait.addr != paddr)
+		unqueue_wait(t);
+
+	if (t->wait.state == WAIT_NONE) {
+		if (*w != (uint32_t)expected)
+			return_args1(t, OK);
+
+		queue_wait(t, paddr, ticks);
+	}
+
+	enable_irqs();
+	while (t->wait.state == WAIT_SLEEPING) {
+		bkl_unlock();
+		/* as good a time as any to catch up on logging */
+		dbg_flush();
+		idle();
+		bkl_lock();
+
+		if (t->wait.state != WAIT_SLEEPING)
+			break;
+
+		if (irqs_pending()) {
+			/* let the interrupt be handled and come back here
+			 * afterwards */
+			/* the syscall number goes in the first slot, so this
+			 * can't go through return_args4(), which would put a
+			 * status there and shift the arguments over by one */
+			restart_syscall(t);
+			set_ret4(t, SYS_WAIT, addr, expected, ticks);
+			return;
+		}
+	}
+
+	/* whoever woke us up from another core kicked us out of idle() with an
+	 * IPI, which would otherwise trap again on the way out with nothing to
+	 * do */
+	clear_ipi(t);
+
+	stat_t status = t->wait.status;
+	unqueue_wait(t);
+
+	return_args1(t, status);
+}
+
+/**
+ * Wake syscall handler.
+ *
+ * @param t Current tcb.
+ * @param addr Address of 32bit word to wake waiters on.
+ * @param n Maximum number of threads to wake up.
+ * @return \ref OK and number of threads woken up, \ref ERR_ALIGN if \p addr is
+ * misaligned and \ref ERR_ADDR if \p addr is not accessible.
+ */
+SYSCALL_DEFINE2(wake)(struct tcb *t, sys_arg_t addr, sys_arg_t n)
+{
+	if (!is_aligned(addr, sizeof(uint32_t)))
+		return_args1(t, ERR_ALIGN);
+
+	uint32_t *w = __wait_word(t, addr);
+	if (!w)
+		return_args1(t, ERR_ADDR);
+
+	size_t woken = wake_addr((pm_t)__pa(w), n);
+	return_args2(t, OK, woken);
+}
@@ -13,6 +13,7 @@
 #include <kmi/debug.h>
 #include <kmi/bits.h>
 #include <kmi/vmem.h>
+#include <kmi/mem.h>
 #include <arch/vmem.h>
 
 stat_t init_uvmem(struct tcb *t)
@@ -425,6 +426,62 @@ vmflags_t sanitize_uvflags(vmflags_t flags)
 	return (flags & (VM_R | VM_W | VM_X)) | VM_V | VM_U;
 }
 
+vm_t user_addr(struct vmem *b, vm_t v, vmflags_t flags, size_t *left)
+{
+	pm_t addr = 0;
+	vmflags_t pflags = 0;
+	enum mm_order order = BASE_PAGE;
+	if (stat_vpage(b, v, &addr, &order, &pflags))
+		return 0;
+
+	set_bits(flags, VM_U);
+	if ((pflags & flags) != flags)
+		return 0;
+
+	size_t size = order_size(order);
+	size_t offset = v & (size - 1);
+
+	/* user mappings can point at devices or nowhere at all, and touching
+	 * those from the kernel would fault, so only hand out RAM */
+	pm_t p = (pm_t)__pa(addr + offset);
+	pm_t ram_end = get_ram_base() + get_ram_size();
+	if (p < get_ram_base() || p >= ram_end)
+		return 0;
+
+	*left = MIN(size - offset, ram_end - p);
+	return (vm_t)(addr + offset);
+}
+
+size_t copy_user(struct vmem *db, vm_t dst,
+                 struct vmem *sb, vm_t src, size_t size)
+{
+	size_t copied = 0;
+	while (copied < size) {
+		size_t dleft = size - copied;
+		size_t sleft = size - copied;
+		vm_t d = dst + copied;
+		vm_t s = src + copied;
+
+		if (db && !(d = user_addr(db, d, VM_W, &dleft)))
+			break;
+
+		if (sb && !(s = user_addr(sb, s, VM_R, &sleft)))
+			break;
+
+		size_t n = MIN3(size - copied, dleft, sleft);
+		/* copying within the same address space is allowed, if a bit
+		 * silly, so take care of possible overlap */
+		if (db == sb)
+			memmove((void *)d, (void *)s, n);
+		else
+			memcpy((void *)d, (void *)s, n);
+
+		copied += n;
+	}
+
+	return copied;
+}
+
 void handle_pagefault(vm_t addr)
 {
 	info("page fault at %lx\n", addr);
@@ -0,0 +1,116 @@
+/* SPDX-License-Identifier: copyleft-next-0.3.1 */
+/* Copyright 2024, Kim Kuparinen < kimi.h.kuparinen@gmail.com > */
+
+/**
+ * @file wait.c
+ *
+ * Wait queue implementation. Waiting threads are hashed into a fixed number of
+ * buckets based on the physical address they're waiting on, and within each
+ * bucket kept in FIFO order so wakeups are fair.
+ *
+ * The waiting itself happens in \ref sys_wait(), this file only keeps track of
+ * who's waiting on what.
+ */
+
+#include <kmi/wait.h>
+#include <kmi/queue.h>
+
+#include <arch/cpu.h>
+
+/** Number of wait buckets, must be a power of two. */
+#define WAIT_BUCKETS 64
+
+/** Wait buckets. */
+static struct queue_head buckets[WAIT_BUCKETS];
+
+/**
+ * Get bucket of address.
+ *
+ * @param addr Physical address.
+ * @return Bucket that waiters on \p addr are placed into.
+ */
+static struct queue_head *__bucket(pm_t addr)
+{
+	/* low bits are likely to be identical for aligned words, so mix them
+	 * in a bit */
+	size_t h = (addr >> 2) ^ (addr >> 12);
+	return &buckets[h & (WAIT_BUCKETS - 1)];
+}
+
+void init_waits()
+{
+	for (size_t i = 0; i < WAIT_BUCKETS; ++i)
+		buckets[i] = (struct queue_head)INIT_QUEUE(buckets[i]);
+}
+
+/**
+ * Finish waiting.
+ * If the thread is currently sitting in \ref sys_wait() on some other core,
+ * kick it so it notices. The kick doesn't go through \ref send_ipi(), as there
+ * is nothing to notify, and \ref sys_wait() clears it with \ref clear_ipi().
+ *
+ * @param t Thread to stop waiting.
+ * @param status Status to return from \ref sys_wait().
+ */
+static void __finish_wait(struct tcb *t, stat_t status)
+{
+	queue_del(&t->wait.q);
+	t->wait.state = WAIT_DONE;
+	t->wait.status = status;
+
+	if (running(t) && t != cur_tcb())
+		cpu_send_ipi(t->cpu_id);
+}
+
+void queue_wait(struct tcb *t, pm_t addr, ticks_t ticks)
+{
+	t->wait.addr = addr;
+	t->wait.state = WAIT_SLEEPING;
+	t->wait.status = OK;
+	t->wait.timer = ticks ? new_wait_timer(t->tid, ticks) : 0;
+	queue_push(&t->wait.q, __bucket(addr));
+}
+
+size_t wake_addr(pm_t addr, size_t n)
+{
+	struct queue_head *b = __bucket(addr);
+	struct list_head *e = b->l.next;
+	size_t woken = 0;
+	while (e != &b->l && woken < n) {
+		struct list_head *next = e->next;
+		struct tcb *t = container_of(e, struct tcb, wait.q.l);
+		if (t->wait.addr == addr) {
+			__finish_wait(t, OK);
+			woken++;
+		}
+
+		e = next;
+	}
+
+	return woken;
+}
+
+void wait_timeout(struct tcb *t, id_t cid)
+{
+	/* the timer might be left over from an earlier wait that was woken up
+	 * before the timer expired */
+	if (t->wait.state != WAIT_SLEEPING || t->wait.timer != cid)
+		return;
+
+	t->wait.timer = 0;
+	__finish_wait(t, ERR_TIMEOUT);
+}
+
+void unqueue_wait(struct tcb *t)
+{
+	queue_del(&t->wait.q);
+	t->wait.state = WAIT_NONE;
+
+	if (t->wait.timer) {
+		struct timer *timer = find_timer(t->wait.timer);
+		if (timer)
+			remove_timer(timer);
+
+		t->wait.timer = 0;
+	}
+}
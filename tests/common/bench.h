@@ -0,0 +1,191 @@
+#ifndef KMI_BENCH_H
+#define KMI_BENCH_H
+
+#include <kmi/types.h>
+
+#include "benchmark.h"
+
+/*
+ * Benchmark harness. Runs the body of a BENCH() loop for a number of rounds,
+ * the first few of which are warmup and thrown away, and records how many
+ * ticks each iteration took in a log-linear histogram. bench_report() prints
+ * the result as one JSON line that scripts/compare-reports can pick up.
+ *
+ * Typical use:
+ *
+ *	struct bench b;
+ *	BENCH(&b, "malloc", 1000) {
+ *		void *p = sys_req_mem(1, VM_R | VM_W);
+ *		sys_free_mem((uintptr_t)p);
+ *	}
+ *	bench_report(&b);
+ */
+
+#ifndef BENCH_ROUNDS
+#define BENCH_ROUNDS 5
+#endif
+
+#ifndef BENCH_WARMUP
+#define BENCH_WARMUP 1
+#endif
+
+/* each power of two is split into this many linear sub-buckets, so the
+ * percentiles are accurate to within 1/BENCH_SUB */
+#define BENCH_SUB_BITS 3
+#define BENCH_SUB (1 << BENCH_SUB_BITS)
+#define BENCH_BUCKETS ((64 - BENCH_SUB_BITS + 1) * BENCH_SUB)
+
+struct bench {
+	const char *name;
+	size_t iters;
+	size_t iter;
+	size_t round;
+
+	uint64_t timebase;
+	/* cost of reading the time, subtracted from each sample */
+	uint64_t overhead;
+	uint64_t prev;
+
+	uint64_t count;
+	uint64_t sum;
+	uint64_t min;
+	uint64_t max;
+	uint32_t hist[BENCH_BUCKETS];
+};
+
+static inline size_t bench_bucket(uint64_t v)
+{
+	if (v < BENCH_SUB)
+		return v;
+
+	size_t e = 63 - __builtin_clzll(v);
+	size_t sub = (v >> (e - BENCH_SUB_BITS)) & (BENCH_SUB - 1);
+	return (e - BENCH_SUB_BITS + 1) * BENCH_SUB + sub;
+}
+
+/* largest value that ends up in bucket i */
+static inline uint64_t bench_bucket_max(size_t i)
+{
+	if (i < BENCH_SUB)
+		return i;
+
+	size_t e = i / BENCH_SUB + BENCH_SUB_BITS - 1;
+	uint64_t sub = i % BENCH_SUB;
+	uint64_t lo = (BENCH_SUB + sub) << (e - BENCH_SUB_BITS);
+	return lo + (1ULL << (e - BENCH_SUB_BITS)) - 1;
+}
+
+static inline void bench_record(struct bench *b, uint64_t v)
+{
+	v = v > b->overhead ? v - b->overhead : 0;
+	if (v < b->min)
+		b->min = v;
+
+	if (v > b->max)
+		b->max = v;
+
+	b->sum += v;
+	b->count++;
+	b->hist[bench_bucket(v)]++;
+}
+
+static inline void bench_start(struct bench *b, const char *name, size_t iters)
+{
+	*b = (struct bench){
+		.name = name,
+		.iters = iters,
+		.min = (uint64_t)-1,
+		.timebase = sys_timebase(),
+	};
+
+	/* take the smallest difference between two back-to-back reads as the
+	 * cost of reading the time */
+	b->overhead = (uint64_t)-1;
+	for (size_t i = 0; i < 16; ++i) {
+		uint64_t start = sys_ticks();
+		uint64_t end = sys_ticks();
+		if (end - start < b->overhead)
+			b->overhead = end - start;
+	}
+
+	b->prev = sys_ticks();
+}
+
+/* returns true as long as there are iterations left to run */
+static inline bool bench_next(struct bench *b)
+{
+	uint64_t now = sys_ticks();
+	if (b->iter != 0 && b->round >= BENCH_WARMUP)
+		bench_record(b, now - b->prev);
+
+	if (b->iter++ == b->iters) {
+		b->iter = 1;
+		b->round++;
+	}
+
+	if (b->round == BENCH_WARMUP + BENCH_ROUNDS)
+		return false;
+
+	/* don't count our own bookkeeping */
+	b->prev = sys_ticks();
+	return true;
+}
+
+#define BENCH(b, name, iters)\
+	for (bench_start(b, name, iters); bench_next(b);)
+
+static inline uint64_t bench_percentile(struct bench *b, unsigned p)
+{
+	uint64_t want = (b->count * p + 99) / 100;
+	uint64_t seen = 0;
+	for (size_t i = 0; i < BENCH_BUCKETS; ++i) {
+		seen += b->hist[i];
+		if (seen >= want && seen) {
+			uint64_t v = bench_bucket_max(i);
+			return v > b->max ? b->max : v;
+		}
+	}
+
+	return b->max;
+}
+
+/* print results as one JSON line, for programs that run several benchmarks
+ * before calling bench_report() on the last one */
+static inline void bench_print(struct bench *b)
+{
+	if (!b->count) {
+		printf("{\"bench\":\"%s\",\"error\":\"no samples\"}\n", b->name);
+		report(0, 0, 0);
+	}
+
+	uint64_t mean = b->sum / b->count;
+	/* an iteration can take less than a tick, so don't divide by the
+	 * mean */
+	uint64_t ops = b->sum ? b->count * b->timebase / b->sum : 0;
+
+	printf("{\"bench\":\"%s\",\"rounds\":%d,\"iters\":%llu,"
+	       "\"timebase\":%llu,\"overhead\":%llu,"
+	       "\"min\":%llu,\"p50\":%llu,\"p90\":%llu,\"p99\":%llu,"
+	       "\"max\":%llu,\"mean\":%llu,\"ops_per_sec\":%llu}\n",
+	       b->name, BENCH_ROUNDS,
+	       (unsigned long long)b->iters,
+	       (unsigned long long)b->timebase,
+	       (unsigned long long)b->overhead,
+	       (unsigned long long)b->min,
+	       (unsigned long long)bench_percentile(b, 50),
+	       (unsigned long long)bench_percentile(b, 90),
+	       (unsigned long long)bench_percentile(b, 99),
+	       (unsigned long long)b->max,
+	       (unsigned long long)mean,
+	       (unsigned long long)ops);
+}
+
+static inline void bench_report(struct bench *b)
+{
+	bench_print(b);
+
+	/* keep the old total / timebase line last for make benchmark */
+	report(0, b->sum / BENCH_ROUNDS, b->timebase);
+}
+
+#endif /* KMI_BENCH_H */
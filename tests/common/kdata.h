@@ -0,0 +1,52 @@
+#ifndef KMI_TEST_KDATA_H
+#define KMI_TEST_KDATA_H
+
+#include <kmi/types.h>
+#include "sys.h"
+
+static inline const volatile struct sys_kdata *kdata()
+{
+	return (const volatile struct sys_kdata *)KDATA_ADDR;
+}
+
+/* take a consistent snapshot of the kernel data page, without trapping */
+static inline void kdata_read(struct sys_kdata *out)
+{
+	const volatile struct sys_kdata *k = kdata();
+	sys_arg_t seq;
+	do {
+		while ((seq = k->seq) & 1)
+			;
+
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+		for (size_t i = 0; i < sizeof(*out); ++i)
+			((char *)out)[i] = ((const volatile char *)k)[i];
+
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	} while (k->seq != seq);
+}
+
+static inline uint64_t kdata_timebase()
+{
+	/* never changes after boot, so no need to bother with seq */
+	return kdata()->timebase;
+}
+
+static inline uint64_t kdata_ticks()
+{
+	const volatile struct sys_kdata *k = kdata();
+	sys_arg_t seq;
+	uint64_t ticks;
+	do {
+		while ((seq = k->seq) & 1)
+			;
+
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+		ticks = k->ticks;
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	} while (k->seq != seq);
+
+	return ticks;
+}
+
+#endif /* KMI_TEST_KDATA_H */
@@ -0,0 +1,42 @@
+#ifndef KMI_TEST_PROFILE_H
+#define KMI_TEST_PROFILE_H
+
+#include <kmi/types.h>
+#include "printf.h"
+#include "sys.h"
+
+/* print out every sample taken on cpu in the format scripts/profile2folded
+ * expects, returns number of samples printed */
+static inline size_t profile_dump(id_t cpu)
+{
+	static struct sys_profile_rec buf[32];
+	size_t total = 0;
+	size_t drained = 0, dropped = 0;
+
+	do {
+		if (sys_profile(PROFILE_DRAIN, cpu, buf, 32, &drained, &dropped))
+			break;
+
+		if (dropped)
+			printf("profile: dropped %zu\n", dropped);
+
+		for (size_t i = 0; i < drained; ++i) {
+			struct sys_profile_rec *r = &buf[i];
+			printf("profile: %u %llu %u %d %d %d %llx",
+			       r->cpu, r->ticks, r->mode, r->pid, r->tid,
+			       r->what, r->pc);
+
+			for (size_t f = 0; f < PROFILE_FRAMES && r->frames[f];
+			     ++f)
+				printf(" %llx", r->frames[f]);
+
+			printf("\n");
+		}
+
+		total += drained;
+	} while (drained);
+
+	return total;
+}
+
+#endif /* KMI_TEST_PROFILE_H */
@@ -92,6 +92,17 @@ static inline enum sys_status sys_free_mem(uintptr_t start)
 	return r.s;
 }
 
+static inline enum sys_status sys_copy_mem(id_t pid, struct sys_iovec *iov,
+                                           size_t count, enum copy_dir dir,
+                                           size_t *copied)
+{
+	struct sys_ret r = syscall4(SYS_COPY_MEM, pid, (uintptr_t)iov, count, dir);
+	if (copied)
+		*copied = r.a0;
+
+	return r.s;
+}
+
 static inline uint64_t sys_timebase()
 {
 	struct sys_ret r = syscall0(SYS_TIMEBASE);
@@ -118,14 +129,9 @@ static inline uint64_t sys_ticks()
 #endif
 }
 
-static inline id_t sys_req_rel_timer(uint64_t ticks)
+static inline id_t sys_req_rel_timer(uint64_t ticks, uint64_t slack)
 {
-	struct sys_ret r;
-#if defined(_LP64)
-	r = syscall2(SYS_REQ_REL_TIMER, ticks >> 32, ticks);
-#else
-	r = syscall1(SYS_REQ_REL_TIMER, ticks);
-#endif
+	struct sys_ret r = syscall3(SYS_REQ_REL_TIMER, ticks, 1, slack);
 
 	if (r.s)
 		return -1;
@@ -133,21 +139,39 @@ static inline id_t sys_req_rel_timer(uint64_t ticks)
 	return r.a0;
 }
 
-static inline id_t sys_req_abs_timer(uint64_t ticks)
+static inline id_t sys_req_abs_timer(uint64_t ticks, uint64_t slack)
 {
-	struct sys_ret r;
-#if defined(_LP64)
-	r = syscall2(SYS_REQ_ABS_TIMER, ticks >> 32, ticks);
-#else
-	r = syscall1(SYS_REQ_ABS_TIMER, ticks);
-#endif
+	struct sys_ret r = syscall3(SYS_REQ_ABS_TIMER, ticks, 1, slack);
+
+	if (r.s)
+		return -1;
+
+	return r.a0;
+}
 
+static inline id_t sys_req_periodic_timer(uint64_t period)
+{
+	struct sys_ret r = syscall2(SYS_REQ_PERIODIC_TIMER, period, 1);
 	if (r.s)
 		return -1;
 
 	return r.a0;
 }
 
+static inline enum sys_status sys_free_timer(id_t cid)
+{
+	return syscall1(SYS_FREE_TIMER, cid).s;
+}
+
+static inline enum sys_status sys_timer_overrun(id_t cid, size_t *overruns)
+{
+	struct sys_ret r = syscall1(SYS_TIMER_OVERRUN, cid);
+	if (overruns)
+		*overruns = r.a0;
+
+	return r.s;
+}
+
 #define sys_ipc_req0(pid) syscall1(SYS_IPC_REQ, pid)
 #define sys_ipc_req1(pid, d0) syscall2(SYS_IPC_REQ, pid, d0)
 #define sys_ipc_req2(pid, d0, d1) syscall3(SYS_IPC_REQ, pid, d0, d1)
@@ -178,9 +202,31 @@ static inline enum sys_status sys_set_handler(id_t tid, id_t pid)
 	return r.s;
 }
 
-static inline enum sys_status sys_ipc_notify(id_t tid)
+static inline enum sys_status sys_ipc_notify(id_t tid, sys_arg_t payload)
+{
+	struct sys_ret r = syscall2(SYS_IPC_NOTIFY, tid, payload);
+	return r.s;
+}
+
+static inline enum sys_status sys_ipc_drain(struct sys_notify *buf, size_t max,
+                                            size_t *drained)
 {
-	struct sys_ret r = syscall1(SYS_IPC_NOTIFY, tid);
+	struct sys_ret r = syscall2(SYS_IPC_DRAIN, (uintptr_t)buf, max);
+	if (drained)
+		*drained = r.a0;
+
+	return r.s;
+}
+
+static inline enum sys_status sys_ipc_vec(struct sys_ipc_desc *vec,
+                                          size_t count, struct sys_ret *comp,
+                                          size_t *done)
+{
+	struct sys_ret r = syscall3(SYS_IPC_VEC, (uintptr_t)vec, count,
+	                            (uintptr_t)comp);
+	if (done)
+		*done = r.a0;
+
 	return r.s;
 }
 
@@ -250,6 +296,63 @@ static inline enum sys_status sys_swap(id_t tid)
 	return r.s;
 }
 
+static inline enum sys_status sys_thread_stats(id_t tid, struct sys_stats *s)
+{
+	struct sys_ret r = syscall2(SYS_THREAD_STATS, tid, (uintptr_t)s);
+	return r.s;
+}
+
+static inline enum sys_status sys_syscall_stats(enum sys_syscall_stats_op op,
+                                                enum sys_code num,
+                                                struct sys_syscall_stats *s)
+{
+	struct sys_ret r = syscall3(SYS_SYSCALL_STATS, op, num, (uintptr_t)s);
+	return r.s;
+}
+
+static inline enum sys_status sys_trace(enum sys_trace_op op, id_t cpu,
+                                        struct sys_trace_rec *buf, size_t max,
+                                        size_t *drained, size_t *dropped)
+{
+	struct sys_ret r = syscall4(SYS_TRACE, op, cpu, (uintptr_t)buf, max);
+	if (drained)
+		*drained = r.a0;
+
+	if (dropped)
+		*dropped = r.a1;
+
+	return r.s;
+}
+
+static inline enum sys_status sys_pmu(enum sys_pmu_op op, sys_arg_t a,
+                                      sys_arg_t b, sys_arg_t *r0,
+                                      sys_arg_t *r1)
+{
+	struct sys_ret r = syscall3(SYS_PMU, op, a, b);
+	if (r0)
+		*r0 = r.a0;
+
+	if (r1)
+		*r1 = r.a1;
+
+	return r.s;
+}
+
+static inline enum sys_status sys_profile(enum sys_profile_op op, sys_arg_t a,
+                                          struct sys_profile_rec *buf,
+                                          size_t max, size_t *drained,
+                                          size_t *dropped)
+{
+	struct sys_ret r = syscall4(SYS_PROFILE, op, a, (uintptr_t)buf, max);
+	if (drained)
+		*drained = r.a0;
+
+	if (dropped)
+		*dropped = r.a1;
+
+	return r.s;
+}
+
 static inline enum sys_status sys_conf_set(enum conf_param param, long arg)
 {
 	struct sys_ret r = syscall2(SYS_SET_CONF, param, arg);
@@ -306,6 +409,12 @@ static inline enum sys_status sys_free_irq(long irq)
 	return r.s;
 }
 
+static inline enum sys_status sys_irq_affinity(long irq, id_t cpu)
+{
+	struct sys_ret r = syscall2(SYS_IRQ_AFFINITY, irq, cpu);
+	return r.s;
+}
+
 static inline enum sys_status sys_detach(id_t tid)
 {
 	struct sys_ret r = syscall1(SYS_DETACH, tid);
@@ -318,4 +427,30 @@ static inline enum sys_status sys_exit(id_t tid)
 	return r.s;
 }
 
+static inline enum sys_status sys_ring_enter(struct sys_ring *ring,
+                                             size_t count, size_t *done)
+{
+	struct sys_ret r = syscall2(SYS_RING_ENTER, (uintptr_t)ring, count);
+	if (done)
+		*done = r.a0;
+
+	return r.s;
+}
+
+static inline enum sys_status sys_wait(uint32_t *addr, uint32_t expected,
+                                       uint64_t ticks)
+{
+	return syscall3(SYS_WAIT, (uintptr_t)addr, expected, ticks).s;
+}
+
+static inline enum sys_status sys_wake(uint32_t *addr, size_t n,
+                                       size_t *woken)
+{
+	struct sys_ret r = syscall2(SYS_WAKE, (uintptr_t)addr, n);
+	if (woken)
+		*woken = r.a0;
+
+	return r.s;
+}
+
 #endif /* KMI_SYS_H */
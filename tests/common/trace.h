@@ -0,0 +1,37 @@
+#ifndef KMI_TEST_TRACE_H
+#define KMI_TEST_TRACE_H
+
+#include <kmi/types.h>
+#include "printf.h"
+#include "sys.h"
+
+/* print out everything recorded on cpu in the format scripts/trace2perfetto
+ * expects, returns number of records printed */
+static inline size_t trace_dump(id_t cpu)
+{
+	static struct sys_trace_rec buf[64];
+	size_t total = 0;
+	size_t drained = 0, dropped = 0;
+
+	printf("trace: timebase %llu\n", (unsigned long long)sys_timebase());
+	do {
+		if (sys_trace(TRACE_DRAIN, cpu, buf, 64, &drained, &dropped))
+			break;
+
+		if (dropped)
+			printf("trace: dropped %zu\n", dropped);
+
+		for (size_t i = 0; i < drained; ++i) {
+			struct sys_trace_rec *r = &buf[i];
+			printf("trace: %u %llu %u %d %llx %llx\n",
+			       r->cpu, r->ticks, r->event, r->tid,
+			       r->a0, r->a1);
+		}
+
+		total += drained;
+	} while (drained);
+
+	return total;
+}
+
+#endif /* KMI_TEST_TRACE_H */
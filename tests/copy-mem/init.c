@@ -0,0 +1,89 @@
+#include <common/test.h>
+
+#define BUF_SIZE (3 * 4096)
+
+static char src[BUF_SIZE];
+static char dst[BUF_SIZE];
+static struct sys_iovec many[COPY_MEM_MAX_FRAGMENTS + 1];
+
+START(pid, tid, d0, d1, d2, d3)
+{
+	UNUSED(tid);
+	UNUSED(d1);
+	UNUSED(d2);
+	UNUSED(d3);
+
+	check(pid == 0 || pid == 1, "illegal pid for init\n");
+	if (pid == 0) {
+		printf("creating pid 2\n");
+		id_t id = sys_fork(NULL);
+		check(id == 2, "unexpected pid?\n");
+
+		for (size_t i = 0; i < BUF_SIZE; ++i)
+			src[i] = (char)i;
+
+		struct sys_iovec iov = {(uintptr_t)src, (uintptr_t)src, 16};
+		enum sys_status s = sys_copy_mem(2, &iov, 1, COPY_FROM, NULL);
+		check(s == ERR_PERM, "copied outside RPC chain?\n");
+
+		struct sys_ret r = sys_ipc_req1(2, 1);
+		check(r.s == OK, "failed request?\n");
+		check(r.a0 == OK, "copy failed in server\n");
+
+		for (size_t i = 0; i < BUF_SIZE; ++i)
+			check(dst[i] == (char)(i + 1), "wrong byte at %zd\n", i);
+	}
+	else if (pid == 1 && d0 == 1) {
+		printf("pid 2 caught ipc req\n");
+
+		/* fragments deliberately straddle page boundaries */
+		struct sys_iovec iov[3] = {
+			{(uintptr_t)src, (uintptr_t)src, 100},
+			{(uintptr_t)src + 100, (uintptr_t)src + 100, 5000},
+			{(uintptr_t)src + 5100, (uintptr_t)src + 5100,
+			 BUF_SIZE - 5100},
+		};
+
+		size_t copied = 0;
+		enum sys_status s = sys_copy_mem(1, iov, 3, COPY_FROM, &copied);
+		check(s == OK, "copy from failed\n");
+		check(copied == BUF_SIZE, "wrong number of bytes copied\n");
+
+		for (size_t i = 0; i < BUF_SIZE; ++i)
+			src[i] += 1;
+
+		struct sys_iovec out = {(uintptr_t)src, (uintptr_t)dst, BUF_SIZE};
+		s = sys_copy_mem(1, &out, 1, COPY_TO, &copied);
+		check(s == OK, "copy to failed\n");
+		check(copied == BUF_SIZE, "wrong number of bytes copied\n");
+
+		struct sys_iovec bad = {(uintptr_t)src, 0, 16};
+		s = sys_copy_mem(1, &bad, 1, COPY_FROM, &copied);
+		check(s == ERR_ADDR, "copied from NULL?\n");
+		check(copied == 0, "copied bytes from NULL?\n");
+
+		/* one call stops at the fragment limit, the rest can be copied
+		 * with another call */
+		for (size_t i = 0; i < COPY_MEM_MAX_FRAGMENTS + 1; ++i)
+			many[i] = (struct sys_iovec){(uintptr_t)src + i,
+			                             (uintptr_t)src + i, 1};
+
+		s = sys_copy_mem(1, many, COPY_MEM_MAX_FRAGMENTS + 1, COPY_FROM,
+		                 &copied);
+		check(s == OK, "copy over fragment limit failed\n");
+		check(copied == COPY_MEM_MAX_FRAGMENTS,
+		      "fragment limit not enforced\n");
+
+		s = sys_copy_mem(1, many + COPY_MEM_MAX_FRAGMENTS, 1, COPY_FROM,
+		                 &copied);
+		check(s == OK && copied == 1, "resuming copy failed\n");
+
+		sys_ipc_resp1(OK);
+		error("pid 2 ipc_resp failed\n");
+	}
+	else {
+		error("weird pid: %ld\n", pid);
+	}
+
+	ok();
+}
@@ -0,0 +1 @@
+TESTS += copy-mem
@@ -0,0 +1,42 @@
+#include <common/test.h>
+
+START(pid, tid, d0, d1, d2, d3)
+{
+	UNUSED(d2);
+	check(pid == 0, "illegal pid for init\n");
+	check(d0 == SYS_USER_NOTIFY || d0 == SYS_USER_SPAWNED,
+			"illegal d0 for init\n");
+
+	if (d0 == SYS_USER_SPAWNED) {
+		check(tid == 1, "illegal init thread ID\n");
+		check(sys_ipc_notify(1, 10) == OK, "notify failed\n");
+		printf("returned from notification handler\n");
+	}
+	else if (d0 == SYS_USER_NOTIFY) {
+		check(d1 & NOTIFY_SIGNAL, "illegal d1\n");
+		check(d3 == 1, "wrong number of queued notifications\n");
+
+		/* we're in the handler, so these just get queued */
+		check(sys_ipc_notify(1, 11) == OK, "second notify failed\n");
+		check(sys_ipc_notify(1, 12) == OK, "third notify failed\n");
+
+		struct sys_notify buf[4];
+		size_t drained = 0;
+		check(sys_ipc_drain(buf, 4, &drained) == OK, "drain failed\n");
+		check(drained == 3, "wrong number of drained notifications\n");
+		for (size_t i = 0; i < drained; ++i) {
+			check(buf[i].pid == 1, "wrong sender pid\n");
+			check(buf[i].tid == 1, "wrong sender tid\n");
+			check(buf[i].payload == (sys_arg_t)(10 + i),
+			      "wrong payload\n");
+		}
+
+		check(sys_ipc_drain(buf, 4, &drained) == OK, "drain failed\n");
+		check(drained == 0, "queue not empty after drain\n");
+
+		sys_ipc_resp4(0, 0, 0, 0);
+		check(0, "ipc resp failed\n");
+	}
+
+	ok();
+}
@@ -0,0 +1 @@
+TESTS += ipc-drain
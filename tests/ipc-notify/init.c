@@ -22,7 +22,7 @@ START(pid, tid, d0, d1, d2, d3)
 		check(r.a3 != 13, "ipc resp leaked through?\n");
 
 		/* try to notify to non-existing proc */
-		enum sys_status s = sys_ipc_notify(200);
+		enum sys_status s = sys_ipc_notify(200, 0);
 		check(s != OK, "got OK return for illegal pid\n");
 	}
 	else if (d0 == SYS_USER_NOTIFY) {
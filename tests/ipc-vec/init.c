@@ -0,0 +1,56 @@
+#include <common/test.h>
+
+START(pid, tid, d0, d1, d2, d3)
+{
+	UNUSED(tid);
+
+	check(pid == 0 || pid == 1, "illegal pid for init\n");
+	if (pid == 0) {
+		printf("creating pid 2\n");
+		id_t id = sys_fork(NULL);
+		check(id == 2, "unexpected pid?\n");
+
+		struct sys_ipc_desc vec[4] = {
+			{1, 1, 2, 3, 4},
+			{2, 5, 6, 7, 8},
+			{200, 0, 0, 0, 0},
+			{2, 9, 10, 11, 12},
+		};
+
+		struct sys_ret comp[4] = {0};
+
+		size_t done = 0;
+		printf("sending batch\n");
+		enum sys_status s = sys_ipc_vec(vec, 4, comp, &done);
+		check(s == OK, "batch failed\n");
+		check(done == 4, "wrong number of completions\n");
+
+		check(comp[0].s == OK, "not OK completion 0\n");
+		check(comp[0].id == 1, "wrong responder 0\n");
+		check(comp[0].a0 == 2, "wrong a0 0\n");
+		check(comp[0].a3 == 5, "wrong a3 0\n");
+
+		check(comp[1].s == OK, "not OK completion 1\n");
+		check(comp[1].id == 2, "wrong responder 1\n");
+		check(comp[1].a0 == 6, "wrong a0 1\n");
+		check(comp[1].a3 == 9, "wrong a3 1\n");
+
+		check(comp[2].s == ERR_INVAL, "OK completion for illegal pid\n");
+
+		check(comp[3].s == OK, "not OK completion 3\n");
+		check(comp[3].id == 2, "wrong responder 3\n");
+		check(comp[3].a0 == 10, "wrong a0 3\n");
+		check(comp[3].a3 == 13, "wrong a3 3\n");
+
+		/* empty batch should be fine */
+		s = sys_ipc_vec(vec, 0, comp, &done);
+		check(s == OK, "empty batch failed\n");
+		check(done == 0, "completions for empty batch?\n");
+	}
+	else if (pid == 1) {
+		sys_ipc_resp4(d0 + 1, d1 + 1, d2 + 1, d3 + 1);
+		error("ipc_resp failed\n");
+	}
+
+	ok();
+}
@@ -0,0 +1 @@
+TESTS += ipc-vec
@@ -0,0 +1,26 @@
+#include <common/test.h>
+
+/* last virtio-mmio slot on qemu virt, nothing should be attached to it */
+#define TEST_IRQ 8
+
+START(pid, tid, d0, d1, d2, d3)
+{
+	UNUSED(pid); UNUSED(d0); UNUSED(d1); UNUSED(d2); UNUSED(d3);
+
+	check(sys_irq_affinity(TEST_IRQ, 0) == ERR_PERM,
+	      "routed irq we don't own\n");
+
+	check(sys_set_handler(tid, 1) == OK, "failed setting handler\n");
+	check(sys_irq_req(TEST_IRQ) == OK, "failed requesting irq\n");
+
+	check(sys_irq_affinity(TEST_IRQ, 0) == OK, "failed routing irq\n");
+	check(sys_irq_affinity(TEST_IRQ, 1000) == ERR_INVAL,
+	      "routed irq to nonexistent core\n");
+	check(sys_irq_affinity(TEST_IRQ, -1) == ERR_INVAL,
+	      "routed irq to negative core\n");
+
+	check(sys_free_irq(TEST_IRQ) == OK, "failed freeing irq\n");
+	check(sys_irq_affinity(TEST_IRQ, 0) == ERR_PERM,
+	      "routed freed irq\n");
+	ok();
+}
@@ -0,0 +1 @@
+TESTS += irq-affinity
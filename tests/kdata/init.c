@@ -0,0 +1,58 @@
+#include <common/test.h>
+#include <common/kdata.h>
+
+START(pid, tid, d0, d1, d2, d3)
+{
+	UNUSED(pid); UNUSED(tid); UNUSED(d0);
+	UNUSED(d1); UNUSED(d2); UNUSED(d3);
+
+	check(kdata_timebase() == sys_timebase(), "wrong timebase\n");
+
+	/* ticks is a snapshot from the latest page update, so it should never
+	 * be ahead of the real thing */
+	uint64_t before = kdata_ticks();
+	uint64_t now = sys_ticks();
+	check(before <= now, "kdata ticks ahead of real ticks\n");
+
+	struct sys_kdata k;
+	kdata_read(&k);
+	check(!(k.seq & 1), "torn snapshot\n");
+	check(k.cpus >= 1, "no cpus\n");
+	check(k.orders >= 1, "no page orders\n");
+	for (sys_arg_t i = 0; i < k.orders; ++i)
+		check(k.page_size[i] == sys_conf_get(CONF_PAGE_SIZE, i),
+		      "wrong page size\n");
+
+	check(k.ram_size == sys_conf_get(CONF_RAM_SIZE, 0), "wrong ram size\n");
+	check(k.max_threads == sys_conf_get(CONF_MAX_THREADS, 0),
+	      "wrong max threads\n");
+	check(k.thread_stack == sys_conf_get(CONF_THREAD_STACK, 0),
+	      "wrong thread stack\n");
+
+	/* RAM usage is refreshed at syscall entry, so allocating something and
+	 * doing a syscall should show up */
+	void *p = sys_req_mem(4096 * 16, VM_R | VM_W);
+	check(p, "failed allocating memory\n");
+	sys_noop();
+	kdata_read(&k);
+	check(k.ram_usage == sys_conf_get(CONF_RAM_USAGE, 0),
+	      "wrong ram usage\n");
+	check(k.ticks >= now, "kdata ticks not updated\n");
+
+	/* nothing changed, so a syscall shouldn't touch the page */
+	sys_arg_t seq = k.seq;
+	sys_noop();
+	kdata_read(&k);
+	check(k.seq == seq, "kdata page updated without changes\n");
+
+	/* counters only ever go up */
+	sys_arg_t syscalls = 0;
+	for (size_t i = 0; i < KDATA_CPUS; ++i)
+		syscalls += k.cpu[i].syscalls;
+
+	check(syscalls > 0, "no syscalls counted\n");
+
+	/* kernel data page isn't a user region, so it can't be freed */
+	check(sys_free_mem(KDATA_ADDR) != OK, "freed kernel data page\n");
+	ok();
+}
@@ -0,0 +1,71 @@
+#include <common/test.h>
+
+static long used_bytes()
+{
+	long orders = 0;
+	while (sys_conf_get(CONF_PAGE_SIZE, orders))
+		orders++;
+
+	long bytes = 0;
+	for (long i = 0; i < orders; ++i)
+		bytes += sys_conf_get(CONF_RAM_USED_PAGES, i)
+		         * sys_conf_get(CONF_PAGE_SIZE, i);
+
+	return bytes;
+}
+
+START(pid, tid, d0, d1, d2, d3)
+{
+	UNUSED(pid); UNUSED(tid); UNUSED(d0);
+	UNUSED(d1); UNUSED(d2); UNUSED(d3);
+
+	/* per-order counts should add up to the byte counter */
+	check(used_bytes() == sys_conf_get(CONF_RAM_USAGE, 0),
+	      "page counts don't match ram usage\n");
+
+	long largest = sys_conf_get(CONF_RAM_LARGEST_FREE, 0);
+	check(largest > 0, "no free memory\n");
+	check(largest <= sys_conf_get(CONF_RAM_SIZE, 0),
+	      "largest free page larger than ram\n");
+	check(sys_conf_get(CONF_RAM_FREE_PAGES, -1) == 0,
+	      "free pages of invalid order\n");
+
+	long threads = sys_conf_get(CONF_THREADS, 0);
+	check(threads >= 1, "no threads alive\n");
+	check(threads <= sys_conf_get(CONF_MAX_THREADS, 0),
+	      "more threads than allowed\n");
+
+	check(sys_conf_get(CONF_PAGE_TABLES, 0) > 0, "no page tables\n");
+	check(sys_conf_get(CONF_RPC_STACK_USAGE, 0) > 0, "no rpc stacks\n");
+
+	for (long i = 0; i < NODES_NUM; ++i) {
+		long used = sys_conf_get(CONF_NODES_USED, i);
+		long cap = sys_conf_get(CONF_NODES_CAPACITY, i);
+		check(sys_conf_get(CONF_NODES_PAGES, i) >= 1, "no node pages\n");
+		check(used <= cap, "more nodes used than fit\n");
+	}
+
+	check(sys_conf_get(CONF_NODES_USED, NODES_NUM) == 0,
+	      "nodes in invalid pool\n");
+
+	/* a fresh region takes up at least one node, and touching it should
+	 * allocate at least one page */
+	long nodes = sys_conf_get(CONF_NODES_USED, NODES_REGIONS);
+	long before = sys_conf_get(CONF_RAM_USAGE, 0);
+	char *p = sys_req_mem(4096 * 16, VM_R | VM_W);
+	check(p, "failed allocating memory\n");
+	p[0] = 1;
+
+	check(sys_conf_get(CONF_NODES_USED, NODES_REGIONS) > nodes,
+	      "region nodes didn't go up\n");
+	check(sys_conf_get(CONF_RAM_USAGE, 0) > before,
+	      "ram usage didn't go up\n");
+	check(used_bytes() == sys_conf_get(CONF_RAM_USAGE, 0),
+	      "page counts don't match ram usage after allocating\n");
+
+	long after = sys_conf_get(CONF_RAM_USAGE, 0);
+	check(sys_free_mem((uintptr_t)p) == OK, "failed freeing memory\n");
+	check(sys_conf_get(CONF_RAM_USAGE, 0) < after,
+	      "ram usage didn't go back down\n");
+	ok();
+}
@@ -0,0 +1 @@
+TESTS += mem-stats
@@ -0,0 +1,56 @@
+#include <common/test.h>
+
+START(pid, tid, d0, d1, d2, d3)
+{
+	UNUSED(tid); UNUSED(d0); UNUSED(d1); UNUSED(d2); UNUSED(d3);
+	check(pid == 0, "illegal pid for init\n");
+
+	sys_arg_t n = 0;
+	check(sys_pmu(PMU_NUM, 0, 0, &n, NULL) == OK,
+			"failed getting number of counters\n");
+
+	if (n == 0) {
+		check(sys_pmu(PMU_CONFIG, 0, PMU_INSTRET, NULL, NULL)
+				== ERR_NOINIT,
+				"configured counter without a pmu\n");
+		ok();
+	}
+
+	sys_arg_t csr = 0, width = 0;
+	check(sys_pmu(PMU_INFO, 0, 0, &csr, &width) == OK,
+			"failed getting counter info\n");
+	check(width > 0 && width <= 64, "weird counter width\n");
+	check(sys_pmu(PMU_INFO, n, 0, NULL, NULL) == ERR_INVAL,
+			"got info of nonexistent counter\n");
+
+	stat_t r = sys_pmu(PMU_CONFIG, 0, PMU_INSTRET, NULL, NULL);
+	/* no way to count instructions, nothing more to check */
+	if (r == ERR_NF)
+		ok();
+
+	check(r == OK, "failed configuring counter\n");
+
+	sys_arg_t before = 0, after = 0;
+	check(sys_pmu(PMU_READ, 0, 0, &before, NULL) == OK,
+			"failed reading counter\n");
+
+	for (size_t i = 0; i < 100; ++i)
+		sys_ticks();
+
+	check(sys_pmu(PMU_READ, 0, 0, &after, NULL) == OK,
+			"failed reading counter\n");
+	check(after > before, "counter didn't count anything\n");
+
+	check(sys_pmu(PMU_RELEASE, 0, 0, NULL, NULL) == OK,
+			"failed releasing counter\n");
+	check(sys_pmu(PMU_READ, 0, 0, NULL, NULL) == ERR_NF,
+			"read released slot\n");
+
+	check(sys_pmu(PMU_CONFIG, PMU_SLOTS, PMU_INSTRET, NULL, NULL)
+			== ERR_INVAL, "configured nonexistent slot\n");
+	check(sys_pmu(PMU_CONFIG, 0, PMU_EVENTS, NULL, NULL) == ERR_INVAL,
+			"configured nonexistent event\n");
+	check(sys_pmu(100, 0, 0, NULL, NULL) == ERR_INVAL,
+			"accepted illegal op\n");
+	ok();
+}
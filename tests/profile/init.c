@@ -0,0 +1,79 @@
+#include <common/test.h>
+#include <common/profile.h>
+
+static struct sys_profile_rec recs[256];
+
+/* keep some userspace code busy without entering the kernel too often */
+static void __attribute__((noinline)) spin(uint64_t ticks)
+{
+	uint64_t start = sys_ticks();
+	while (sys_ticks() - start < ticks)
+		for (volatile size_t i = 0; i < 10000; ++i)
+			;
+}
+
+START(pid, tid, d0, d1, d2, d3)
+{
+	UNUSED(tid); UNUSED(d0); UNUSED(d1); UNUSED(d2); UNUSED(d3);
+	check(pid == 0, "illegal pid for init\n");
+
+	size_t drained = 0, dropped = 0;
+	check(sys_profile(PROFILE_DRAIN, 0, recs, 256, &drained, &dropped)
+			== OK, "failed draining before start\n");
+	check(drained == 0, "samples before start\n");
+
+	check(sys_profile(PROFILE_START, 0, NULL, 0, NULL, NULL) == ERR_INVAL,
+			"started with zero period\n");
+
+	/* about a thousand samples per second */
+	uint64_t timebase = sys_timebase();
+	check(sys_profile(PROFILE_START, timebase / 1000, NULL, 0, NULL, NULL)
+			== OK, "failed starting profiler\n");
+
+	spin(timebase / 10);
+
+	check(sys_profile(PROFILE_STOP, 0, NULL, 0, NULL, NULL) == OK,
+			"failed stopping profiler\n");
+
+	check(sys_profile(PROFILE_DRAIN, 0, recs, 256, &drained, &dropped)
+			== OK, "failed draining\n");
+	check(drained > 0, "no samples\n");
+
+	size_t user = 0, kernel = 0;
+	for (size_t i = 0; i < drained; ++i) {
+		struct sys_profile_rec *r = &recs[i];
+		check(r->cpu == 0, "wrong cpu\n");
+		check(r->tid == 1, "wrong tid\n");
+		check(r->pc, "no pc\n");
+		if (i > 0)
+			check(r->ticks > recs[i - 1].ticks,
+					"time went backwards\n");
+
+		if (r->mode == PROFILE_USER) {
+			check(r->what == -1, "user sample in syscall\n");
+			user++;
+		}
+		else {
+			check(r->mode == PROFILE_KERNEL, "weird mode\n");
+			/* all we're doing is asking for the time */
+			check(r->what == SYS_TICKS || r->what == SYS_PROFILE
+					|| r->what == -1,
+					"wrong syscall %d\n", r->what);
+			kernel++;
+		}
+	}
+
+	check(user > 0, "no userspace samples\n");
+	printf("%zu user, %zu kernel samples\n", user, kernel);
+
+	/* take a few more and print them out, see scripts/profile2folded */
+	check(sys_profile(PROFILE_START, timebase / 1000, NULL, 0, NULL, NULL)
+			== OK, "failed restarting profiler\n");
+	spin(timebase / 100);
+	sys_profile(PROFILE_STOP, 0, NULL, 0, NULL, NULL);
+	check(profile_dump(0) > 0, "nothing dumped\n");
+
+	check(sys_profile(PROFILE_DRAIN, 200, recs, 256, &drained, &dropped)
+			== ERR_INVAL, "drained nonexistent cpu\n");
+	ok();
+}
@@ -0,0 +1 @@
+TESTS += profile
@@ -0,0 +1,86 @@
+#include <common/test.h>
+
+#define RING_SIZE 8
+
+struct ring {
+	struct sys_ring h;
+	struct sys_sqe sq[RING_SIZE];
+	struct sys_cqe cq[RING_SIZE];
+};
+
+static struct ring ring = {.h = {.size = RING_SIZE}};
+
+static void submit(sys_arg_t op, sys_arg_t a0, sys_arg_t a1, sys_arg_t user)
+{
+	struct sys_sqe *e = &ring.sq[ring.h.sq_tail++ & (RING_SIZE - 1)];
+	*e = (struct sys_sqe){.op = op, .a0 = a0, .a1 = a1, .user = user};
+}
+
+static struct sys_cqe *complete()
+{
+	check(ring.h.cq_head != ring.h.cq_tail, "completion queue empty\n");
+	return &ring.cq[ring.h.cq_head++ & (RING_SIZE - 1)];
+}
+
+START(pid, tid, d0, d1, d2, d3)
+{
+	UNUSED(pid);
+	UNUSED(tid);
+	UNUSED(d0);
+	UNUSED(d1);
+	UNUSED(d2);
+	UNUSED(d3);
+
+	for (size_t i = 0; i < 3; ++i)
+		submit(SYS_REQ_MEM, 4096, VM_R | VM_W, i);
+
+	submit(SYS_TICKS, 0, 0, 3);
+	/* not allowed in a ring */
+	submit(SYS_IPC_REQ, 1, 0, 4);
+
+	size_t done = 0;
+	enum sys_status s = sys_ring_enter(&ring.h, RING_SIZE, &done);
+	check(s == OK, "ring enter failed\n");
+	check(done == 5, "wrong number of entries processed\n");
+	check(ring.h.sq_head == 5, "wrong sq_head\n");
+	check(ring.h.cq_tail == 5, "wrong cq_tail\n");
+
+	char *mem[3];
+	for (size_t i = 0; i < 3; ++i) {
+		struct sys_cqe *c = complete();
+		check(c->user == (sys_arg_t)i, "wrong user data\n");
+		check(c->r.s == OK, "req_mem failed\n");
+		mem[i] = (char *)c->r.a0;
+		check(mem[i], "got NULL memory\n");
+
+		/* make sure memory is actually usable */
+		mem[i][0] = 1;
+	}
+
+	struct sys_cqe *c = complete();
+	check(c->user == 3 && c->r.s == OK, "ticks failed\n");
+
+	c = complete();
+	check(c->user == 4 && c->r.s == ERR_INVAL, "ipc allowed in ring?\n");
+
+	for (size_t i = 0; i < 3; ++i)
+		submit(SYS_FREE_MEM, (uintptr_t)mem[i], 0, i);
+
+	/* only process part of the queue at first */
+	s = sys_ring_enter(&ring.h, 2, &done);
+	check(s == OK && done == 2, "partial ring enter failed\n");
+
+	s = sys_ring_enter(&ring.h, RING_SIZE, &done);
+	check(s == OK && done == 1, "rest of ring enter failed\n");
+
+	for (size_t i = 0; i < 3; ++i) {
+		c = complete();
+		check(c->user == (sys_arg_t)i && c->r.s == OK, "free_mem failed\n");
+	}
+
+	ring.h.size = 3;
+	s = sys_ring_enter(&ring.h, RING_SIZE, &done);
+	check(s == ERR_INVAL, "accepted non power of two ring\n");
+
+	ok();
+}
@@ -0,0 +1,42 @@
+#include <common/test.h>
+
+START(pid, tid, d0, d1, d2, d3)
+{
+	UNUSED(tid); UNUSED(d0); UNUSED(d1); UNUSED(d2); UNUSED(d3);
+	check(pid == 0, "illegal pid for init\n");
+
+	struct sys_syscall_stats s;
+	check(sys_syscall_stats(SYSCALL_STATS_RESET, 0, NULL) == OK,
+			"failed resetting stats\n");
+
+	check(sys_syscall_stats(SYSCALL_STATS_GET, SYS_TICKS, &s) == OK,
+			"failed getting stats\n");
+	check(s.count == 0, "reset didn't clear counters\n");
+
+	for (size_t i = 0; i < 100; ++i)
+		sys_ticks();
+
+	check(sys_syscall_stats(SYSCALL_STATS_GET, SYS_TICKS, &s) == OK,
+			"failed getting stats\n");
+	check(s.count == 100, "wrong number of calls\n");
+	check(s.max <= s.ticks, "max longer than total\n");
+
+	unsigned long long total = 0;
+	for (size_t i = 0; i < SYSCALL_STATS_BUCKETS; ++i)
+		total += s.hist[i];
+
+	check(total == s.count, "histogram doesn't match count\n");
+
+	/* the previous get should've been counted by now */
+	check(sys_syscall_stats(SYSCALL_STATS_GET, SYS_SYSCALL_STATS, &s) == OK,
+			"failed getting stats\n");
+	check(s.count >= 3, "stats syscall not counted\n");
+
+	check(sys_syscall_stats(SYSCALL_STATS_GET, SYS_NUM, &s) == ERR_INVAL,
+			"got stats of nonexistent syscall\n");
+	check(sys_syscall_stats(SYSCALL_STATS_GET, SYS_TICKS, NULL) == ERR_ADDR,
+			"wrote stats to NULL\n");
+	check(sys_syscall_stats(100, SYS_TICKS, &s) == ERR_INVAL,
+			"accepted illegal op\n");
+	ok();
+}
@@ -0,0 +1 @@
+TESTS += syscall-stats
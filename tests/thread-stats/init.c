@@ -0,0 +1,49 @@
+#include <common/test.h>
+
+static void spin()
+{
+	for (volatile size_t i = 0; i < 1000000; ++i)
+		;
+}
+
+START(pid, tid, d0, d1, d2, d3)
+{
+	UNUSED(tid); UNUSED(d1); UNUSED(d2); UNUSED(d3);
+	check(pid == 0 || pid == 1, "illegal pid for init\n");
+
+	if (pid == 1 && d0 == 1) {
+		/* we're running as a guest in pid 2, this should show up as rpc
+		 * time for init and served time for pid 2 */
+		spin();
+		sys_ipc_resp0();
+		check(0, "ipc resp failed\n");
+	}
+
+	struct sys_stats s;
+	check(sys_thread_stats(0, &s) == OK, "failed getting own stats\n");
+	check(s.syscalls >= 1, "no syscalls counted\n");
+	check(s.rpc == 0, "rpc time before any rpc\n");
+
+	spin();
+	struct sys_stats n;
+	check(sys_thread_stats(0, &n) == OK, "failed getting own stats\n");
+	check(n.user > s.user, "no user time counted\n");
+	check(n.syscalls == s.syscalls + 1, "wrong number of syscalls\n");
+
+	id_t child = sys_fork(NULL);
+	check(child == 2, "unexpected pid\n");
+
+	struct sys_ret r = sys_ipc_req1(child, 1);
+	check(r.s == OK, "failed request\n");
+
+	check(sys_thread_stats(0, &n) == OK, "failed getting own stats\n");
+	check(n.rpc > 0, "no rpc time counted\n");
+
+	struct sys_stats c;
+	check(sys_thread_stats(child, &c) == OK, "failed getting child stats\n");
+	check(c.served > 0, "no served time counted\n");
+	check(c.served <= n.rpc, "served more than was spent in rpc\n");
+
+	check(sys_thread_stats(200, &c) == ERR_NF, "stats of nonexistent\n");
+	ok();
+}
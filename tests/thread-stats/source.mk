@@ -0,0 +1 @@
+TESTS += thread-stats
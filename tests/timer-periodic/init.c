@@ -0,0 +1,67 @@
+#include <common/test.h>
+
+static volatile size_t notifications = 0;
+static uint64_t period = 0;
+static id_t timer = 0;
+
+void stranger()
+{
+	/* timers can only be touched by whoever created them */
+	size_t overruns = 0;
+	check(sys_timer_overrun(timer, &overruns) == ERR_PERM,
+	      "read overruns of someone else's timer\n");
+	check(sys_free_timer(timer) == ERR_PERM,
+	      "freed someone else's timer\n");
+
+	sys_swap(1);
+	check(0, "swap to old thread failed\n");
+}
+
+START(pid, tid, d0, d1, d2, d3)
+{
+	UNUSED(pid);
+	UNUSED(tid);
+	UNUSED(d2);
+	UNUSED(d3);
+
+	if (d0 == SYS_USER_NOTIFY) {
+		check(d1 & NOTIFY_TIMER, "illegal notification\n");
+		if (notifications++ == 0) {
+			/* hog the first notification for a couple of periods,
+			 * they should show up as overruns */
+			uint64_t end = sys_ticks() + period * 3 + period / 2;
+			while (sys_ticks() < end)
+				;
+		}
+
+		sys_ipc_resp0();
+		check(0, "ipc resp failed\n");
+	}
+
+	period = sys_timebase() / 100;
+	check(sys_req_periodic_timer(0) < 0, "accepted zero period\n");
+
+	uint64_t start = sys_ticks();
+	id_t cid = sys_req_periodic_timer(period);
+	check(cid > 0, "failed creating periodic timer\n");
+
+	while (notifications < 5)
+		;
+
+	/* five notifications plus at least two overruns mean at least seven
+	 * periods passed */
+	check(sys_ticks() - start >= period * 7, "timer fired too often\n");
+
+	size_t overruns = 0;
+	check(sys_timer_overrun(cid, &overruns) == OK, "overrun failed\n");
+	check(overruns >= 2, "missed periods weren't counted\n");
+
+	timer = cid;
+	id_t other = sys_create((uintptr_t)stranger, 0, 0, 0, 0);
+	check(other > 0, "create failed\n");
+	check(sys_swap(other) == OK, "swap to new thread failed\n");
+
+	check(sys_free_timer(cid) == OK, "free failed\n");
+	check(sys_free_timer(cid) == ERR_NF, "double free succeeded\n");
+	ok();
+}
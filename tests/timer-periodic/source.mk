@@ -0,0 +1 @@
+TESTS += timer-periodic
@@ -0,0 +1,44 @@
+#include <common/test.h>
+
+static volatile size_t notifications = 0;
+static volatile uint64_t notified_at = 0;
+
+START(pid, tid, d0, d1, d2, d3)
+{
+	UNUSED(pid);
+	UNUSED(tid);
+	UNUSED(d2);
+	UNUSED(d3);
+
+	if (d0 == SYS_USER_NOTIFY) {
+		check(d1 & NOTIFY_TIMER, "illegal notification\n");
+		notified_at = sys_ticks();
+		notifications++;
+		sys_ipc_resp0();
+		check(0, "ipc resp failed\n");
+	}
+
+	uint64_t timebase = sys_timebase();
+
+	/* the windows of all three timers contain this point, and it has the
+	 * most trailing zeroes out of all of them, so all three timers should
+	 * be expired together */
+	uint64_t align = 1 << 20;
+	uint64_t target = (sys_ticks() + timebase / 100 + align) & ~(align - 1);
+
+	check(sys_req_abs_timer(target - 100, 1000) > 0, "timer 0 failed\n");
+	check(sys_req_abs_timer(target - 50, 1000) > 0, "timer 1 failed\n");
+	check(sys_req_abs_timer(target - 10, 1000) > 0, "timer 2 failed\n");
+
+	while (!notifications)
+		;
+
+	/* give any stragglers some time to show up */
+	uint64_t wait = sys_ticks() + timebase / 100;
+	while (sys_ticks() < wait)
+		;
+
+	check(notified_at >= target, "timer triggered early\n");
+	check(notifications == 1, "timers weren't coalesced\n");
+	ok();
+}
@@ -0,0 +1,62 @@
+#include <common/test.h>
+#include <common/trace.h>
+
+static struct sys_trace_rec recs[256];
+
+START(pid, tid, d0, d1, d2, d3)
+{
+	UNUSED(tid); UNUSED(d0); UNUSED(d1); UNUSED(d2); UNUSED(d3);
+	check(pid == 0, "illegal pid for init\n");
+
+	size_t drained = 0, dropped = 0;
+	check(sys_trace(TRACE_DRAIN, 0, recs, 256, &drained, &dropped) == OK,
+			"failed draining before start\n");
+	check(drained == 0, "events before start\n");
+
+	check(sys_trace(TRACE_START, 0, NULL, 0, NULL, NULL) == OK,
+			"failed starting trace\n");
+
+	for (size_t i = 0; i < 10; ++i)
+		sys_ticks();
+
+	void *p = sys_req_mem(4096, VM_R | VM_W);
+	check(p, "failed allocating memory\n");
+	/* fault it in */
+	*(volatile char *)p = 1;
+
+	check(sys_trace(TRACE_STOP, 0, NULL, 0, NULL, NULL) == OK,
+			"failed stopping trace\n");
+
+	check(sys_trace(TRACE_DRAIN, 0, recs, 256, &drained, &dropped) == OK,
+			"failed draining\n");
+	check(drained > 0, "nothing recorded\n");
+
+	size_t ticks = 0, returns = 0;
+	for (size_t i = 0; i < drained; ++i) {
+		struct sys_trace_rec *r = &recs[i];
+		check(r->cpu == 0, "wrong cpu\n");
+		check(r->tid == 1, "wrong tid\n");
+		if (i > 0)
+			check(r->ticks >= recs[i - 1].ticks, "time went backwards\n");
+
+		if (r->event == TRACE_SYSCALL && r->a0 == SYS_TICKS)
+			ticks++;
+
+		if (r->event == TRACE_RETURN)
+			returns++;
+	}
+
+	check(ticks == 10, "wrong number of SYS_TICKS events\n");
+	check(returns >= ticks, "missing returns to userspace\n");
+
+	/* record a bit more and print it out, see scripts/trace2perfetto */
+	check(sys_trace(TRACE_START, 0, NULL, 0, NULL, NULL) == OK,
+			"failed restarting trace\n");
+	sys_ticks();
+	sys_trace(TRACE_STOP, 0, NULL, 0, NULL, NULL);
+	check(trace_dump(0) > 0, "nothing dumped\n");
+
+	check(sys_trace(TRACE_DRAIN, 200, recs, 256, &drained, &dropped)
+			== ERR_INVAL, "drained nonexistent cpu\n");
+	ok();
+}
@@ -0,0 +1,40 @@
+#include <common/test.h>
+
+/* second hart wakes up a thread sleeping on the first one */
+
+static uint32_t word = 0;
+static volatile size_t sleeping = 0;
+
+static void waker(uint64_t timeout)
+{
+	while (!sleeping)
+		;
+
+	/* the waiter might not have made it into the kernel yet, keep trying
+	 * until it's actually woken up */
+	size_t woken = 0;
+	uint64_t end = sys_ticks() + timeout;
+	while (woken == 0 && sys_ticks() < end)
+		check(sys_wake(&word, 1, &woken) == OK, "wake failed\n");
+
+	check(woken == 1, "woke up %zu waiters\n", woken);
+	while (1)
+		;
+}
+
+START(pid, tid, d0, d1, d2, d3)
+{
+	UNUSED(pid);
+	UNUSED(d0);
+	UNUSED(d1);
+	UNUSED(d2);
+	UNUSED(d3);
+
+	uint64_t timeout = sys_timebase();
+	if (tid != 1)
+		waker(timeout);
+
+	sleeping = 1;
+	check(sys_wait(&word, 0, timeout * 2) == OK, "wait wasn't woken up\n");
+	ok();
+}
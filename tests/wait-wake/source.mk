@@ -0,0 +1,2 @@
+TESTS += wait-wake
+wait-wake_QEMU := -smp 2
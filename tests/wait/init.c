@@ -0,0 +1,47 @@
+#include <common/test.h>
+
+static uint32_t word = 0;
+static volatile size_t notifications = 0;
+
+START(pid, tid, d0, d1, d2, d3)
+{
+	UNUSED(pid);
+	UNUSED(tid);
+	UNUSED(d1);
+	UNUSED(d2);
+	UNUSED(d3);
+
+	if (d0 == SYS_USER_NOTIFY) {
+		notifications++;
+		sys_ipc_resp0();
+		check(0, "ipc resp failed\n");
+	}
+
+	/* value doesn't match, should return immediately */
+	check(sys_wait(&word, 1, 0) == OK, "mismatched wait failed\n");
+
+	check(sys_wait((uint32_t *)((uintptr_t)&word + 1), 0, 0) == ERR_ALIGN,
+	      "misaligned wait succeeded\n");
+
+	/* wait for roughly a millisecond */
+	uint64_t timeout = sys_timebase() / 1000;
+	uint64_t start = sys_ticks();
+	check(sys_wait(&word, 0, timeout) == ERR_TIMEOUT,
+	      "wait didn't time out\n");
+	check(sys_ticks() - start >= timeout, "wait timed out too early\n");
+
+	/* timer going off in the middle of a wait restarts it, which should
+	 * pick up where it left off once the notification is handled */
+	check(sys_req_rel_timer(timeout, 0) > 0, "failed creating timer\n");
+	start = sys_ticks();
+	check(sys_wait(&word, 0, timeout * 10) == ERR_TIMEOUT,
+	      "restarted wait didn't time out\n");
+	check(notifications == 1, "timer didn't interrupt wait\n");
+	check(sys_ticks() - start >= timeout * 10,
+	      "restarted wait timed out too early\n");
+
+	size_t woken = 1;
+	check(sys_wake(&word, 1, &woken) == OK, "wake failed\n");
+	check(woken == 0, "woke up nonexistent waiters\n");
+	ok();
+}